@@ -99,6 +99,7 @@ int main() {
 
   ui_manager.add_window(logger_window);
   ui_manager.add_window<gui::SystemInfoWindow>();
+  ui_manager.add_window<gui::StepTimingWindow>();
   ui_manager.add_window<gui::FaultWindow>(&tsm);
   ui_manager.add_window<gui::MetadataWindow>();
   ui_manager.add_window<gui::MovementWindow>();
@@ -0,0 +1,167 @@
+#include <array>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+// forward declaration
+static ATM_STATUS init();
+static void       shutdown_hook();
+static int        throw_message();
+
+using stepper_container = std::array<std::shared_ptr<device::StepperDevice>, 3>;
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  // initialize `GPIO-based` devices such as analog, digital, and PWM
+  if (initialize_device() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_device();
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize gpio bank, something is wrong"
+            << std::endl;
+  return ATM_ERR;
+}
+
+#ifdef MOCK_GPIO
+static void benchmark(const std::string&           name,
+                      const std::function<void()>& tick,
+                      unsigned                     ticks) {
+  gpioMockReset();
+
+  const time_unit start = micros();
+  for (unsigned i = 0; i < ticks; ++i) {
+    tick();
+  }
+  const time_unit elapsed = micros() - start;
+
+  const unsigned writes = gpioMockOperations(PI_MOCK_WRITE);
+  const unsigned bank = gpioMockOperations(PI_MOCK_WRITE_SET) +
+                        gpioMockOperations(PI_MOCK_WRITE_CLEAR);
+
+  LOG_INFO(
+      "{}: {} ticks, {:.2f} GPIO operations / tick ({} single, {} bank), "
+      "{:.3f} us / tick",
+      name, ticks, static_cast<double>(writes + bank) / ticks, writes, bank,
+      static_cast<double>(elapsed) / ticks);
+}
+#endif  // MOCK_GPIO
+
+int main(int argc, char* argv[]) {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+#ifdef MOCK_GPIO
+  auto* stepper_registry = device::StepperRegistry::get();
+
+  const stepper_container steppers{
+      stepper_registry->get(device::id::stepper::x()),
+      stepper_registry->get(device::id::stepper::y()),
+      stepper_registry->get(device::id::stepper::z())};
+
+  for (const auto& stepper : steppers) {
+    if (!stepper) {
+      LOG_ERROR("Stepper devices are not available");
+      shutdown_hook();
+      return ATM_ERR;
+    }
+  }
+
+  const unsigned ticks =
+      (argc > 1) ? static_cast<unsigned>(std::stoul(argv[1])) : 1000000U;
+
+  // every axis is due in every tick, the worst case
+  benchmark(
+      "Per pin",
+      [&steppers]() {
+        for (const auto& stepper : steppers) {
+          stepper->write_direction();
+          stepper->write_step(device::digital::value::high);
+          stepper->write_step(device::digital::value::low);
+        }
+      },
+      ticks);
+
+  device::GpioBank bank;
+  for (const auto& stepper : steppers) {
+    stepper->write_direction(bank);
+  }
+  bank.write();
+
+  benchmark(
+      "Bank",
+      [&steppers, &bank]() {
+        bank.clear();
+        for (const auto& stepper : steppers) {
+          stepper->write_step(bank, device::digital::value::high);
+        }
+        bank.write();
+        bank.invert();
+        bank.write();
+      },
+      ticks);
+
+  // a single pulse must raise every step pin in one operation
+  gpioMockRecord(1);
+  bank.write();
+  bank.invert();
+  bank.write();
+
+  std::array<gpioMockOp_t, 4> ops;
+  const unsigned count = gpioMockLog(ops.data(), ops.size());
+  gpioMockRecord(0);
+
+  for (unsigned i = 0; i < count; ++i) {
+    LOG_INFO("Operation {}: op={} bits={:#010x} levels={:#010x}", i, ops[i].op,
+             ops[i].bits, ops[i].levels);
+  }
+#else
+  [[maybe_unused]] auto unused_argc = argc;
+  [[maybe_unused]] auto unused_argv = argv;
+  LOG_INFO("GPIO operations can only be counted with mock GPIO");
+#endif  // MOCK_GPIO
+
+  shutdown_hook();
+
+  return status;
+}
@@ -0,0 +1,123 @@
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libmechanism/mechanism.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+// forward declaration
+static ATM_STATUS init();
+static void       shutdown_hook();
+static int        throw_message();
+static void       benchmark(const std::string&                      name,
+                            const config::MechanismSpeed&           speed,
+                            const mechanism::planner::position&     start,
+                            const impl::ConfigImpl::path_container& path,
+                            const Point&                            z);
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize planner, something is wrong" << std::endl;
+  return ATM_ERR;
+}
+
+static void benchmark(const std::string&                      name,
+                      const config::MechanismSpeed&           speed,
+                      const mechanism::planner::position&     start,
+                      const impl::ConfigImpl::path_container& path,
+                      const Point&                            z) {
+  mechanism::Planner planner;
+  planner.limits(speed);
+
+  std::vector<mechanism::planner::position> waypoints;
+  waypoints.reserve(path.size());
+  for (const auto& iter : path) {
+    waypoints.push_back({iter.first, iter.second, z});
+  }
+
+  const auto stop_time =
+      mechanism::Planner::duration(planner.plan(start, waypoints, false));
+  const auto blend_time =
+      mechanism::Planner::duration(planner.plan(start, waypoints, true));
+
+  const double saving =
+      (stop_time > 0) ? 100.0 * static_cast<double>(stop_time - blend_time) /
+                            static_cast<double>(stop_time)
+                      : 0.0;
+
+  LOG_INFO(
+      "{}: {} waypoints, stop at every point {} ms, blended {} ms, saving "
+      "{:.1f}%",
+      name, waypoints.size(), stop_time / 1000, blend_time / 1000, saving);
+}
+
+int main() {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+  auto* config = Config::get();
+
+  const std::array<std::pair<std::string, config::speed>, 3> profiles{
+      {{"slow", config::speed::slow},
+       {"normal", config::speed::normal},
+       {"fast", config::speed::fast}}};
+
+  for (const auto& [label, profile] : profiles) {
+    LOG_INFO("----{} speed profile----", label);
+
+    benchmark("Spraying", config->spraying_speed_profile(profile),
+              {0.0, 0.0, 0.0}, config->spraying_path(), 0.0);
+
+    const auto& edge = config->tending_path_edge();
+    benchmark("Tending edge", config->tending_speed_profile(profile),
+              {0.0, 0.0, 0.0}, edge, 0.0);
+
+    if (!edge.empty()) {
+      benchmark("Tending zigzag", config->tending_speed_profile(profile),
+                {edge.back().first, edge.back().second, 0.0},
+                config->tending_path_zigzag(), 0.0);
+    }
+  }
+
+  shutdown_hook();
+
+  return status;
+}
@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libmechanism/mechanism.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+/**
+ * Predicted duration of a task
+ */
+struct Prediction {
+  // time spent moving (us)
+  time_unit motion = 0;
+  // time spent waiting between moves (us)
+  time_unit dwell = 0;
+};
+
+/**
+ * Predicted machine, follows the sequences of libmachine/action.inline.hpp
+ */
+class Machine {
+ public:
+  explicit Machine(const config::speed& speed_profile);
+
+  void homing();
+  void move(const mechanism::planner::position& target);
+  void travel(const mechanism::planner::position& target);
+  void move_finger_up();
+  void move_finger_down();
+  void follow_path(const config::MechanismSpeed&           speed,
+                   const impl::ConfigImpl::path_container& path);
+  void dwell(time_unit millis);
+  void reset_coordinate();
+
+  inline const Prediction& prediction() const { return prediction_; }
+  inline void              clear() { prediction_ = {}; }
+
+ private:
+  mechanism::Estimator estimator(const config::MechanismSpeed& speed) const;
+  time_unit            point_to_point(
+      const mechanism::planner::position& from,
+      const mechanism::planner::position& to) const;
+  time_unit            seek_home(const config::MechanismSpeed& speed,
+                                 const std::array<double, 2>&  distance,
+                                 double                        length);
+
+ private:
+  // steps of each finger move toward the limit switch
+  static constexpr device::stepper::step finger_chunk = 1200;
+
+  const config::MechanismSpeed& homing_;
+  // absolute position from home (mm)
+  mechanism::planner::position position_;
+  // position where the coordinate has been reset (mm)
+  mechanism::planner::position origin_;
+  Prediction                   prediction_;
+};
+
+// forward declaration
+static ATM_STATUS init();
+static void       shutdown_hook();
+static int        throw_message();
+static bool       switchable(const std::string& stepper);
+static Prediction predict_spraying(Machine&             machine,
+                                   const config::speed& profile);
+static Prediction predict_tending(Machine&             machine,
+                                  const config::speed& profile);
+static Prediction predict_cleaning(Machine& machine);
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  // visiting order is the same as the machine
+  if (mechanism::Route::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize route");
+    return ATM_ERR;
+  }
+
+  mechanism::Route::get()->optimize();
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize predictor, something is wrong"
+            << std::endl;
+  return ATM_ERR;
+}
+
+Machine::Machine(const config::speed& speed_profile)
+    : homing_{Config::get()->homing_speed_profile(speed_profile)},
+      position_{0.0, 0.0, 0.0},
+      origin_{0.0, 0.0, 0.0} {}
+
+mechanism::Estimator Machine::estimator(
+    const config::MechanismSpeed& speed) const {
+  mechanism::Estimator estimator;
+  estimator.axes(speed);
+  return estimator;
+}
+
+/**
+ * Check MS pins of stepper are wired
+ *
+ * @param stepper key of stepper in "devices.stepper"
+ *
+ * @return true if microsteps of stepper can be switched
+ */
+static bool switchable(const std::string& stepper) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  return config->stepper<PI_PIN>(stepper, "ms1-pin") >= 0 &&
+         config->stepper<PI_PIN>(stepper, "ms2-pin") >= 0 &&
+         config->stepper<PI_PIN>(stepper, "ms3-pin") >= 0;
+}
+
+time_unit Machine::point_to_point(
+    const mechanism::planner::position& from,
+    const mechanism::planner::position& to) const {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  const auto estimator = this->estimator(homing_);
+  const auto move = estimator.move(from, to);
+
+  // same conditions as Movement::start_traverse, a coarse traverse runs on
+  // the trapezoid of the planner instead of the speed mode of the stepper
+  const auto coarse =
+      config->motion<device::stepper::step>("coarse-microsteps");
+  const auto min_rate = config->motion<double>("coarse-min-rate");
+
+  const std::array<std::string, 3> steppers{"x", "y", "z"};
+
+  device::stepper::step divisor = 0;
+  device::stepper::step master = 0;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    const auto& steps = move.axes[axis].steps;
+    if (steps == 0) {
+      continue;
+    }
+
+    const auto microsteps = config->stepper<device::stepper::step>(
+        steppers[axis], "microsteps");
+    if (coarse <= 0 || !switchable(steppers[axis]) ||
+        microsteps % coarse != 0 ||
+        (divisor != 0 && divisor != microsteps / coarse)) {
+      return move.duration;
+    }
+    divisor = microsteps / coarse;
+    master = std::max(master, std::abs(steps));
+  }
+
+  if (divisor <= 1) {
+    return move.duration;
+  }
+
+  mechanism::Planner planner;
+  planner.limits(homing_);
+
+  const auto direct = planner.plan(from, {to}, false);
+  if (direct.size() != 1) {
+    return move.duration;
+  }
+
+  const double ramp = min_rate * min_rate / (2.0 * direct[0].acceleration);
+  if (direct[0].cruise_rate <= min_rate ||
+      2.0 * ramp >= static_cast<double>(master)) {
+    return move.duration;
+  }
+
+  return mechanism::Planner::duration(direct);
+}
+
+time_unit Machine::seek_home(const config::MechanismSpeed& speed,
+                             const std::array<double, 2>&  distance,
+                             double                        length) {
+  // both axes move by `length` and are halted by their limit switches
+  const auto move = estimator(speed).move({0.0, 0.0, 0.0},
+                                          {-length, -length, 0.0});
+
+  time_unit time = 0;
+  for (std::size_t axis = 0; axis < 2; ++axis) {
+    const auto& profile = move.axes[axis];
+    const auto  steps = static_cast<device::stepper::step>(
+        std::lround(std::min(distance[axis], length) *
+                    static_cast<double>(profile.steps) / length));
+    time = std::max(time, mechanism::Estimator::reach(profile, steps));
+  }
+
+  return time;
+}
+
+void Machine::homing() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  move_finger_up();
+
+  // phase 1: seek both limit switches, home is where the switches are
+  prediction_.motion +=
+      seek_home(homing_, {position_[0], position_[1]}, 1500.0);
+  position_ = {0.0, 0.0, 0.0};
+
+  // back off, then latch slowly
+  const auto back_off = config->homing<double>("back-off");
+  move({back_off, back_off, 0.0});
+
+  auto latch = homing_;
+  latch.x.rpm *= config->homing<double>("latch-ratio");
+  latch.y.rpm *= config->homing<double>("latch-ratio");
+  prediction_.motion += seek_home(latch, {back_off, back_off}, 2 * back_off);
+  position_ = {0.0, 0.0, 0.0};
+
+  // move a bit (5mm for each axis)
+  move({5.0, 5.0, 5.0});
+  position_ = {0.0, 0.0, 0.0};
+  origin_ = {0.0, 0.0, 0.0};
+}
+
+void Machine::move(const mechanism::planner::position& target) {
+  prediction_.motion += point_to_point(position_, target);
+  position_ = target;
+}
+
+void Machine::travel(const mechanism::planner::position& target) {
+  massert(Config::get() != nullptr, "sanity");
+
+  const auto safe_height = Config::get()->clearance<Point>("safe-height");
+
+  // same parts as Movement::travel
+  const Point lift_z = std::min(position_[2], safe_height);
+  const Point land_z = std::min(target[2], safe_height);
+
+  prediction_.motion +=
+      point_to_point({0.0, 0.0, position_[2]}, {0.0, 0.0, lift_z});
+  prediction_.motion += point_to_point({position_[0], position_[1], lift_z},
+                                       {target[0], target[1], land_z});
+  prediction_.motion +=
+      point_to_point({0.0, 0.0, land_z}, {0.0, 0.0, target[2]});
+
+  position_ = target;
+}
+
+void Machine::move_finger_up() {
+  const auto estimator = this->estimator(homing_);
+  const auto chunk = estimator.move({0, 0, -finger_chunk});
+
+  const auto steps = std::lround(
+      position_[2] *
+      static_cast<double>(
+          Config::get()->stepper_z<device::stepper::step>("steps-per-mm")));
+
+  // every chunk is a move of its own, the last one is halted by the switch
+  prediction_.motion +=
+      static_cast<time_unit>(steps / finger_chunk) * chunk.duration +
+      mechanism::Estimator::reach(chunk.axes[2], steps % finger_chunk);
+  position_[2] = 0.0;
+}
+
+void Machine::move_finger_down() {
+  const auto estimator = this->estimator(homing_);
+  const auto chunk = estimator.move({0, 0, finger_chunk});
+
+  const auto steps = std::lround(
+      (mechanism::movement::finger_travel - position_[2]) *
+      static_cast<double>(
+          Config::get()->stepper_z<device::stepper::step>("steps-per-mm")));
+
+  prediction_.motion +=
+      static_cast<time_unit>(steps / finger_chunk) * chunk.duration +
+      mechanism::Estimator::reach(chunk.axes[2], steps % finger_chunk);
+  position_[2] = mechanism::movement::finger_travel;
+}
+
+void Machine::follow_path(const config::MechanismSpeed&           speed,
+                          const impl::ConfigImpl::path_container& path) {
+  mechanism::Planner planner;
+  planner.limits(speed);
+
+  std::vector<mechanism::planner::position> waypoints;
+  waypoints.reserve(path.size());
+  for (const auto& iter : path) {
+    waypoints.push_back(
+        {origin_[0] + iter.first, origin_[1] + iter.second, position_[2]});
+  }
+
+  if (waypoints.empty()) {
+    return;
+  }
+
+  prediction_.motion +=
+      mechanism::Planner::duration(planner.plan(position_, waypoints));
+  position_ = waypoints.back();
+}
+
+void Machine::dwell(time_unit millis) {
+  prediction_.dwell += millis * 1000;
+}
+
+void Machine::reset_coordinate() {
+  origin_ = position_;
+}
+
+static Prediction predict_spraying(Machine&             machine,
+                                   const config::speed& profile) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto*       config = Config::get();
+  const auto& spraying_position = config->spraying_position();
+
+  machine.clear();
+
+  machine.move({spraying_position.first, spraying_position.second, 0.0});
+  // reset position so imaginary homing equals spraying position
+  machine.reset_coordinate();
+  machine.dwell(3000);
+  machine.dwell(3000);
+  machine.follow_path(config->spraying_speed_profile(profile),
+                      mechanism::Route::get()->spraying_path());
+  machine.homing();
+  machine.dwell(3000);
+  machine.dwell(1000);
+
+  return machine.prediction();
+}
+
+static Prediction predict_tending(Machine&             machine,
+                                  const config::speed& profile) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto*       config = Config::get();
+  const auto& tending_position = config->tending_position();
+  const auto  safe_height = config->clearance<Point>("safe-height");
+
+  machine.clear();
+
+  machine.travel({tending_position.first, tending_position.second,
+                  safe_height});
+  // reset position so imaginary homing equals tending position
+  machine.reset_coordinate();
+  machine.dwell(3000);
+  machine.move_finger_down();
+  machine.dwell(1000);
+  machine.follow_path(config->tending_speed_profile(profile),
+                      config->tending_path_edge());
+  machine.dwell(1000);
+  machine.dwell(1000);
+  machine.follow_path(config->tending_speed_profile(profile),
+                      config->tending_path_zigzag());
+  machine.dwell(1000);
+  machine.homing();
+  machine.dwell(3000);
+  machine.dwell(1000);
+
+  return machine.prediction();
+}
+
+static Prediction predict_cleaning(Machine& machine) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto*      config = Config::get();
+  const auto safe_height = config->clearance<Point>("safe-height");
+
+  // finger moves always use homing speed profile
+  machine.clear();
+
+  // finger homing waits for 2 seconds before reading the infrared
+  machine.dwell(2000);
+
+  for (const auto& [x, y, time, sonicator] :
+       mechanism::Route::get()->cleaning_stations()) {
+    machine.travel({x, y, safe_height});
+    machine.move_finger_down();
+    machine.dwell(static_cast<time_unit>(time) * 1000);
+  }
+
+  machine.move_finger_up();
+  machine.dwell(3000);
+  machine.dwell(1000);
+
+  return machine.prediction();
+}
+
+int main() {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+  const std::array<std::pair<std::string, config::speed>, 3> profiles{
+      {{"slow", config::speed::slow},
+       {"normal", config::speed::normal},
+       {"fast", config::speed::fast}}};
+
+  const auto print = [](const std::string& name, const Prediction& p) {
+    LOG_INFO("{}: {:.1f} s (motion {:.1f} s, dwell {:.1f} s)", name,
+             static_cast<double>(p.motion + p.dwell) / 1e+6,
+             static_cast<double>(p.motion) / 1e+6,
+             static_cast<double>(p.dwell) / 1e+6);
+  };
+
+  for (const auto& [label, profile] : profiles) {
+    LOG_INFO("----{} speed profile----", label);
+
+    // every task starts from home
+    Machine machine(profile);
+
+    const Prediction spraying = predict_spraying(machine, profile);
+    const Prediction tending = predict_tending(machine, profile);
+    const Prediction cleaning = predict_cleaning(machine);
+
+    print("Spraying", spraying);
+    print("Tending", tending);
+    print("Cleaning", cleaning);
+    print("Cycle", {spraying.motion + tending.motion + cleaning.motion,
+                    spraying.dwell + tending.dwell + cleaning.dwell});
+  }
+
+  shutdown_hook();
+
+  return status;
+}
@@ -0,0 +1,194 @@
+#include <array>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+// forward declaration
+static ATM_STATUS init();
+static void       shutdown_hook();
+static int        throw_message();
+
+/**
+ * @brief Shift register device that can be created with any cascade number
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class BenchShiftRegister : public device::impl::ShiftRegisterDeviceImpl {
+ public:
+  /**
+   * BenchShiftRegister Constructor
+   *
+   * @param  latch_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  clock_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  data_pin    gpio pin, see Raspberry GPIO pinout for details
+   * @param  cascade_num number of cascaded registers
+   * @param  spi         hardware SPI bus, bit-bang if it is empty
+   */
+  BenchShiftRegister(
+      PI_PIN                                            latch_pin,
+      PI_PIN                                            clock_pin,
+      PI_PIN                                            data_pin,
+      unsigned int                                      cascade_num,
+      const std::optional<device::shift_register::Spi>& spi)
+      : ShiftRegisterDeviceImpl{latch_pin,
+                                clock_pin,
+                                data_pin,
+                                device::shift_register::bit_order::msb,
+                                cascade_num,
+                                spi} {}
+
+  using ShiftRegisterDeviceImpl::backend;
+  using ShiftRegisterDeviceImpl::cascade_num;
+};
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // shift register singleton is not created, it would hold the same pins
+  if (gpioInitialise() < 0) {
+    LOG_ERROR("Failed to initialize GPIO");
+    return ATM_ERR;
+  }
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_device();
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize shift register, something is wrong"
+            << std::endl;
+  return ATM_ERR;
+}
+
+/**
+ * Benchmark updates of a single bit, every update is a full latch cycle
+ *
+ * @param shift_register shift register device
+ * @param updates        number of updates
+ */
+static void benchmark(BenchShiftRegister& shift_register, unsigned updates) {
+  const std::string name =
+      shift_register.backend() == device::shift_register::backend::spi
+          ? "SPI"
+          : "GPIO";
+
+#ifdef MOCK_GPIO
+  gpioMockReset();
+#endif  // MOCK_GPIO
+
+  const time_unit start = micros();
+  for (unsigned i = 0; i < updates; ++i) {
+    shift_register.write(0, (i & 1) ? device::digital::value::low
+                                     : device::digital::value::high);
+  }
+  const time_unit elapsed = micros() - start;
+
+  const double seconds = static_cast<double>(elapsed) / 1e+6;
+
+  LOG_INFO("{} with {} registers: {} updates, {:.0f} updates / s", name,
+           shift_register.cascade_num(), updates,
+           seconds > 0.0 ? updates / seconds : 0.0);
+
+#ifdef MOCK_GPIO
+  LOG_INFO("{} with {} registers: {:.2f} GPIO writes / update, {:.2f} SPI "
+           "writes / update",
+           name, shift_register.cascade_num(),
+           static_cast<double>(gpioMockOperations(PI_MOCK_WRITE)) / updates,
+           static_cast<double>(gpioMockOperations(PI_MOCK_SPI_WRITE)) /
+               updates);
+#endif  // MOCK_GPIO
+}
+
+int main(int argc, char* argv[]) {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+  auto* config = Config::get();
+
+  const unsigned updates =
+      (argc > 1) ? static_cast<unsigned>(std::stoul(argv[1])) : 10000U;
+
+  const device::shift_register::Spi spi{
+      config->shift_register<unsigned int>("spi-channel"),
+      config->shift_register<unsigned int>("spi-baud")};
+
+  constexpr std::array<unsigned int, 4> cascades{1, 2, 4, 8};
+
+  for (const auto& cascade_num : cascades) {
+    {
+      BenchShiftRegister shift_register{
+          config->shift_register<PI_PIN>("latch-pin"),
+          config->shift_register<PI_PIN>("clock-pin"),
+          config->shift_register<PI_PIN>("data-pin"), cascade_num, {}};
+      benchmark(shift_register, updates);
+    }
+
+    {
+      BenchShiftRegister shift_register{
+          config->shift_register<PI_PIN>("latch-pin"),
+          config->shift_register<PI_PIN>("clock-pin"),
+          config->shift_register<PI_PIN>("data-pin"), cascade_num, spi};
+
+      if (shift_register.backend() != device::shift_register::backend::spi) {
+        LOG_WARN("SPI is not available, skipping SPI backend");
+        continue;
+      }
+
+      benchmark(shift_register, updates);
+    }
+  }
+
+#ifdef MOCK_GPIO
+  // a single update must write every register in one SPI write
+  {
+    BenchShiftRegister shift_register{
+        config->shift_register<PI_PIN>("latch-pin"),
+        config->shift_register<PI_PIN>("clock-pin"),
+        config->shift_register<PI_PIN>("data-pin"), 2, spi};
+
+    gpioMockRecord(1);
+    shift_register.write(9, device::digital::value::high);
+
+    std::array<char, 4> bytes;
+    const unsigned      count = gpioMockSpi(bytes.data(), bytes.size());
+    gpioMockRecord(0);
+
+    for (unsigned i = 0; i < count; ++i) {
+      LOG_INFO("SPI byte {}: {:#04x}", i, static_cast<unsigned char>(bytes[i]));
+    }
+  }
+#endif  // MOCK_GPIO
+
+  shutdown_hook();
+
+  return status;
+}
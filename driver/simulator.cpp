@@ -0,0 +1,375 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libmechanism/mechanism.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+#ifdef MOCK_GPIO
+/**
+ * Input switch of the simulated machine
+ */
+struct Switch {
+  int  pin;
+  bool active_state;
+};
+
+/**
+ * Simulated machine, switches follow the step position of every axis
+ */
+struct Machine {
+  const StepCounters* counters;
+  // step position of the switches
+  std::int64_t home_x;
+  std::int64_t home_y;
+  std::int64_t top_z;
+  std::int64_t bottom_z;
+  Switch       limit_x;
+  Switch       limit_y;
+  Switch       limit_z_top;
+  Switch       limit_z_bottom;
+  Switch       finger_infrared;
+};
+#endif  // MOCK_GPIO
+
+// forward declaration
+static ATM_STATUS init();
+static void       shutdown_hook();
+static int        throw_message();
+static void       do_spraying();
+static void       do_tending();
+static void       do_cleaning();
+
+// every timer function runs on the virtual clock
+static util::VirtualClock virtual_clock;
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  // initialize `GPIO-based` devices such as analog, digital, and PWM
+  if (initialize_device() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize `mechanism`
+  if (initialize_mechanism() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  auto&& movement = mechanism::movement_mechanism();
+  if (movement != nullptr) {
+    movement->disable_motors();
+  }
+  destroy_device();
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize simulator, something is wrong"
+            << std::endl;
+  return ATM_ERR;
+}
+
+static void do_spraying() {
+  massert(device::ShiftRegister::get() != nullptr, "sanity");
+  massert(mechanism::movement_mechanism() != nullptr, "sanity");
+
+  auto*  shift_register = device::ShiftRegister::get();
+  auto&& movement = mechanism::movement_mechanism();
+
+  LOG_INFO("Spraying...");
+
+  movement->homing();
+
+  shift_register->write(device::id::comm::pi::spraying_running(),
+                        device::digital::value::high);
+  sleep_for<time_units::millis>(3000);
+
+  movement->move_to_spraying_position();
+  sleep_for<time_units::millis>(3000);
+
+  shift_register->write(device::id::spray(), device::digital::value::high);
+  sleep_for<time_units::millis>(3000);
+
+  movement->follow_spraying_paths();
+
+  shift_register->write(device::id::spray(), device::digital::value::low);
+
+  movement->homing();
+
+  shift_register->write(device::id::comm::pi::spraying_running(),
+                        device::digital::value::low);
+}
+
+static void do_tending() {
+  massert(device::ShiftRegister::get() != nullptr, "sanity");
+  massert(mechanism::movement_mechanism() != nullptr, "sanity");
+
+  auto*  shift_register = device::ShiftRegister::get();
+  auto&& movement = mechanism::movement_mechanism();
+
+  LOG_INFO("Tending...");
+
+  movement->homing();
+
+  shift_register->write(device::id::comm::pi::tending_running(),
+                        device::digital::value::high);
+  sleep_for<time_units::millis>(3000);
+
+  movement->move_to_tending_position();
+  sleep_for<time_units::millis>(3000);
+  movement->move_finger_down();
+  sleep_for<time_units::millis>(1000);
+  movement->follow_tending_paths_edge();
+  sleep_for<time_units::millis>(1000);
+
+  movement->rotate_finger();
+
+  sleep_for<time_units::millis>(1000);
+  movement->follow_tending_paths_zigzag();
+  sleep_for<time_units::millis>(1000);
+
+  movement->stop_finger();
+
+  movement->homing();
+
+  shift_register->write(device::id::comm::pi::tending_running(),
+                        device::digital::value::low);
+}
+
+static void do_cleaning() {
+  massert(Config::get() != nullptr, "sanity");
+  massert(mechanism::movement_mechanism() != nullptr, "sanity");
+  massert(mechanism::Route::get() != nullptr, "sanity");
+
+  auto*  config = Config::get();
+  auto&& movement = mechanism::movement_mechanism();
+  auto*  route = mechanism::Route::get();
+
+  LOG_INFO("Cleaning...");
+
+  movement->homing();
+  movement->homing_finger();
+
+  const auto safe_height = config->clearance<Point>("safe-height");
+
+  for (const auto& [x, y, time, sonicator] : route->cleaning_stations()) {
+    movement->travel(x, y, safe_height);
+    movement->move_finger_down();
+    sleep_for<time_units::seconds>(time);
+  }
+
+  movement->move_finger_up();
+
+  movement->homing();
+}
+
+#ifdef MOCK_GPIO
+static int switch_level(const Switch& input, bool on) {
+  // inverted inputs are pulled up, active means low
+  return (on == input.active_state) ? PI_HIGH : PI_LOW;
+}
+
+static int read_machine(int gpio, void* userdata) {
+  const auto* machine = static_cast<const Machine*>(userdata);
+  const auto& counters = *machine->counters;
+
+  const std::int64_t x = counters[0].load(std::memory_order_acquire);
+  const std::int64_t y = counters[1].load(std::memory_order_acquire);
+  const std::int64_t z = counters[2].load(std::memory_order_acquire);
+
+  if (gpio == machine->limit_x.pin) {
+    return switch_level(machine->limit_x, x <= machine->home_x);
+  } else if (gpio == machine->limit_y.pin) {
+    return switch_level(machine->limit_y, y <= machine->home_y);
+  } else if (gpio == machine->limit_z_top.pin) {
+    return switch_level(machine->limit_z_top, z <= machine->top_z);
+  } else if (gpio == machine->limit_z_bottom.pin) {
+    return switch_level(machine->limit_z_bottom, z >= machine->bottom_z);
+  } else if (gpio == machine->finger_infrared.pin) {
+    return switch_level(machine->finger_infrared, true);
+  }
+
+  return PI_LOW;
+}
+
+static Switch input_switch(const std::string& id) {
+  auto&& input = device::DigitalInputDeviceRegistry::get()->get(id);
+  return {static_cast<int>(input->pin()), input->active_state()};
+}
+
+static Machine make_machine() {
+  massert(Config::get() != nullptr, "sanity");
+  massert(device::DigitalInputDeviceRegistry::get() != nullptr, "sanity");
+  massert(mechanism::movement_mechanism() != nullptr, "sanity");
+
+  auto*  config = Config::get();
+  auto&& movement = mechanism::movement_mechanism();
+
+  const auto steps_per_mm_x =
+      config->stepper_x<device::stepper::step>("steps-per-mm");
+  const auto steps_per_mm_y =
+      config->stepper_y<device::stepper::step>("steps-per-mm");
+  const auto steps_per_mm_z =
+      config->stepper_z<device::stepper::step>("steps-per-mm");
+
+  // machine is powered on 100 mm away from home, with the finger lifted and
+  // 52 mm of finger travel
+  return {&movement->executor().counters(),
+          -100 * steps_per_mm_x,
+          -100 * steps_per_mm_y,
+          0,
+          52 * steps_per_mm_z,
+          input_switch(device::id::limit_switch::x()),
+          input_switch(device::id::limit_switch::y()),
+          input_switch(device::id::limit_switch::z1()),
+          input_switch(device::id::limit_switch::z2()),
+          input_switch(device::id::finger_infrared())};
+}
+
+static void report(const std::vector<gpioMockOp_t>& ops,
+                   time_unit                        virtual_elapsed,
+                   double                           real_elapsed) {
+  // rising and falling edges of GPIO 0-31
+  std::array<unsigned, 32> rising{};
+  std::array<unsigned, 32> falling{};
+
+  uint32_t levels = ops.empty() ? 0 : ops.front().levels;
+  for (const auto& op : ops) {
+    const uint32_t changed = levels ^ op.levels;
+    for (unsigned pin = 0; pin < 32; ++pin) {
+      if (((changed >> pin) & 1U) == 0) {
+        continue;
+      }
+
+      if ((op.levels >> pin) & 1U) {
+        ++rising[pin];
+      } else {
+        ++falling[pin];
+      }
+    }
+    levels = op.levels;
+  }
+
+  for (unsigned pin = 0; pin < 32; ++pin) {
+    if (rising[pin] + falling[pin] > 0) {
+      LOG_INFO("GPIO {:2}: {} rising, {} falling", pin, rising[pin],
+               falling[pin]);
+    }
+  }
+
+  const double virtual_seconds = static_cast<double>(virtual_elapsed) / 1e+6;
+
+  LOG_INFO(
+      "Simulated {:.3f} s of machine time in {:.3f} s ({:.0f}x), {} GPIO "
+      "operations",
+      virtual_seconds, real_elapsed, virtual_seconds / real_elapsed,
+      ops.size());
+}
+
+static void write_log(const std::string&               path,
+                      const std::vector<gpioMockOp_t>& ops) {
+  std::ofstream file(path);
+
+  if (!file) {
+    LOG_ERROR("Cannot write GPIO log to {}", path);
+    return;
+  }
+
+  file << "tick,op,bits,levels\n";
+  for (const auto& op : ops) {
+    file << op.tick << ',' << op.op << ',' << op.bits << ',' << op.levels
+         << '\n';
+  }
+
+  LOG_INFO("GPIO log is written to {}", path);
+}
+#endif  // MOCK_GPIO
+
+int main(int argc, char* argv[]) {
+  // must be installed before any other thread reads the time
+  util::use_clock(&virtual_clock);
+
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+#ifdef MOCK_GPIO
+  Machine machine = make_machine();
+  gpioMockSetReadFunc(read_machine, &machine);
+
+  gpioMockRecord(1);
+
+  const auto      real_start = std::chrono::steady_clock::now();
+  const time_unit virtual_start = virtual_clock.peek();
+
+  do_spraying();
+  do_tending();
+  do_cleaning();
+
+  const time_unit virtual_elapsed = virtual_clock.peek() - virtual_start;
+  const double    real_elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                    real_start)
+          .count();
+
+  std::vector<gpioMockOp_t> ops(gpioMockLogSize());
+  ops.resize(gpioMockLog(ops.data(), static_cast<unsigned>(ops.size())));
+  gpioMockRecord(0);
+
+  report(ops, virtual_elapsed, real_elapsed);
+  mechanism::movement_mechanism()->report_step_timing();
+
+  if (argc > 1) {
+    write_log(argv[1], ops);
+  }
+
+  // machine reads the step counters of movement
+  gpioMockSetReadFunc(nullptr, nullptr);
+  shutdown_hook();
+#else
+  [[maybe_unused]] auto unused_argc = argc;
+  [[maybe_unused]] auto unused_argv = argv;
+  LOG_INFO("Machine can only be simulated with mock GPIO");
+  shutdown_hook();
+#endif  // MOCK_GPIO
+
+  util::use_clock(nullptr);
+
+  return status;
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libmechanism/mechanism.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+// forward declaration
+static ATM_STATUS             init();
+static void                   shutdown_hook();
+static int                    throw_message();
+static std::vector<time_unit> tending_pulses();
+static void                   benchmark(const std::string&            name,
+                                        const std::vector<time_unit>& pulses,
+                                        time_unit                     duration,
+                                        bool                          hybrid);
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize timing, something is wrong" << std::endl;
+  return ATM_ERR;
+}
+
+static std::vector<time_unit> tending_pulses() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  const auto& speed = config->tending_speed_profile(config::speed::normal);
+
+  mechanism::Planner planner;
+  planner.limits(speed);
+
+  std::vector<mechanism::planner::position> waypoints;
+  for (const auto& iter : config->tending_path_edge()) {
+    waypoints.push_back({iter.first, iter.second, 0.0});
+  }
+  for (const auto& iter : config->tending_path_zigzag()) {
+    waypoints.push_back({iter.first, iter.second, 0.0});
+  }
+
+  // average master-axis pulse of each block
+  std::vector<time_unit> pulses;
+  for (const auto& block : planner.plan({0.0, 0.0, 0.0}, waypoints)) {
+    const auto steps = std::max(
+        {std::abs(block.steps[0]), std::abs(block.steps[1]),
+         std::abs(block.steps[2])});
+    const time_unit pulse =
+        std::max<time_unit>(block.duration / static_cast<time_unit>(steps), 1);
+    pulses.insert(pulses.end(), static_cast<std::size_t>(steps), pulse);
+  }
+
+  return pulses;
+}
+
+static void benchmark(const std::string&            name,
+                      const std::vector<time_unit>& pulses,
+                      time_unit                     duration,
+                      bool                          hybrid) {
+  std::vector<time_unit> jitter;
+  jitter.reserve(pulses.size());
+
+  const std::clock_t cpu_start = std::clock();
+  const time_unit    start = micros();
+  time_unit          deadline = start;
+
+  for (std::size_t i = 0; micros() - start < duration; ++i) {
+    deadline += pulses[i % pulses.size()];
+
+    if (hybrid) {
+      wait_until(deadline);
+    } else {
+      while (micros() < deadline) {
+        // not yet running
+      }
+    }
+
+    const time_unit now = micros();
+    jitter.push_back(now > deadline ? now - deadline : 0);
+  }
+
+  const double wall = static_cast<double>(micros() - start) / 1e+6;
+  const double cpu =
+      static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+  if (jitter.empty()) {
+    LOG_WARN("{}: no pulses within {} us", name, duration);
+    return;
+  }
+
+  std::sort(jitter.begin(), jitter.end());
+
+  LOG_INFO("{}: {} pulses, CPU {:.1f}%, jitter p50 {} us, p99 {} us, max {} us",
+           name, jitter.size(), 100.0 * cpu / wall,
+           jitter[jitter.size() / 2], jitter[(jitter.size() - 1) * 99 / 100],
+           jitter.back());
+}
+
+int main(int argc, char* argv[]) {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+  // simulated tending job, 10 minutes by default
+  const time_unit duration =
+      ((argc > 1) ? std::stoul(argv[1]) : 600UL) * 1000000UL;
+
+  LOG_INFO("Wake-up latency is calibrated to {} us", calibrate_wait_latency());
+
+  const auto pulses = tending_pulses();
+  if (pulses.empty()) {
+    LOG_ERROR("Tending paths are empty");
+    shutdown_hook();
+    return ATM_ERR;
+  }
+
+  benchmark("Spin", pulses, duration, false);
+  benchmark("Sleep and spin", pulses, duration, true);
+
+  shutdown_hook();
+
+  return status;
+}
@@ -0,0 +1,645 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libcore/core.hpp>
+#include <libdevice/device.hpp>
+#include <libmechanism/mechanism.hpp>
+#include <libutil/util.hpp>
+
+USE_NAMESPACE;
+
+/**
+ * Limits every candidate has to respect
+ */
+struct Constraints {
+  // motor limit (full steps / s)
+  double max_step_rate = 0.0;
+  // jerk of s-curve speed (full steps / s^3)
+  double max_jerk = 0.0;
+  // shortest step pulse interval (us)
+  device::stepper::pulse min_pulse = 0;
+};
+
+/**
+ * Axis of the machine, the stepper is the real device
+ */
+struct Axis {
+  std::shared_ptr<device::StepperDevice> stepper;
+  device::stepper::speed                 mode;
+  device::stepper::step                  steps_per_mm;
+};
+
+/**
+ * Speed of single axis with its cost
+ */
+struct AxisCandidate {
+  config::Speed speed;
+  // peak acceleration or deceleration (mm / s^2)
+  double acceleration = 0.0;
+  // cruise speed (mm / s)
+  double velocity = 0.0;
+};
+
+/**
+ * Speed of mechanism with its cost, every field is minimized
+ */
+struct Candidate {
+  config::MechanismSpeed speed;
+  // time of every replayed move (us)
+  time_unit time = 0;
+  // peak acceleration or deceleration of moving axes (mm / s^2)
+  double acceleration = 0.0;
+  // peak cruise speed of moving axes (mm / s)
+  double velocity = 0.0;
+};
+
+/**
+ * Moves of a mechanism that are replayed for every candidate
+ *
+ * z-axis is moved together with x-axis and y-axis within the clearance
+ * envelope (see Movement::travel), so every stop-to-stop move is a single
+ * synchronized move of all axes
+ */
+struct Workload {
+  std::string name;
+  // key of speed profile in configuration
+  std::string key;
+  // current speed profile
+  std::array<config::MechanismSpeed, 3> current;
+  // blended paths, every path starts where the previous one ends (mm)
+  std::vector<std::vector<mechanism::planner::position>> paths;
+  // stop-to-stop moves (mm)
+  std::vector<std::pair<mechanism::planner::position,
+                        mechanism::planner::position>>
+      moves;
+};
+
+using axis_container = std::array<Axis, 3>;
+
+// forward declaration
+static ATM_STATUS                 init();
+static void                       shutdown_hook();
+static int                        throw_message();
+static std::vector<double>        levels(double min, double max);
+static device::stepper::pulse     replay(const Axis&           axis,
+                                         const config::Speed&  speed,
+                                         device::stepper::step steps);
+static std::vector<AxisCandidate> search_axis(const Axis&           axis,
+                                              const Constraints&    constraints,
+                                              device::stepper::step longest,
+                                              const config::Speed&  current);
+static time_unit replay_workload(const axis_container&         axes,
+                                 const Workload&               workload,
+                                 const config::MechanismSpeed& speed);
+static std::array<device::stepper::step, 3> longest_moves(
+    const axis_container& axes,
+    const Workload&       workload);
+static void travel(Workload&                           workload,
+                   const mechanism::planner::position& from,
+                   const mechanism::planner::position& to);
+static std::vector<Candidate> pareto(std::vector<Candidate> candidates);
+static std::vector<Candidate> tune(const axis_container& axes,
+                                   const Constraints&    constraints,
+                                   const Workload&       workload);
+static void                   emit(const Workload&               workload,
+                                   const std::vector<Candidate>& front,
+                                   time_unit                     current);
+static Workload               homing_workload();
+static Workload               spraying_workload();
+static Workload               tending_workload();
+
+static ATM_STATUS init() {
+  // initialize logger
+  if (Logger::create() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // initialize config
+  if (Config::create(PROJECT_CONFIG_FILE) == ATM_ERR) {
+    LOG_ERROR("Failed to load configuration");
+    return ATM_ERR;
+  }
+
+  // re-init logger based on config
+  Logger::get()->init(Config::get());
+
+  // init state
+  if (State::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize state");
+    return ATM_ERR;
+  }
+
+  // initialize `GPIO-based` devices such as analog, digital, and PWM
+  if (initialize_device() == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  // visiting order is the same as the machine
+  if (mechanism::Route::create() == ATM_ERR) {
+    LOG_ERROR("Failed to initialize route");
+    return ATM_ERR;
+  }
+
+  mechanism::Route::get()->optimize();
+
+  return ATM_OK;
+}
+
+static void shutdown_hook() {
+  std::cout << "Shutting down..." << std::endl;
+  destroy_device();
+  destroy_core();
+  std::cout << "Shutting down is completed!" << std::endl;
+}
+
+static int throw_message() {
+  std::cerr << "Failed to initialize tuner, something is wrong" << std::endl;
+  return ATM_ERR;
+}
+
+static std::vector<double> levels(double min, double max) {
+  massert(Config::get() != nullptr, "sanity");
+
+  const auto count =
+      std::max<std::size_t>(Config::get()->tuner<std::size_t>("levels"), 2);
+
+  // geometric, so every level is the same ratio faster than the previous
+  std::vector<double> result;
+  result.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const double ratio =
+        static_cast<double>(i) / static_cast<double>(count - 1);
+    result.push_back(std::round(min * std::pow(max / min, ratio)));
+  }
+
+  return result;
+}
+
+static device::stepper::pulse replay(const Axis&           axis,
+                                     const config::Speed&  speed,
+                                     device::stepper::step steps) {
+  const auto& stepper = axis.stepper;
+
+  stepper->rpm(speed.rpm);
+  stepper->acceleration(speed.acceleration);
+  stepper->deceleration(speed.deceleration);
+  stepper->jerk(speed.jerk);
+
+  // same pulses as the motion thread, without touching the pins
+  stepper->start_move(steps);
+
+  device::stepper::pulse shortest = 0;
+  for (auto pulse = stepper->yield_pulse(); pulse != 0;
+       pulse = stepper->yield_pulse()) {
+    shortest = (shortest == 0) ? pulse : std::min(shortest, pulse);
+  }
+
+  return shortest;
+}
+
+static std::vector<AxisCandidate> search_axis(
+    const Axis&           axis,
+    const Constraints&    constraints,
+    device::stepper::step longest,
+    const config::Speed&  current) {
+  const auto& stepper = axis.stepper;
+
+  // mm for every full step
+  const double mm_per_step = static_cast<double>(stepper->microsteps()) /
+                             static_cast<double>(axis.steps_per_mm);
+
+  const auto cost = [&stepper, mm_per_step](const config::Speed& speed) {
+    return AxisCandidate{
+        speed,
+        std::max(speed.acceleration, speed.deceleration) * mm_per_step,
+        speed.rpm * static_cast<double>(stepper->motor_steps()) / 60.0 *
+            mm_per_step};
+  };
+
+  // axis does not move, keep the current speed at no cost
+  if (longest == 0) {
+    return {{current, 0.0, 0.0}};
+  }
+
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  const auto rpms = levels(config->tuner<double>("rpm-min"),
+                           config->tuner<double>("rpm-max"));
+  const auto accelerations =
+      levels(config->tuner<double>("acceleration-min"),
+             config->tuner<double>("acceleration-max"));
+
+  std::vector<AxisCandidate> result;
+
+  for (const double rpm : rpms) {
+    if (rpm * static_cast<double>(stepper->motor_steps()) / 60.0 >
+        constraints.max_step_rate) {
+      continue;
+    }
+
+    for (const double acceleration : accelerations) {
+      for (const double deceleration : accelerations) {
+        config::Speed speed;
+        speed.rpm = rpm;
+        speed.acceleration = acceleration;
+        speed.deceleration = deceleration;
+        // jerk is only used by s-curve speed
+        speed.jerk = (axis.mode == device::stepper::speed::scurve)
+                         ? constraints.max_jerk
+                         : current.jerk;
+
+        // longest move reaches the highest rate of the speed
+        if (replay(axis, speed, longest) < constraints.min_pulse) {
+          continue;
+        }
+
+        result.push_back(cost(speed));
+      }
+    }
+  }
+
+  return result;
+}
+
+static time_unit replay_workload(const axis_container&         axes,
+                                 const Workload&               workload,
+                                 const config::MechanismSpeed& speed) {
+  const std::array<const config::Speed*, 3> speeds{&speed.x, &speed.y,
+                                                   &speed.z};
+
+  mechanism::Planner   planner;
+  mechanism::Estimator estimator;
+
+  std::array<mechanism::planner::AxisLimit, 3> limits;
+  std::array<mechanism::estimator::Axis, 3>    parameters;
+  for (std::size_t i = 0; i < axes.size(); ++i) {
+    const auto& stepper = axes[i].stepper;
+    limits[i] = mechanism::Planner::axis_limit(
+        *speeds[i], axes[i].steps_per_mm, stepper->microsteps(),
+        stepper->motor_steps());
+    parameters[i] = mechanism::Estimator::axis(
+        *speeds[i], axes[i].mode, axes[i].steps_per_mm, stepper->microsteps(),
+        stepper->motor_steps());
+  }
+  planner.limits(limits[0], limits[1], limits[2]);
+  estimator.axes(parameters[0], parameters[1], parameters[2]);
+
+  time_unit time = 0;
+
+  // same as Movement::follow_path
+  mechanism::planner::position start{0.0, 0.0, 0.0};
+  for (const auto& path : workload.paths) {
+    if (path.empty()) {
+      continue;
+    }
+    time += mechanism::Planner::duration(planner.plan(start, path));
+    start = path.back();
+  }
+
+  // same as Movement::move
+  for (const auto& [from, to] : workload.moves) {
+    time += estimator.move(from, to).duration;
+  }
+
+  return time;
+}
+
+static std::array<device::stepper::step, 3> longest_moves(
+    const axis_container& axes,
+    const Workload&       workload) {
+  std::array<device::stepper::step, 3> longest{0, 0, 0};
+
+  const auto measure = [&axes, &longest](
+                             const mechanism::planner::position& from,
+                             const mechanism::planner::position& to) {
+    for (std::size_t i = 0; i < axes.size(); ++i) {
+      longest[i] = std::max<device::stepper::step>(
+          longest[i], std::lround(std::abs(to[i] - from[i]) *
+                                  static_cast<double>(axes[i].steps_per_mm)));
+    }
+  };
+
+  for (const auto& path : workload.paths) {
+    mechanism::planner::position from{0.0, 0.0, 0.0};
+    for (const auto& to : path) {
+      measure(from, to);
+      from = to;
+    }
+  }
+
+  for (const auto& [from, to] : workload.moves) {
+    measure(from, to);
+  }
+
+  return longest;
+}
+
+static void travel(Workload&                           workload,
+                   const mechanism::planner::position& from,
+                   const mechanism::planner::position& to) {
+  massert(Config::get() != nullptr, "sanity");
+
+  const auto safe_height = Config::get()->clearance<Point>("safe-height");
+
+  // same parts as Movement::travel
+  const Point lift_z = std::min(from[2], safe_height);
+  const Point land_z = std::min(to[2], safe_height);
+
+  if (from[2] > lift_z) {
+    workload.moves.push_back({from, {from[0], from[1], lift_z}});
+  }
+
+  workload.moves.push_back(
+      {{from[0], from[1], lift_z}, {to[0], to[1], land_z}});
+
+  if (to[2] > land_z) {
+    workload.moves.push_back({{to[0], to[1], land_z}, to});
+  }
+}
+
+static std::vector<Candidate> pareto(std::vector<Candidate> candidates) {
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              if (a.time != b.time) {
+                return a.time < b.time;
+              }
+              if (a.acceleration != b.acceleration) {
+                return a.acceleration < b.acceleration;
+              }
+              return a.velocity < b.velocity;
+            });
+
+  // every member of front is at least as fast as the candidate
+  std::vector<Candidate> front;
+  for (const auto& candidate : candidates) {
+    const bool dominated = std::any_of(
+        front.begin(), front.end(), [&candidate](const Candidate& member) {
+          return member.acceleration <= candidate.acceleration &&
+                 member.velocity <= candidate.velocity;
+        });
+
+    if (!dominated) {
+      front.push_back(candidate);
+    }
+  }
+
+  return front;
+}
+
+static std::vector<Candidate> tune(const axis_container& axes,
+                                   const Constraints&    constraints,
+                                   const Workload&       workload) {
+  const auto& current =
+      workload.current[static_cast<std::size_t>(config::speed::normal)];
+  const auto longest = longest_moves(axes, workload);
+
+  const auto x = search_axis(axes[0], constraints, longest[0], current.x);
+  const auto y = search_axis(axes[1], constraints, longest[1], current.y);
+  const auto z = search_axis(axes[2], constraints, longest[2], current.z);
+
+  LOG_INFO("{}: {} x {} x {} feasible axis speeds", workload.name, x.size(),
+           y.size(), z.size());
+
+  // x-axis and y-axis are searched with the current speed of z-axis first
+  std::vector<Candidate> planar_candidates;
+  planar_candidates.reserve(x.size() * y.size());
+  for (const auto& cx : x) {
+    for (const auto& cy : y) {
+      Candidate candidate;
+      candidate.speed = current;
+      candidate.speed.x = cx.speed;
+      candidate.speed.y = cy.speed;
+      candidate.time = replay_workload(axes, workload, candidate.speed);
+      candidate.acceleration = std::max(cx.acceleration, cy.acceleration);
+      candidate.velocity = std::max(cx.velocity, cy.velocity);
+      planar_candidates.push_back(candidate);
+    }
+  }
+
+  const auto planar_front = pareto(std::move(planar_candidates));
+
+  // finger moves together with x-axis and y-axis, so every speed of z-axis
+  // is replayed with every speed of the planar front
+  std::vector<Candidate> candidates;
+  candidates.reserve(planar_front.size() * z.size());
+  for (const auto& p : planar_front) {
+    for (const auto& cz : z) {
+      Candidate candidate = p;
+      candidate.speed.z = cz.speed;
+      candidate.time = replay_workload(axes, workload, candidate.speed);
+      candidate.acceleration = std::max(p.acceleration, cz.acceleration);
+      candidate.velocity = std::max(p.velocity, cz.velocity);
+      candidates.push_back(candidate);
+    }
+  }
+
+  return pareto(std::move(candidates));
+}
+
+static void emit(const Workload&               workload,
+                 const std::vector<Candidate>& front,
+                 time_unit                     current) {
+  LOG_INFO("{}: {} Pareto-best profiles, normal profile takes {:.2f} s",
+           workload.name, front.size(), static_cast<double>(current) / 1e+6);
+
+  for (const auto& candidate : front) {
+    LOG_INFO(
+        "{:.2f} s, {:.0f} mm/s^2, {:.0f} mm/s | x {:.0f} rpm {:.0f}/{:.0f} | "
+        "y {:.0f} rpm {:.0f}/{:.0f} | z {:.0f} rpm {:.0f}/{:.0f}",
+        static_cast<double>(candidate.time) / 1e+6, candidate.acceleration,
+        candidate.velocity, candidate.speed.x.rpm,
+        candidate.speed.x.acceleration, candidate.speed.x.deceleration,
+        candidate.speed.y.rpm, candidate.speed.y.acceleration,
+        candidate.speed.y.deceleration, candidate.speed.z.rpm,
+        candidate.speed.z.acceleration, candidate.speed.z.deceleration);
+  }
+
+  if (front.empty()) {
+    return;
+  }
+
+  // fastest, middle, and gentlest of the front
+  const std::array<std::pair<std::string, const Candidate*>, 3> picks{
+      {{"slow", &front.back()},
+       {"normal", &front[front.size() / 2]},
+       {"fast", &front.front()}}};
+
+  std::cout << "# " << workload.name << ", generated by tuner" << std::endl;
+  for (std::size_t i = 0; i < picks.size(); ++i) {
+    const auto& [label, candidate] = picks[i];
+
+    std::cout << fmt::format("[{}.{}]\n", workload.key, label);
+    std::cout << fmt::format("{:<29}= {}\n\n", "duty-cycle",
+                             workload.current[i].duty_cycle);
+
+    const std::array<std::pair<char, const config::Speed*>, 3> axes{
+        {{'x', &candidate->speed.x},
+         {'y', &candidate->speed.y},
+         {'z', &candidate->speed.z}}};
+
+    for (const auto& [name, speed] : axes) {
+      std::cout << fmt::format("[{}.{}.{}]\n", workload.key, label, name);
+      std::cout << fmt::format("{:<29}= {:.1f}\n", "rpm", speed->rpm);
+      std::cout << fmt::format("{:<29}= {:.1f} # steps / s^2\n",
+                               "acceleration", speed->acceleration);
+      std::cout << fmt::format("{:<29}= {:.1f} # steps / s^2\n",
+                               "deceleration", speed->deceleration);
+      std::cout << fmt::format("{:<29}= {:.1f} # steps / s^3\n\n", "jerk",
+                               speed->jerk);
+    }
+  }
+}
+
+static Workload homing_workload() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  const auto  safe_height = config->clearance<Point>("safe-height");
+  const auto& spraying_position = config->spraying_position();
+  const auto& tending_position = config->tending_position();
+
+  Workload workload;
+  workload.name = "Homing";
+  workload.key = "mechanisms.homing.speed";
+  workload.current = {config->homing_speed_profile(config::speed::slow),
+                  config->homing_speed_profile(config::speed::normal),
+                  config->homing_speed_profile(config::speed::fast)};
+
+  // travel of every task runs with homing speed
+  workload.moves.push_back(
+      {{0.0, 0.0, 0.0},
+       {spraying_position.first, spraying_position.second, 0.0}});
+
+  // finger is lowered to the safe height on the way to tending position
+  travel(workload, {0.0, 0.0, 0.0},
+         {tending_position.first, tending_position.second, safe_height});
+  workload.moves.push_back(
+      {{tending_position.first, tending_position.second, safe_height},
+       {tending_position.first, tending_position.second,
+        mechanism::movement::finger_travel}});
+  workload.moves.push_back(
+      {{tending_position.first, tending_position.second,
+        mechanism::movement::finger_travel},
+       {tending_position.first, tending_position.second, 0.0}});
+
+  // finger stays down between cleaning stations, travel lifts it
+  mechanism::planner::position from{0.0, 0.0, 0.0};
+  for (const auto& [x, y, time, sonicator] :
+       mechanism::Route::get()->cleaning_stations()) {
+    travel(workload, from, {x, y, safe_height});
+    workload.moves.push_back(
+        {{x, y, safe_height}, {x, y, mechanism::movement::finger_travel}});
+    from = {x, y, mechanism::movement::finger_travel};
+  }
+  workload.moves.push_back({from, {from[0], from[1], 0.0}});
+
+  return workload;
+}
+
+static Workload spraying_workload() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  Workload workload;
+  workload.name = "Spraying";
+  workload.key = "mechanisms.spraying.speed";
+  workload.current = {config->spraying_speed_profile(config::speed::slow),
+                  config->spraying_speed_profile(config::speed::normal),
+                  config->spraying_speed_profile(config::speed::fast)};
+
+  // spraying path is relative to spraying position
+  std::vector<mechanism::planner::position> path;
+  for (const auto& [x, y] : mechanism::Route::get()->spraying_path()) {
+    path.push_back({x, y, 0.0});
+  }
+  workload.paths.push_back(std::move(path));
+
+  return workload;
+}
+
+static Workload tending_workload() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  Workload workload;
+  workload.name = "Tending";
+  workload.key = "mechanisms.tending.speed";
+  workload.current = {config->tending_speed_profile(config::speed::slow),
+                  config->tending_speed_profile(config::speed::normal),
+                  config->tending_speed_profile(config::speed::fast)};
+
+  // tending paths are relative to tending position
+  for (const auto* container :
+       {&config->tending_path_edge(), &config->tending_path_zigzag()}) {
+    std::vector<mechanism::planner::position> path;
+    for (const auto& [x, y] : *container) {
+      path.push_back({x, y, 0.0});
+    }
+    workload.paths.push_back(std::move(path));
+  }
+
+  return workload;
+}
+
+int main() {
+  ATM_STATUS status = ATM_OK;
+
+  status = init();
+  if (status == ATM_ERR) {
+    return throw_message();
+  }
+
+  auto* config = Config::get();
+  auto* stepper_registry = device::StepperRegistry::get();
+
+  const axis_container axes{
+      Axis{stepper_registry->get(device::id::stepper::x()),
+           mechanism::Estimator::speed_mode(
+               config->stepper_x<std::string>("speed-mode")),
+           config->stepper_x<device::stepper::step>("steps-per-mm")},
+      Axis{stepper_registry->get(device::id::stepper::y()),
+           mechanism::Estimator::speed_mode(
+               config->stepper_y<std::string>("speed-mode")),
+           config->stepper_y<device::stepper::step>("steps-per-mm")},
+      Axis{stepper_registry->get(device::id::stepper::z()),
+           mechanism::Estimator::speed_mode(
+               config->stepper_z<std::string>("speed-mode")),
+           config->stepper_z<device::stepper::step>("steps-per-mm")}};
+
+  for (const auto& axis : axes) {
+    if (!axis.stepper) {
+      LOG_ERROR("Stepper devices are not available");
+      shutdown_hook();
+      return ATM_ERR;
+    }
+  }
+
+  Constraints constraints;
+  constraints.max_step_rate = config->tuner<double>("max-step-rate");
+  constraints.max_jerk = config->tuner<double>("max-jerk");
+  constraints.min_pulse = config->tuner<device::stepper::pulse>("min-pulse");
+
+  for (const auto& workload :
+       {homing_workload(), spraying_workload(), tending_workload()}) {
+    const auto& current =
+        workload.current[static_cast<std::size_t>(config::speed::normal)];
+    emit(workload, tune(axes, constraints, workload),
+         replay_workload(axes, workload, current));
+  }
+
+  shutdown_hook();
+
+  return status;
+}
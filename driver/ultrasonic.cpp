@@ -83,13 +83,28 @@ static bool menu() {
   auto&& disinfectant_level = ultrasonic_device_registry->get(
       device::id::ultrasonic::disinfectant_level());
 
+  if (choice == 0) {
+    return true;
+  }
+
+  // sensors range in the background, the loop only reads the latest level
+  if (choice == 1 || choice == 3) {
+    water_level->start(device::UltrasonicDevice::default_period,
+                       device::UltrasonicDevice::default_window,
+                       config->ultrasonic<double>("water-level", "max-range"));
+  }
+
+  if (choice == 2 || choice == 3) {
+    disinfectant_level->start(
+        device::UltrasonicDevice::default_period,
+        device::UltrasonicDevice::default_window,
+        config->ultrasonic<double>("disinfectant-level", "max-range"));
+  }
+
   time_unit start = seconds();
   if (choice == 1) {
     while (true) {
-      LOG_DEBUG("Distance {} cm", water_level
-                                      ->distance(config->ultrasonic<double>(
-                                          "water-level", "max-range"))
-                                      .value_or(-99.0));
+      LOG_DEBUG("Distance {} cm", water_level->level().value_or(-99.0));
       sleep_for<time_units::millis>(10);
 
       if ((seconds() - start) == duration) {
@@ -98,10 +113,7 @@ static bool menu() {
     }
   } else if (choice == 2) {
     while (true) {
-      LOG_DEBUG("Distance {} cm", disinfectant_level
-                                      ->distance(config->ultrasonic<double>(
-                                          "disinfectant-level", "max-range"))
-                                      .value_or(-99.0));
+      LOG_DEBUG("Distance {} cm", disinfectant_level->level().value_or(-99.0));
       sleep_for<time_units::millis>(10);
 
       if ((seconds() - start) == duration) {
@@ -110,25 +122,20 @@ static bool menu() {
     }
   } else if (choice == 3) {
     while (true) {
-      LOG_DEBUG(
-          "Water Level {} cm, Disinfectant Level {} cm",
-          water_level
-              ->distance(config->ultrasonic<double>("water-level", "max-range"))
-              .value_or(-99.0),
-          disinfectant_level
-              ->distance(
-                  config->ultrasonic<double>("disinfectant-level", "max-range"))
-              .value_or(-99.0));
+      LOG_DEBUG("Water Level {} cm, Disinfectant Level {} cm",
+                water_level->level().value_or(-99.0),
+                disinfectant_level->level().value_or(-99.0));
       sleep_for<time_units::millis>(10);
 
       if ((seconds() - start) == duration) {
         break;
       }
     }
-  } else if (choice == 0) {
-    return true;
   }
 
+  water_level->stop();
+  disinfectant_level->stop();
+
   return false;
 }
 
@@ -9,11 +9,16 @@
  */
 
 // 1. STL
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <future>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <stdexcept>
 #include <string>
@@ -38,4 +43,18 @@
 #include "thread_pool.hpp"
 #include "thread_pool.inline.hpp"
 
+// 4.3. LRU Cache
+#include "lru_cache.hpp"
+#include "lru_cache.inline.hpp"
+
+// 4.4. SPSC Queue
+#include "spsc_queue.hpp"
+#include "spsc_queue.inline.hpp"
+
+// 4.5. Histogram
+#include "histogram.hpp"
+
+// 4.6. Tour
+#include "tour.hpp"
+
 #endif  // LIB_ALGO_ALGO_HPP_
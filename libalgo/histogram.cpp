@@ -0,0 +1,113 @@
+#include "algo.hpp"
+
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+Histogram::Histogram() : count_{0}, sum_{0}, max_{0} {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::record(std::uint64_t value) {
+  buckets_[index(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  std::uint64_t current = max_.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max_.compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+    // recorded by another thread in the meantime
+  }
+}
+
+void Histogram::reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::mean() const {
+  const std::uint64_t values = count();
+  if (values == 0) {
+    return 0.0;
+  }
+
+  return static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+         static_cast<double>(values);
+}
+
+std::uint64_t Histogram::percentile(double percentile) const {
+  const std::uint64_t values = count();
+  if (values == 0) {
+    return 0;
+  }
+
+  // rank of the value, 1-based
+  const auto rank = std::max<std::uint64_t>(
+      static_cast<std::uint64_t>(
+          std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                    static_cast<double>(values))),
+      1);
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < bucket_count; ++i) {
+    seen += bucket(i);
+    if (seen >= rank) {
+      return std::min(highest(i), max());
+    }
+  }
+
+  return max();
+}
+
+std::size_t Histogram::index(std::uint64_t value) {
+  if (value < linear_buckets) {
+    return static_cast<std::size_t>(value);
+  }
+
+  const unsigned int bit = std::min<unsigned int>(
+      static_cast<unsigned int>(std::bit_width(value)) - 1, max_bit);
+  if (bit == max_bit) {
+    return bucket_count - 1;
+  }
+
+  // leading 5 bits select the sub bucket, the rest is dropped
+  const unsigned int shift = bit - sub_bucket_bits;
+  const auto         sub = static_cast<std::size_t>(value >> shift);
+
+  return linear_buckets + (shift - 1) * sub_buckets + (sub - sub_buckets);
+}
+
+std::uint64_t Histogram::lowest(std::size_t index) {
+  if (index < linear_buckets) {
+    return index;
+  }
+
+  const std::size_t   offset = index - linear_buckets;
+  const unsigned int  shift = static_cast<unsigned int>(offset / sub_buckets) + 1;
+  const std::uint64_t sub = offset % sub_buckets + sub_buckets;
+
+  return sub << shift;
+}
+
+std::uint64_t Histogram::highest(std::size_t index) {
+  if (index + 1 >= bucket_count) {
+    return UINT64_MAX;
+  }
+
+  return lowest(index + 1) - 1;
+}
+}  // namespace algo
+
+NAMESPACE_END
@@ -0,0 +1,154 @@
+#ifndef LIB_ALGO_HISTOGRAM_HPP_
+#define LIB_ALGO_HISTOGRAM_HPP_
+
+/** @file histogram.hpp
+ *  @brief Histogram class definition
+ *
+ * Log-linear histogram for latency measurements, in the spirit of
+ * HdrHistogram
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <libcore/core.hpp>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+/**
+ * @brief Histogram implementation.
+ *
+ * Values below 32 have their own bucket, every power of two above that is
+ * split into 16 linear buckets, so any value is kept within 1/16 (6.25%) of
+ * relative error below 2^31 (larger values go to the last bucket).
+ *
+ * Recording is wait-free (a few relaxed atomic operations), so it can be
+ * done from a real-time thread while other threads read. Readings taken
+ * while recording are not an exact snapshot.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Histogram : public StackObj {
+ public:
+  /** Number of buckets that keep exact values */
+  static constexpr std::size_t linear_buckets = 32;
+  /** Number of buckets per power of two */
+  static constexpr std::size_t sub_buckets = 16;
+  /** Number of bits of sub bucket index */
+  static constexpr unsigned int sub_bucket_bits = 4;
+  /** Values with this bit or higher go to the last bucket */
+  static constexpr unsigned int max_bit = 31;
+  /** Number of buckets, including the last one for saturated values */
+  static constexpr std::size_t bucket_count =
+      linear_buckets + (max_bit - sub_bucket_bits - 1) * sub_buckets + 1;
+
+  /**
+   * Histogram Constructor
+   */
+  Histogram();
+  /**
+   * Histogram Destructor
+   */
+  ~Histogram() = default;
+  /**
+   * Record value
+   *
+   * @param value value to record
+   */
+  void record(std::uint64_t value);
+  /**
+   * Clear every recorded value
+   */
+  void reset();
+  /**
+   * Get number of recorded values
+   *
+   * @return number of recorded values
+   */
+  inline std::uint64_t count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+  /**
+   * Get largest recorded value
+   *
+   * @return largest value, 0 if empty
+   */
+  inline std::uint64_t max() const {
+    return max_.load(std::memory_order_relaxed);
+  }
+  /**
+   * Get mean of recorded values
+   *
+   * @return mean, 0 if empty
+   */
+  double mean() const;
+  /**
+   * Get value at percentile
+   *
+   * @param percentile percentile (0-100)
+   *
+   * @return highest value of the bucket where percentile falls, 0 if empty
+   */
+  std::uint64_t percentile(double percentile) const;
+  /**
+   * Get number of values in bucket
+   *
+   * @param index bucket index
+   *
+   * @return number of values
+   */
+  inline std::uint64_t bucket(std::size_t index) const {
+    return buckets_[index].load(std::memory_order_relaxed);
+  }
+  /**
+   * Get bucket index of value
+   *
+   * @param value value
+   *
+   * @return bucket index
+   */
+  static std::size_t index(std::uint64_t value);
+  /**
+   * Get lowest value of bucket
+   *
+   * @param index bucket index
+   *
+   * @return lowest value
+   */
+  static std::uint64_t lowest(std::size_t index);
+  /**
+   * Get highest value of bucket
+   *
+   * @param index bucket index
+   *
+   * @return highest value
+   */
+  static std::uint64_t highest(std::size_t index);
+
+ private:
+  /**
+   * Number of values in each bucket
+   */
+  std::array<std::atomic<std::uint64_t>, bucket_count> buckets_;
+  /**
+   * Number of recorded values
+   */
+  std::atomic<std::uint64_t> count_;
+  /**
+   * Sum of recorded values
+   */
+  std::atomic<std::uint64_t> sum_;
+  /**
+   * Largest recorded value
+   */
+  std::atomic<std::uint64_t> max_;
+};
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_HISTOGRAM_HPP_
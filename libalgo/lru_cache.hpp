@@ -0,0 +1,110 @@
+#ifndef LIB_ALGO_LRU_CACHE_HPP_
+#define LIB_ALGO_LRU_CACHE_HPP_
+
+/** @file lru_cache.hpp
+ *  @brief LRU cache class definition
+ *
+ * Thread-safe least recently used cache with fixed capacity
+ */
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <libcore/core.hpp>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+/**
+ * @brief LRU Cache implementation.
+ *
+ * Least recently used entry will be evicted when the capacity is reached.
+ * Values should be cheap to copy (e.g. shared_ptr) since lookup returns a
+ * copy so the entry can be evicted safely while still being used
+ *
+ * @tparam Key   key type
+ * @tparam Value value type
+ * @tparam Hash  hash function of key
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache : public StackObj {
+ public:
+  /**
+   * LRUCache Constructor
+   *
+   * @param capacity maximum number of entries
+   */
+  explicit LRUCache(std::size_t capacity);
+  /**
+   * LRUCache Destructor
+   */
+  ~LRUCache() = default;
+  /**
+   * Get value of given key, create it with factory if it does not exist
+   *
+   * @param key     key to find
+   * @param factory function to create value if key does not exist
+   *
+   * @return value of given key
+   */
+  template <typename Factory>
+  Value get_or_create(const Key& key, Factory&& factory);
+  /**
+   * Check key exist in the cache or not
+   *
+   * @param key key to find
+   *
+   * @return exist or not
+   */
+  bool exist(const Key& key) const;
+  /**
+   * Remove all entries
+   */
+  void clear();
+  /**
+   * Get number of entries
+   *
+   * @return number of entries
+   */
+  std::size_t size() const;
+  /**
+   * Get capacity
+   *
+   * @return maximum number of entries
+   */
+  inline const std::size_t& capacity() const { return capacity_; }
+
+ private:
+  /**
+   * Entry type, most recently used is at front
+   */
+  using entry = std::pair<Key, Value>;
+  /**
+   * Maximum number of entries
+   */
+  const std::size_t capacity_;
+  /**
+   * Entries ordered by usage
+   */
+  std::list<entry> entries_;
+  /**
+   * Lookup table from key to entry
+   */
+  std::unordered_map<Key, typename std::list<entry>::iterator, Hash> lookup_;
+  /**
+   * Mutex for synchronization
+   */
+  mutable std::mutex mutex_;
+};
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_LRU_CACHE_HPP_
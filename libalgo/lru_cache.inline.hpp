@@ -0,0 +1,62 @@
+#ifndef LIB_ALGO_LRU_CACHE_INLINE_HPP_
+#define LIB_ALGO_LRU_CACHE_INLINE_HPP_
+
+#include "lru_cache.hpp"
+
+NAMESPACE_BEGIN
+
+namespace algo {
+template <typename Key, typename Value, typename Hash>
+LRUCache<Key, Value, Hash>::LRUCache(std::size_t capacity)
+    : capacity_{capacity} {
+  massert(capacity > 0, "sanity");
+  lookup_.reserve(capacity);
+}
+
+template <typename Key, typename Value, typename Hash>
+template <typename Factory>
+Value LRUCache<Key, Value, Hash>::get_or_create(const Key& key,
+                                                Factory&&  factory) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (auto it = lookup_.find(key); it != lookup_.end()) {
+    // move to front (most recently used)
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+
+  if (entries_.size() >= capacity()) {
+    // evict least recently used
+    lookup_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(key, factory());
+  lookup_[key] = entries_.begin();
+
+  return entries_.front().second;
+}
+
+template <typename Key, typename Value, typename Hash>
+bool LRUCache<Key, Value, Hash>::exist(const Key& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lookup_.find(key) != lookup_.end();
+}
+
+template <typename Key, typename Value, typename Hash>
+void LRUCache<Key, Value, Hash>::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lookup_.clear();
+  entries_.clear();
+}
+
+template <typename Key, typename Value, typename Hash>
+std::size_t LRUCache<Key, Value, Hash>::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_LRU_CACHE_INLINE_HPP_
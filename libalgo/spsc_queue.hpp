@@ -0,0 +1,107 @@
+#ifndef LIB_ALGO_SPSC_QUEUE_HPP_
+#define LIB_ALGO_SPSC_QUEUE_HPP_
+
+/** @file spsc_queue.hpp
+ *  @brief Single-producer single-consumer queue class definition
+ *
+ * Lock-free bounded ring buffer for passing commands between two threads
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include <libcore/core.hpp>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+/**
+ * @brief Single-producer single-consumer queue implementation.
+ *
+ * Bounded ring buffer without locks, push and pop never allocate and never
+ * block, so the consumer can be a real-time thread. Exactly one thread may
+ * push and exactly one thread may pop, multiple producers must be serialized
+ * by the caller
+ *
+ * @tparam T        element type, should be cheap to copy
+ * @tparam Capacity number of slots, must be power of two
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+template <typename T, std::size_t Capacity>
+class SPSCQueue : public StackObj {
+  static_assert(Capacity >= 2, "Capacity must be at least 2");
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be power of two");
+
+ public:
+  /**
+   * SPSCQueue Constructor
+   */
+  SPSCQueue();
+  /**
+   * SPSCQueue Destructor
+   */
+  ~SPSCQueue() = default;
+  /**
+   * Push element to the queue
+   *
+   * Must only be called by the producer thread
+   *
+   * @param value element to push
+   *
+   * @return false if the queue is full
+   */
+  bool push(const T& value);
+  /**
+   * Pop element from the queue
+   *
+   * Must only be called by the consumer thread
+   *
+   * @param value element that has been popped
+   *
+   * @return false if the queue is empty
+   */
+  bool pop(T& value);
+  /**
+   * Check queue is empty or not
+   *
+   * Only accurate from producer or consumer thread
+   *
+   * @return empty or not
+   */
+  bool empty() const;
+  /**
+   * Get capacity
+   *
+   * @return number of slots
+   */
+  static constexpr std::size_t capacity() { return Capacity; }
+
+ private:
+  /**
+   * Mask to wrap index into the buffer
+   */
+  static constexpr std::size_t mask = Capacity - 1;
+  /**
+   * Ring buffer
+   */
+  std::array<T, Capacity> buffer_;
+  /**
+   * Next slot to pop, written by consumer only
+   *
+   * Aligned to its own cache line to avoid false sharing with tail
+   */
+  alignas(64) std::atomic<std::size_t> head_;
+  /**
+   * Next slot to push, written by producer only
+   */
+  alignas(64) std::atomic<std::size_t> tail_;
+};
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_SPSC_QUEUE_HPP_
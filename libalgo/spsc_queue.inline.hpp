@@ -0,0 +1,51 @@
+#ifndef LIB_ALGO_SPSC_QUEUE_INLINE_HPP_
+#define LIB_ALGO_SPSC_QUEUE_INLINE_HPP_
+
+#include "spsc_queue.hpp"
+
+NAMESPACE_BEGIN
+
+namespace algo {
+template <typename T, std::size_t Capacity>
+SPSCQueue<T, Capacity>::SPSCQueue() : buffer_{}, head_{0}, tail_{0} {}
+
+template <typename T, std::size_t Capacity>
+bool SPSCQueue<T, Capacity>::push(const T& value) {
+  const auto tail = tail_.load(std::memory_order_relaxed);
+
+  if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+    return false;
+  }
+
+  buffer_[tail & mask] = value;
+  // publish the slot after it has been written
+  tail_.store(tail + 1, std::memory_order_release);
+
+  return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool SPSCQueue<T, Capacity>::pop(T& value) {
+  const auto head = head_.load(std::memory_order_relaxed);
+
+  if (head == tail_.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  value = buffer_[head & mask];
+  // release the slot after it has been read
+  head_.store(head + 1, std::memory_order_release);
+
+  return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool SPSCQueue<T, Capacity>::empty() const {
+  return head_.load(std::memory_order_acquire) ==
+         tail_.load(std::memory_order_acquire);
+}
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_SPSC_QUEUE_INLINE_HPP_
@@ -0,0 +1,268 @@
+#include "algo.hpp"
+
+#include "tour.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+/**
+ * Get node where item is entered
+ *
+ * @param item     item to visit
+ * @param reversed item is visited from exit to entry
+ *
+ * @return entry node
+ */
+static inline tour::node head(const tour::Item& item, bool reversed) {
+  return reversed ? item.exit : item.entry;
+}
+
+/**
+ * Get node where item is left
+ *
+ * @param item     item to visit
+ * @param reversed item is visited from exit to entry
+ *
+ * @return exit node
+ */
+static inline tour::node tail(const tour::Item& item, bool reversed) {
+  return reversed ? item.entry : item.exit;
+}
+
+Tour::Tour(tour::node          start,
+           tour::node          end,
+           tour::cost_function cost,
+           std::size_t         exact_limit)
+    : start_{start},
+      end_{end},
+      cost_{std::move(cost)},
+      exact_limit_{std::min<std::size_t>(exact_limit, 16)} {}
+
+tour::route Tour::identity(const std::vector<tour::Item>& items) {
+  tour::route route;
+  route.reserve(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    route.push_back({i, false});
+  }
+  return route;
+}
+
+double Tour::link(tour::node from, tour::node to) const {
+  return (to == tour::no_node) ? 0.0 : cost_(from, to);
+}
+
+double Tour::cost(const std::vector<tour::Item>& items,
+                  const tour::route&             route) const {
+  double     total = 0.0;
+  tour::node at = start_;
+
+  for (const auto& [item, reversed] : route) {
+    total += link(at, head(items[item], reversed));
+    at = tail(items[item], reversed);
+  }
+
+  return total + link(at, end_);
+}
+
+tour::route Tour::solve(const std::vector<tour::Item>& items) const {
+  if (items.size() <= 1) {
+    auto route = identity(items);
+    improve(items, route);
+    return route;
+  }
+
+  if (items.size() <= exact_limit_) {
+    return exact(items);
+  }
+
+  auto route = nearest(items);
+  improve(items, route);
+  return route;
+}
+
+tour::route Tour::exact(const std::vector<tour::Item>& items) const {
+  constexpr double inf = std::numeric_limits<double>::infinity();
+
+  const std::size_t n = items.size();
+  const std::size_t states = std::size_t{1} << n;
+
+  // state is (visited items, last item, last item reversed)
+  const auto index = [n](std::size_t mask, std::size_t item, bool reversed) {
+    return (mask * n + item) * 2 + (reversed ? 1 : 0);
+  };
+
+  std::vector<double>      best(states * n * 2, inf);
+  std::vector<std::size_t> parent(states * n * 2, SIZE_MAX);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    for (const bool reversed : {false, true}) {
+      if (reversed && !items[i].reversible) {
+        continue;
+      }
+      best[index(std::size_t{1} << i, i, reversed)] =
+          link(start_, head(items[i], reversed));
+    }
+  }
+
+  for (std::size_t mask = 1; mask < states; ++mask) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (((mask >> i) & 1) == 0) {
+        continue;
+      }
+
+      for (const bool reversed : {false, true}) {
+        const double current = best[index(mask, i, reversed)];
+        if (current == inf) {
+          continue;
+        }
+
+        const tour::node at = tail(items[i], reversed);
+
+        for (std::size_t j = 0; j < n; ++j) {
+          if ((mask >> j) & 1) {
+            continue;
+          }
+
+          for (const bool next_reversed : {false, true}) {
+            if (next_reversed && !items[j].reversible) {
+              continue;
+            }
+
+            const std::size_t next =
+                index(mask | (std::size_t{1} << j), j, next_reversed);
+            const double candidate =
+                current + link(at, head(items[j], next_reversed));
+
+            if (candidate < best[next]) {
+              best[next] = candidate;
+              parent[next] = index(mask, i, reversed);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // cheapest full state including the way to the end
+  const std::size_t full = states - 1;
+  double            lowest = inf;
+  std::size_t       last = SIZE_MAX;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    for (const bool reversed : {false, true}) {
+      const std::size_t state = index(full, i, reversed);
+      if (best[state] == inf) {
+        continue;
+      }
+
+      const double total = best[state] + link(tail(items[i], reversed), end_);
+      if (total < lowest) {
+        lowest = total;
+        last = state;
+      }
+    }
+  }
+
+  tour::route route;
+  route.reserve(n);
+  for (std::size_t state = last; state != SIZE_MAX; state = parent[state]) {
+    route.push_back({(state / 2) % n, (state % 2) == 1});
+  }
+  std::reverse(route.begin(), route.end());
+
+  return route;
+}
+
+tour::route Tour::nearest(const std::vector<tour::Item>& items) const {
+  tour::route       route;
+  std::vector<bool> visited(items.size(), false);
+  tour::node        at = start_;
+
+  route.reserve(items.size());
+
+  while (route.size() < items.size()) {
+    double      lowest = std::numeric_limits<double>::infinity();
+    tour::Visit next{0, false};
+
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      if (visited[i]) {
+        continue;
+      }
+
+      for (const bool reversed : {false, true}) {
+        if (reversed && !items[i].reversible) {
+          continue;
+        }
+
+        const double candidate = link(at, head(items[i], reversed));
+        if (candidate < lowest) {
+          lowest = candidate;
+          next = {i, reversed};
+        }
+      }
+    }
+
+    visited[next.item] = true;
+    at = tail(items[next.item], next.reversed);
+    route.push_back(next);
+  }
+
+  return route;
+}
+
+void Tour::improve(const std::vector<tour::Item>& items,
+                   tour::route&                   route) const {
+  // a move has to win by more than rounding noise, so it always terminates
+  constexpr double epsilon = 1e-9;
+
+  double current = cost(items, route);
+  bool   improved = true;
+
+  while (improved) {
+    improved = false;
+
+    // 2-opt, reversing a run also reverses direction of every item in it
+    for (std::size_t i = 0; i + 1 < route.size(); ++i) {
+      for (std::size_t j = i + 1; j < route.size(); ++j) {
+        tour::route candidate = route;
+        std::reverse(candidate.begin() + static_cast<std::ptrdiff_t>(i),
+                     candidate.begin() + static_cast<std::ptrdiff_t>(j) + 1);
+        for (std::size_t k = i; k <= j; ++k) {
+          if (items[candidate[k].item].reversible) {
+            candidate[k].reversed = !candidate[k].reversed;
+          }
+        }
+
+        const double total = cost(items, candidate);
+        if (total < current - epsilon) {
+          route = std::move(candidate);
+          current = total;
+          improved = true;
+        }
+      }
+    }
+
+    // flip direction of single item
+    for (auto& visit : route) {
+      if (!items[visit.item].reversible) {
+        continue;
+      }
+
+      visit.reversed = !visit.reversed;
+      const double total = cost(items, route);
+      if (total < current - epsilon) {
+        current = total;
+        improved = true;
+      } else {
+        visit.reversed = !visit.reversed;
+      }
+    }
+  }
+}
+}  // namespace algo
+
+NAMESPACE_END
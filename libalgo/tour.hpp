@@ -0,0 +1,200 @@
+#ifndef LIB_ALGO_TOUR_HPP_
+#define LIB_ALGO_TOUR_HPP_
+
+/** @file tour.hpp
+ *  @brief Tour class definition
+ *
+ * Visiting order optimizer for stations and reversible segments
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <libcore/core.hpp>
+
+NAMESPACE_BEGIN
+
+namespace algo {
+// forward declaration
+class Tour;
+
+namespace tour {
+/**
+ * @var using node = std::size_t
+ * @brief Type definition for node of cost function
+ */
+using node = std::size_t;
+
+/**
+ * @var using cost_function = std::function<double(node, node)>
+ * @brief Type definition for cost of travelling from one node to another
+ */
+using cost_function = std::function<double(node, node)>;
+
+/** Node that marks a tour without fixed end */
+static constexpr node no_node = SIZE_MAX;
+
+/** Default maximum number of items that are solved exactly */
+static constexpr std::size_t exact_limit = 9;
+
+/**
+ * @brief Item to visit
+ *
+ * Single station has the same entry and exit node, a segment is entered at
+ * one node and left at the other.
+ */
+struct Item {
+  /**
+   * Node where item is entered
+   */
+  node entry;
+  /**
+   * Node where item is left
+   */
+  node exit;
+  /**
+   * Item may be visited from exit to entry
+   */
+  bool reversible;
+};
+
+/**
+ * @brief Visit of an item
+ */
+struct Visit {
+  /**
+   * Index of the item
+   */
+  std::size_t item;
+  /**
+   * Item is visited from exit to entry
+   */
+  bool reversed;
+};
+
+/**
+ * @var using route = std::vector<Visit>
+ * @brief Type definition for visiting order
+ */
+using route = std::vector<Visit>;
+}  // namespace tour
+
+/**
+ * @brief Tour implementation.
+ *
+ * Finds the order (and direction) to visit every item that minimizes the
+ * total travel cost between them, starting from a fixed node and optionally
+ * ending at a fixed node. Travel inside an item does not depend on the order,
+ * so it is not part of the cost.
+ *
+ * Small problems are solved exactly with dynamic programming over subsets
+ * (Held-Karp), larger ones start from nearest neighbour and are improved with
+ * 2-opt and direction flips until no move helps.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Tour : public StackObj {
+ public:
+  /**
+   * Tour Constructor
+   *
+   * @param start       node where tour starts
+   * @param end         node where tour ends, tour::no_node for open tour
+   * @param cost        cost of travelling between nodes
+   * @param exact_limit maximum number of items that are solved exactly
+   */
+  Tour(tour::node          start,
+       tour::node          end,
+       tour::cost_function cost,
+       std::size_t         exact_limit = tour::exact_limit);
+  /**
+   * Tour Destructor
+   */
+  ~Tour() = default;
+  /**
+   * Find the best visiting order
+   *
+   * @param items items to visit
+   *
+   * @return visiting order
+   */
+  tour::route solve(const std::vector<tour::Item>& items) const;
+  /**
+   * Get total travel cost of visiting order
+   *
+   * @param items items to visit
+   * @param route visiting order
+   *
+   * @return total travel cost
+   */
+  double cost(const std::vector<tour::Item>& items,
+              const tour::route&             route) const;
+  /**
+   * Get visiting order as given
+   *
+   * @param items items to visit
+   *
+   * @return visiting order without reordering
+   */
+  static tour::route identity(const std::vector<tour::Item>& items);
+
+ private:
+  /**
+   * Solve exactly with dynamic programming over subsets
+   *
+   * @param items items to visit
+   *
+   * @return best visiting order
+   */
+  tour::route exact(const std::vector<tour::Item>& items) const;
+  /**
+   * Build visiting order by always going to the cheapest next item
+   *
+   * @param items items to visit
+   *
+   * @return visiting order
+   */
+  tour::route nearest(const std::vector<tour::Item>& items) const;
+  /**
+   * Improve visiting order with 2-opt and direction flips
+   *
+   * @param items items to visit
+   * @param route visiting order to improve
+   */
+  void improve(const std::vector<tour::Item>& items, tour::route& route) const;
+  /**
+   * Get travel cost between nodes
+   *
+   * @param from node to travel from
+   * @param to   node to travel to, tour::no_node costs nothing
+   *
+   * @return travel cost
+   */
+  double link(tour::node from, tour::node to) const;
+
+ private:
+  /**
+   * Node where tour starts
+   */
+  const tour::node start_;
+  /**
+   * Node where tour ends
+   */
+  const tour::node end_;
+  /**
+   * Cost of travelling between nodes
+   */
+  const tour::cost_function cost_;
+  /**
+   * Maximum number of items that are solved exactly
+   */
+  const std::size_t exact_limit_;
+};
+}  // namespace algo
+
+NAMESPACE_END
+
+#endif  // LIB_ALGO_TOUR_HPP_
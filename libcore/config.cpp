@@ -17,6 +17,9 @@ struct from<ns(config::Speed)> {
     sc.rpm = find<double>(v, "rpm");
     sc.acceleration = find<double>(v, "acceleration");
     sc.deceleration = find<double>(v, "deceleration");
+    if (v.contains("jerk")) {
+      sc.jerk = find<double>(v, "jerk");
+    }
     return sc;
   }
 };
@@ -73,11 +76,12 @@ Speed::Speed() {
   rpm = 0.0;
   acceleration = 0.0;
   deceleration = 0.0;
+  jerk = 0.0;
 }
 
 DEBUG_ONLY_DEFINITION(void Speed::print(std::ostream& os) const {
   os << "[rpm: " << rpm << ", accel: " << acceleration
-     << ", decel: " << deceleration << "]";
+     << ", decel: " << deceleration << ", jerk: " << jerk << "]";
 })
 
 MechanismSpeed::MechanismSpeed() {
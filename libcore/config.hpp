@@ -54,6 +54,7 @@ struct Speed {
   double rpm;
   double acceleration;
   double deceleration;
+  double jerk;
 };
 
 /**
@@ -196,6 +197,20 @@ class ConfigImpl : public StackObj {
    */
   const config::MechanismSpeed& cleaning_speed_profile(
       const config::speed& speed_profile) const;
+  /**
+   * Get stepper device info
+   *
+   * It should be in key "devices.stepper"
+   *
+   * @tparam T     type of config value
+   * @tparam Keys  variadic args for keys (should be string)
+   *
+   * @return stepper info with type T
+   */
+  template <typename T, typename... Keys>
+  inline T stepper(Keys&&... keys) const {
+    return find<T>("devices", "stepper", std::forward<Keys>(keys)...);
+  }
   /**
    * Get stepper x-axis device info
    *
@@ -448,6 +463,20 @@ class ConfigImpl : public StackObj {
      * @return cleaning station at specified index
      */
     const cleaning& cleaning_station(size_t idx);
+    /**
+     * Get fault configuration
+     *
+     * It should be in key "mechanisms.fault"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return fault configuration
+     */
+    template <typename T, typename... Keys>
+    inline T fault(Keys && ... keys) const {
+      return find<T>("mechanisms", "fault", std::forward<Keys>(keys)...);
+    }
     /**
      * Get mechanisms fault manual mode movement
      *
@@ -463,6 +492,90 @@ class ConfigImpl : public StackObj {
       return find<T>("mechanisms", "fault", "manual", "movement",
                      std::forward<Keys>(keys)...);
     }
+    /**
+     * Get motion executor configuration
+     *
+     * It should be in key "mechanisms.motion"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return motion executor configuration
+     */
+    template <typename T, typename... Keys>
+    inline T motion(Keys && ... keys) const {
+      return find<T>("mechanisms", "motion", std::forward<Keys>(keys)...);
+    }
+    /**
+     * Get clearance configuration
+     *
+     * It should be in key "mechanisms.clearance"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return clearance configuration
+     */
+    template <typename T, typename... Keys>
+    inline T clearance(Keys && ... keys) const {
+      return find<T>("mechanisms", "clearance", std::forward<Keys>(keys)...);
+    }
+    /**
+     * Get route optimizer configuration
+     *
+     * It should be in key "mechanisms.route"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return route optimizer configuration
+     */
+    template <typename T, typename... Keys>
+    inline T route(Keys && ... keys) const {
+      return find<T>("mechanisms", "route", std::forward<Keys>(keys)...);
+    }
+    /**
+     * Get speed profile tuner configuration
+     *
+     * It should be in key "mechanisms.tuner"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return speed profile tuner configuration
+     */
+    template <typename T, typename... Keys>
+    inline T tuner(Keys && ... keys) const {
+      return find<T>("mechanisms", "tuner", std::forward<Keys>(keys)...);
+    }
+    /**
+     * Get compiled motion plan cache configuration
+     *
+     * It should be in key "mechanisms.plan-cache"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return compiled motion plan cache configuration
+     */
+    template <typename T, typename... Keys>
+    inline T plan_cache(Keys && ... keys) const {
+      return find<T>("mechanisms", "plan-cache", std::forward<Keys>(keys)...);
+    }
+    /**
+     * Get homing mechanism configuration
+     *
+     * It should be in key "mechanisms.homing"
+     *
+     * @tparam T     type of config value
+     * @tparam Keys  variadic args for keys (should be string)
+     *
+     * @return homing mechanism configuration
+     */
+    template <typename T, typename... Keys>
+    inline T homing(Keys && ... keys) const {
+      return find<T>("mechanisms", "homing", std::forward<Keys>(keys)...);
+    }
     /**
      * Get shift register device configuration
      *
@@ -62,6 +62,10 @@ StateImpl::StateImpl()
     : speed_profile_{config::speed::normal},
       running_{false},
       coordinate_{0.0, 0.0, 0.0},
+      step_counters_{nullptr},
+      step_origin_{0, 0, 0},
+      steps_per_mm_{1.0, 1.0, 1.0},
+      last_position_notify_{0},
       tending_{},
       spraying_{},
       cleaning_{},
@@ -114,18 +118,79 @@ void StateImpl::running(bool run) {
   notify_all();
 }
 
+std::array<std::int64_t, 3> StateImpl::steps() const {
+  if (step_counters_ == nullptr) {
+    return {0, 0, 0};
+  }
+
+  const auto& counters = *step_counters_;
+  return {counters[0].load(std::memory_order_acquire),
+          counters[1].load(std::memory_order_acquire),
+          counters[2].load(std::memory_order_acquire)};
+}
+
+Coordinate StateImpl::derive(const std::array<std::int64_t, 3>& steps) const {
+  const auto f = [this, &steps](std::size_t axis) {
+    return static_cast<Point>(steps[axis] - step_origin_[axis]) /
+           steps_per_mm_[axis];
+  };
+
+  return {coordinate_.x + f(0), coordinate_.y + f(1), coordinate_.z + f(2)};
+}
+
+template <typename Update>
+void StateImpl::rebase(Update&& update) {
+  // single snapshot, so steps taken meanwhile are not lost
+  const auto snapshot = steps();
+  coordinate_ = derive(snapshot);
+  step_origin_ = snapshot;
+  update(coordinate_);
+}
+
+void StateImpl::track(const StepCounters*          counters,
+                      const std::array<double, 3>& steps_per_mm) {
+  {
+    const StateImpl::StateLock lock(mutex());
+    rebase([](Coordinate&) {});
+    step_counters_ = counters;
+    steps_per_mm_ = steps_per_mm;
+    step_origin_ = steps();
+  }
+  notify_all();
+}
+
+void StateImpl::notify_position() {
+  const time_unit now = micros();
+  time_unit       last = last_position_notify_.load(std::memory_order_relaxed);
+
+  if (now - last < position_notify_interval) {
+    return;
+  }
+
+  // only one thread wins the notification of this interval
+  if (last_position_notify_.compare_exchange_strong(
+          last, now, std::memory_order_relaxed)) {
+    notify_all();
+  }
+}
+
 void StateImpl::coordinate(const Coordinate& coordinate) {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.x = coordinate.x;
-    coordinate_.y = coordinate.y;
-    coordinate_.z = coordinate.z;
+    rebase([&coordinate](Coordinate& current) { current = coordinate; });
   }
   notify_all();
 }
 
-const Coordinate& StateImpl::coordinate() {
-  return coordinate_;
+Coordinate StateImpl::coordinate() {
+  const StateImpl::StateLock lock(mutex());
+  return derive(steps());
+}
+
+Coordinate StateImpl::coordinate(std::array<std::int64_t, 3>& position) {
+  const StateImpl::StateLock lock(mutex());
+  position = steps();
+  return derive(position);
 }
 
 void StateImpl::reset_coordinate() {
@@ -135,7 +200,7 @@ void StateImpl::reset_coordinate() {
 void StateImpl::x(const Point& x) {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.x = x;
+    rebase([&x](Coordinate& current) { current.x = x; });
   }
   notify_all();
 }
@@ -143,7 +208,7 @@ void StateImpl::x(const Point& x) {
 void StateImpl::inc_x() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.x += 1.0;
+    rebase([](Coordinate& current) { current.x += 1.0; });
   }
   notify_all();
 }
@@ -151,20 +216,20 @@ void StateImpl::inc_x() {
 void StateImpl::dec_x() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.x -= 1.0;
+    rebase([](Coordinate& current) { current.x -= 1.0; });
   }
   notify_all();
 }
 
-const Point& StateImpl::x() {
+Point StateImpl::x() {
   const StateImpl::StateLock lock(mutex());
-  return coordinate_.x;
+  return derive(steps()).x;
 }
 
 void StateImpl::y(const Point& y) {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.y = y;
+    rebase([&y](Coordinate& current) { current.y = y; });
   }
   notify_all();
 }
@@ -172,7 +237,7 @@ void StateImpl::y(const Point& y) {
 void StateImpl::inc_y() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.y += 1.0;
+    rebase([](Coordinate& current) { current.y += 1.0; });
   }
   notify_all();
 }
@@ -180,20 +245,20 @@ void StateImpl::inc_y() {
 void StateImpl::dec_y() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.y -= 1.0;
+    rebase([](Coordinate& current) { current.y -= 1.0; });
   }
   notify_all();
 }
 
-const Point& StateImpl::y() {
+Point StateImpl::y() {
   const StateImpl::StateLock lock(mutex());
-  return coordinate_.y;
+  return derive(steps()).y;
 }
 
 void StateImpl::z(const Point& z) {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.z = z;
+    rebase([&z](Coordinate& current) { current.z = z; });
   }
   notify_all();
 }
@@ -201,7 +266,7 @@ void StateImpl::z(const Point& z) {
 void StateImpl::inc_z() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.z += 1.0;
+    rebase([](Coordinate& current) { current.z += 1.0; });
   }
   notify_all();
 }
@@ -209,14 +274,14 @@ void StateImpl::inc_z() {
 void StateImpl::dec_z() {
   {
     const StateImpl::StateLock lock(mutex());
-    coordinate_.z -= 1.0;
+    rebase([](Coordinate& current) { current.z -= 1.0; });
   }
   notify_all();
 }
 
-const Point& StateImpl::z() {
+Point StateImpl::z() {
   const StateImpl::StateLock lock(mutex());
-  return coordinate_.z;
+  return derive(steps()).z;
 }
 
 const Task& StateImpl ::spraying() {
@@ -352,10 +417,18 @@ bool StateImpl::cleaning_complete() {
 }
 
 void StateImpl::fault(bool fault) {
+  std::stop_source source{std::nostopstate};
   {
     const StateImpl::StateLock lock(mutex());
     fault_ = fault;
+    if (fault_ && !manual_mode_) {
+      source = fault_source_;
+    } else if (!fault_ && fault_source_.stop_requested()) {
+      fault_source_ = std::stop_source();
+    }
   }
+  // stop callbacks run on this thread, so they must not take state lock
+  source.request_stop();
   notify_all();
 }
 
@@ -365,10 +438,17 @@ bool StateImpl::fault() {
 }
 
 void StateImpl::manual_mode(bool manual) {
+  std::stop_source source{std::nostopstate};
   {
     const StateImpl::StateLock lock(mutex());
     manual_mode_ = manual;
+    if (manual_mode_ && fault_source_.stop_requested()) {
+      fault_source_ = std::stop_source();
+    } else if (!manual_mode_ && fault_) {
+      source = fault_source_;
+    }
   }
+  source.request_stop();
   notify_all();
 }
 
@@ -377,6 +457,11 @@ bool StateImpl::manual_mode() {
   return manual_mode_;
 }
 
+std::stop_token StateImpl::fault_token() {
+  const StateImpl::StateLock lock(mutex());
+  return fault_source_.get_token();
+}
+
 void StateImpl::homing(bool value) {
   {
     const StateImpl::StateLock lock(mutex());
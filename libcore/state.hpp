@@ -7,9 +7,13 @@
  * Hold all machine's state
  */
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <shared_mutex>
+#include <stop_token>
 #include <thread>
 #include <utility>
 
@@ -36,6 +40,18 @@ using State = StaticObj<impl::StateImpl>;
 
 using Point = double;
 
+/**
+ * @var using StepCounter = std::atomic<std::int64_t>
+ * @brief Type definition for lock-free step position of single axis
+ */
+using StepCounter = std::atomic<std::int64_t>;
+
+/**
+ * @var using StepCounters = std::array<StepCounter, 3>
+ * @brief Type definition for step position of x, y, and z
+ */
+using StepCounters = std::array<StepCounter, 3>;
+
 /**
  * @brief Coordinate
  *
@@ -213,6 +229,25 @@ class StateImpl : public StackObj {
    * @param run  set the running status
    */
   void running(bool run);
+  /**
+   * Track step position counters of the motion layer
+   *
+   * Coordinate is derived from the counters when it is read, so the step
+   * loop only has to update its counters. Current coordinate is kept as the
+   * origin of the counters
+   *
+   * @param counters     step position of x, y, and z, nullptr to stop
+   * tracking
+   * @param steps_per_mm conversion of mm to steps for x, y, and z
+   */
+  void track(const StepCounters*          counters,
+             const std::array<double, 3>& steps_per_mm = {1.0, 1.0, 1.0});
+  /**
+   * Notify all threads that position has changed
+   *
+   * Rate-limited to once every position_notify_interval
+   */
+  void notify_position();
   /**
    * Set new coordinate
    *
@@ -224,7 +259,15 @@ class StateImpl : public StackObj {
    *
    * @return current coordinate
    */
-  const Coordinate& coordinate();
+  Coordinate coordinate();
+  /**
+   * Get coordinate together with the step position it is derived from
+   *
+   * @param position step position of x, y, and z at the coordinate
+   *
+   * @return current coordinate
+   */
+  Coordinate coordinate(std::array<std::int64_t, 3>& position);
   /**
    * Reset coordinate
    */
@@ -248,7 +291,7 @@ class StateImpl : public StackObj {
    *
    * @return  x-axis coordinate
    */
-  const Point& x();
+  Point x();
   /**
    * Set y-axis coordinate
    *
@@ -268,7 +311,7 @@ class StateImpl : public StackObj {
    *
    * @return  y-axis coordinate
    */
-  const Point& y();
+  Point y();
   /**
    * Set z-axis coordinate
    *
@@ -288,7 +331,7 @@ class StateImpl : public StackObj {
    *
    * @return  x-axis coordinate
    */
-  const Point& z();
+  Point z();
   /**
    * Get spraying task
    *
@@ -439,6 +482,16 @@ class StateImpl : public StackObj {
    * @return status of manual mode
    */
   bool manual_mode();
+  /**
+   * Get fault token
+   *
+   * Stop is requested as soon as fault happens outside of manual mode, so
+   * motion can be cancelled without polling fault status. A new token is
+   * used after fault is cleared or manual mode is entered
+   *
+   * @return fault token
+   */
+  std::stop_token fault_token();
   /**
    * Set homing status
    *
@@ -585,6 +638,37 @@ class StateImpl : public StackObj {
    *
    */
   ~StateImpl() = default;
+  /**
+   * Take snapshot of tracked step counters
+   *
+   * @return step position of x, y, and z, zero if not tracking
+   */
+  std::array<std::int64_t, 3> steps() const;
+  /**
+   * Derive coordinate from step position
+   *
+   * Mutex must be held
+   *
+   * @param steps step position of x, y, and z
+   *
+   * @return coordinate in mm
+   */
+  Coordinate derive(const std::array<std::int64_t, 3>& steps) const;
+  /**
+   * Set coordinate at current step position
+   *
+   * Mutex must be held
+   *
+   * @param update function to modify current coordinate
+   */
+  template <typename Update>
+  void rebase(Update&& update);
+
+ public:
+  /**
+   * Minimum interval between position notifications (us)
+   */
+  static constexpr time_unit position_notify_interval = 50000;
 
  private:
   /**
@@ -596,9 +680,25 @@ class StateImpl : public StackObj {
    */
   bool running_;
   /**
-   * Current coordinate
+   * Coordinate at step_origin_
    */
   Coordinate coordinate_;
+  /**
+   * Tracked step counters, owned by the motion layer
+   */
+  const StepCounters* step_counters_;
+  /**
+   * Step position where coordinate_ was taken
+   */
+  std::array<std::int64_t, 3> step_origin_;
+  /**
+   * Conversion of mm to steps for x, y, and z
+   */
+  std::array<double, 3> steps_per_mm_;
+  /**
+   * Timestamp of last position notification
+   */
+  std::atomic<time_unit> last_position_notify_;
   /**
    * State read mutex
    */
@@ -627,6 +727,10 @@ class StateImpl : public StackObj {
    * Manual mode
    */
   bool manual_mode_;
+  /**
+   * Source of fault token
+   */
+  std::stop_source fault_source_;
   /**
    * Homing
    */
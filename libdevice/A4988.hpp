@@ -25,6 +25,9 @@ using ConstantSpeedA4988Device = A4988Device<stepper::speed::constant>;
 /** Linear speed specific implementation for Pololu A4988 Device */
 using LinearSpeedA4988Device = A4988Device<stepper::speed::linear>;
 
+/** S-curve speed specific implementation for Pololu A4988 Device */
+using SCurveSpeedA4988Device = A4988Device<stepper::speed::scurve>;
+
 template <stepper::speed Speed>
 class A4988Device : public impl::StepperDeviceImpl<Speed> {
  public:
@@ -78,6 +81,23 @@ class A4988Device : public impl::StepperDeviceImpl<Speed> {
    * @param microsteps microsteps to set
    */
   virtual void microsteps(const stepper::step& microsteps) override;
+  /**
+   * Switch microstep resolution with MS1, MS2, and MS3 pins
+   *
+   * @param resolution microsteps of the driver (1, 2, 4, 8, or 16)
+   *
+   * @return true if MS pins are written
+   */
+  virtual bool step_resolution(const stepper::step& resolution) override;
+  /**
+   * Get microstep resolution of the driver can be switched or not
+   *
+   * @return true if MS1, MS2, and MS3 pins are wired
+   */
+  inline virtual bool switchable() const override {
+    return ms1_device()->active() && ms2_device()->active() &&
+           ms3_device()->active();
+  }
   /**
    * Get MS1 DigitalOutputDevice that has been initialized
    *
@@ -32,23 +32,26 @@ A4988Device<Speed>::A4988Device(PI_PIN        step_pin,
 
 template <stepper::speed Speed>
 void A4988Device<Speed>::microsteps(const stepper::step& microsteps) {
-  if (microsteps == 0 && microsteps > max_microsteps()) {
+  if (microsteps == 0 || microsteps > max_microsteps()) {
     return;
   }
 
   impl::StepperDeviceImpl<Speed>::microsteps(microsteps);
 
-  if (!ms1_device()->active() || !ms2_device()->active() ||
-      !ms3_device()->active()) {
-    return;
+  [[maybe_unused]] const bool switched = step_resolution(microsteps);
+}
+
+template <stepper::speed Speed>
+bool A4988Device<Speed>::step_resolution(const stepper::step& resolution) {
+  if (!switchable()) {
+    return impl::StepperDeviceImpl<Speed>::step_resolution(resolution);
   }
 
   const stepper::step* table = ms_table();
-  size_t               table_size = ms_table_size();
 
-  size_t i = 0;
-  while (i < table_size) {
-    if (impl::StepperDeviceImpl<Speed>::microsteps() & (1 << i)) {
+  // table is indexed by log2 of resolution
+  for (size_t i = 0; (stepper::step{1} << i) <= max_microsteps(); ++i) {
+    if (resolution == (stepper::step{1} << i)) {
       const stepper::step mask = table[i];
       ms3_device()->write(mask & 4 ? digital::value::high
                                    : digital::value::low);
@@ -56,10 +59,11 @@ void A4988Device<Speed>::microsteps(const stepper::step& microsteps) {
                                    : digital::value::low);
       ms1_device()->write(mask & 1 ? digital::value::high
                                    : digital::value::low);
-      break;
+      return true;
     }
-    ++i;
   }
+
+  return false;
 }
 }  // namespace device
 
@@ -11,6 +11,7 @@
 // 1. STL
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
@@ -46,9 +47,13 @@
 // 4.2. Digital Device
 #include "digital.hpp"
 #include "digital.inline.hpp"
+#include "gpio_bank.hpp"
+#include "gpio_sampler.hpp"
 #include "pwm.hpp"
 
 // 4.3. Stepper Device
+#include "ramp_table.hpp"
+
 #include "stepper.hpp"
 #include "stepper.inline.hpp"
 
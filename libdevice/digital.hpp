@@ -7,9 +7,14 @@
  * Digital device using GPIO
  */
 
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <libalgo/algo.hpp>
 #include <libcore/core.hpp>
@@ -36,6 +41,115 @@ enum class value {
   low,
   high,
 };
+
+enum class edge {
+  rising,
+  falling,
+};
+
+/**
+ * @brief Level change of digital input
+ *
+ * Edge and value already follow the active state of the device
+ */
+struct Event {
+  /**
+   * Edge of the change
+   */
+  digital::edge edge;
+  /**
+   * Value after the change
+   */
+  digital::value value;
+  /**
+   * Time of the change in microseconds since boot (see gpioTick), sampled
+   * by the GPIO library, wraps around every 72 minutes
+   */
+  std::uint32_t tick;
+};
+
+/**
+ * @var using callback = std::function<void(const Event&)>
+ * @brief Type definition for subscriber of level changes
+ */
+using callback = std::function<void(const Event&)>;
+
+/**
+ * @brief Subscription to level changes of digital input
+ *
+ * Unsubscribes when it is destroyed, the callback is never called after
+ * that. Empty subscription is not subscribed to anything.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Subscription : public StackObj {
+ public:
+  /**
+   * Subscription Constructor
+   *
+   * Empty subscription
+   */
+  Subscription() : device_{nullptr}, id_{0} {}
+  /**
+   * Subscription Constructor
+   *
+   * @param device digital input device
+   * @param id     id of subscriber in the device
+   */
+  Subscription(DigitalDevice<mode::input>* device, std::uint64_t id)
+      : device_{device}, id_{id} {}
+  /**
+   * Subscription Move Constructor
+   *
+   * @param other subscription to move from, becomes empty
+   */
+  Subscription(Subscription&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        id_{std::exchange(other.id_, 0)} {}
+  /**
+   * Subscription Move Assignment
+   *
+   * Unsubscribes current subscription first
+   *
+   * @param other subscription to move from, becomes empty
+   *
+   * @return this subscription
+   */
+  Subscription& operator=(Subscription&& other) noexcept;
+  /**
+   * Subscription Destructor
+   *
+   * Unsubscribe
+   */
+  ~Subscription() { reset(); }
+  /**
+   * Check if subscribed
+   *
+   * @return true if subscribed
+   */
+  inline bool active() const { return device_ != nullptr; }
+  /**
+   * Check if subscribed
+   *
+   * @return true if subscribed
+   */
+  inline explicit operator bool() const { return active(); }
+  /**
+   * Unsubscribe, callback is not running anymore when it returns
+   */
+  void reset();
+
+ private:
+  /**
+   * Digital input device
+   */
+  DigitalDevice<mode::input>* device_;
+  /**
+   * Id of subscriber in the device
+   */
+  std::uint64_t id_;
+};
 }  // namespace digital
 
 /** digital::mode::output mode specific implementation of device::DigitalDevice
@@ -74,6 +188,8 @@ class DigitalDevice : public StackObj {
   StaticObj<algo::impl::InstanceRegistryImpl<DigitalDevice>>::create(
       Args&&... args);
 
+  friend class digital::Subscription;
+
  public:
   /**
    * Create shared_ptr<DigitalDevice>
@@ -136,6 +252,22 @@ class DigitalDevice : public StackObj {
   template <digital::mode Mode_ = Mode,
             typename = std::enable_if_t<Mode_ == digital::mode::input>>
   bool read_bool() const;
+  /**
+   * Subscribe to level changes
+   *
+   * Only ENABLE if device mode is INPUT
+   *
+   * Level changes are sampled and timestamped by Pigpio lib, callback runs on
+   * its alert thread, so it must not block, and must not subscribe or
+   * unsubscribe
+   *
+   * @param callback subscriber of level changes
+   *
+   * @return subscription, empty if alert cannot be registered
+   */
+  template <digital::mode Mode_ = Mode,
+            typename = std::enable_if_t<Mode_ == digital::mode::input>>
+  digital::Subscription subscribe(digital::callback callback);
   /**
    * Get GPIO pin that has been initialized
    *
@@ -179,6 +311,21 @@ class DigitalDevice : public StackObj {
    * @return TRUE/FALSE
    */
   inline bool active_state() const { return active_state_; }
+  /**
+   * Set debounce time of GPIO pin
+   *
+   * Level must be stable for this long before device::GpioSampler reports
+   * it, 0 reports raw levels
+   *
+   * @param debounce debounce time (microseconds)
+   */
+  void debounce(std::uint32_t debounce);
+  /**
+   * Get debounce time of GPIO pin
+   *
+   * @return debounce time (microseconds)
+   */
+  inline std::uint32_t debounce() const { return debounce_; }
 
  private:
   /**
@@ -206,6 +353,28 @@ class DigitalDevice : public StackObj {
             typename = std::enable_if_t<Mode_ == digital::mode::input>>
   static digital::value process_value(const int& value,
                                       const bool active_state);
+  /**
+   * Unsubscribe from level changes
+   *
+   * @param id id of subscriber
+   */
+  void unsubscribe(std::uint64_t id);
+  /**
+   * Alert function of Pigpio lib
+   *
+   * @param gpio     gpio pin
+   * @param level    PI_LOW, PI_HIGH, or PI_TIMEOUT
+   * @param tick     time of the change in microseconds since boot
+   * @param userdata digital device
+   */
+  static void alert(int gpio, int level, uint32_t tick, void* userdata);
+  /**
+   * Notify subscribers of level change
+   *
+   * @param level PI_LOW or PI_HIGH
+   * @param tick  time of the change in microseconds since boot
+   */
+  void notify(int level, uint32_t tick);
 
  protected:
   /**
@@ -226,7 +395,7 @@ class DigitalDevice : public StackObj {
    *
    * Close the DigitalDevice that has been initialized
    */
-  virtual ~DigitalDevice() = default;
+  virtual ~DigitalDevice();
 
  protected:
   /**
@@ -241,12 +410,32 @@ class DigitalDevice : public StackObj {
    * Active state
    */
   bool active_state_;
+  /**
+   * Debounce time (microseconds)
+   */
+  std::uint32_t debounce_;
   /**
    * Active status
    *
    * Will become false if only initialize with PI_UNDEF_PIN
    **/
   bool active_;
+  /**
+   * Mutex of subscribers
+   */
+  std::mutex subscribers_mutex_;
+  /**
+   * Subscribers of level changes with their id
+   */
+  std::vector<std::pair<std::uint64_t, digital::callback>> subscribers_;
+  /**
+   * Id of last subscriber
+   */
+  std::uint64_t last_subscriber_;
+  /**
+   * Alert function is registered
+   */
+  bool alert_;
 };
 }  // namespace device
 
@@ -12,7 +12,13 @@ template <digital::mode Mode>
 DigitalDevice<Mode>::DigitalDevice(PI_PIN        pin,
                                    const bool&   active_state,
                                    const PI_PUD& pull)
-    : pin_{pin}, mode_{Mode}, active_state_{active_state}, active_{true} {
+    : pin_{pin},
+      mode_{Mode},
+      active_state_{active_state},
+      debounce_{0},
+      active_{true},
+      last_subscriber_{0},
+      alert_{false} {
   DEBUG_ONLY_DEFINITION(
       obj_name_ = fmt::format("DigitalDevice<{}> pin {} active_state {}",
                               get_mode(Mode), pin, active_state));
@@ -118,6 +124,90 @@ bool DigitalDevice<Mode>::read_bool() const {
   return false;
 }
 
+template <digital::mode Mode>
+DigitalDevice<Mode>::~DigitalDevice() {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+  if (alert_) {
+    gpioSetAlertFuncEx(pin(), nullptr, nullptr);
+  }
+}
+
+template <digital::mode Mode>
+template <digital::mode Mode_, typename>
+digital::Subscription DigitalDevice<Mode>::subscribe(
+    digital::callback callback) {
+  if (!active()) {
+    LOG_DEBUG(
+        "[FAILED] DigitalDevice<{}>::subscribe with pin {}, device is not "
+        "active!",
+        get_mode(Mode), pin_);
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+  if (!alert_) {
+    PI_RES res = gpioSetAlertFuncEx(pin(), &DigitalDevice<Mode>::alert, this);
+
+    if (res != PI_OK) {
+      LOG_DEBUG(
+          "[FAILED] DigitalDevice<{}>::subscribe with pin {}, result = {}",
+          get_mode(Mode), pin_, res);
+      return {};
+    }
+
+    alert_ = true;
+  }
+
+  subscribers_.emplace_back(++last_subscriber_, std::move(callback));
+
+  return {this, last_subscriber_};
+}
+
+template <digital::mode Mode>
+void DigitalDevice<Mode>::unsubscribe(std::uint64_t id) {
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+  std::erase_if(subscribers_, [id](const auto& subscriber) {
+    return subscriber.first == id;
+  });
+
+  if (alert_ && subscribers_.empty()) {
+    gpioSetAlertFuncEx(pin(), nullptr, nullptr);
+    alert_ = false;
+  }
+}
+
+template <digital::mode Mode>
+void DigitalDevice<Mode>::alert([[maybe_unused]] int gpio,
+                                int                  level,
+                                uint32_t             tick,
+                                void*                userdata) {
+  // watchdog timeout is not a level change
+  if (level != PI_LOW && level != PI_HIGH) {
+    return;
+  }
+
+  static_cast<DigitalDevice<Mode>*>(userdata)->notify(level, tick);
+}
+
+template <digital::mode Mode>
+void DigitalDevice<Mode>::notify(int level, uint32_t tick) {
+  // same as process_value of input mode
+  const bool high = (level == PI_HIGH) == active_state();
+
+  const digital::Event event{
+      high ? digital::edge::rising : digital::edge::falling,
+      high ? digital::value::high : digital::value::low, tick};
+
+  std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+  for (const auto& [id, callback] : subscribers_) {
+    callback(event);
+  }
+}
+
 template <digital::mode Mode>
 template <digital::mode Mode_, typename>
 PI_RES DigitalDevice<Mode>::process_value(const digital::value& value,
@@ -161,6 +251,11 @@ void DigitalDevice<Mode>::active_state(bool active_state) {
   active_state_ = active_state;
 }
 
+template <digital::mode Mode>
+void DigitalDevice<Mode>::debounce(std::uint32_t debounce) {
+  debounce_ = debounce;
+}
+
 template <digital::mode Mode>
 ATM_STATUS DigitalDevice<Mode>::pull_up() {
   ATM_STATUS res = gpioSetPullUpDown(pin(), PI_PUD_UP);
@@ -202,6 +297,26 @@ ATM_STATUS DigitalDevice<Mode>::pull_off() {
 
   return res;
 }
+
+namespace digital {
+inline Subscription& Subscription::operator=(Subscription&& other) noexcept {
+  if (this != &other) {
+    reset();
+    device_ = std::exchange(other.device_, nullptr);
+    id_ = std::exchange(other.id_, 0);
+  }
+
+  return *this;
+}
+
+inline void Subscription::reset() {
+  if (device_ != nullptr) {
+    device_->unsubscribe(id_);
+    device_ = nullptr;
+    id_ = 0;
+  }
+}
+}  // namespace digital
 }  // namespace device
 
 NAMESPACE_END
@@ -4,6 +4,167 @@
 
 #ifdef MOCK_GPIO
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Mock recorder
+namespace {
+std::atomic<uint32_t>                mock_levels{0};
+std::array<std::atomic<unsigned>, 6> mock_operations{};
+std::atomic<bool>                    mock_recording{false};
+std::vector<gpioMockOp_t>            mock_log;
+std::mutex                           mock_log_mutex;
+std::atomic<gpioMockReadFunc_t>      mock_read_func{nullptr};
+std::atomic<void*>                   mock_read_userdata{nullptr};
+
+// Mock SPI, a bit of every open handle and bytes written while recording
+std::atomic<uint32_t> mock_spi_handles{0};
+std::vector<char>     mock_spi_log;
+
+// Mock alert, only one of the functions of a GPIO is set
+std::array<std::atomic<gpioAlertFunc_t>, 32>   mock_alert_func{};
+std::array<std::atomic<gpioAlertFuncEx_t>, 32> mock_alert_func_ex{};
+std::array<std::atomic<void*>, 32>             mock_alert_userdata{};
+
+void mock_count(uint32_t op) {
+  mock_operations[op].fetch_add(1, std::memory_order_relaxed);
+}
+
+// level of GPIO, as answered by gpioRead
+int mock_read(int gpio) {
+  if (auto func = mock_read_func.load(std::memory_order_acquire);
+      func != nullptr) {
+    return func(gpio, mock_read_userdata.load(std::memory_order_acquire));
+  }
+
+  return PI_LOW;
+}
+
+// levels of GPIO first to last, bit 0 is the first GPIO
+uint32_t mock_read_bits(int first, int last) {
+  mock_count(PI_MOCK_READ_BITS);
+
+  uint32_t levels = 0;
+  for (int gpio = first; gpio <= last; ++gpio) {
+    if (mock_read(gpio) == PI_HIGH) {
+      levels |= uint32_t{1} << (gpio - first);
+    }
+  }
+
+  return levels;
+}
+
+void mock_record(uint32_t op, uint32_t bits, uint32_t levels) {
+  mock_operations[op].fetch_add(1, std::memory_order_relaxed);
+
+  if (mock_recording.load(std::memory_order_relaxed)) {
+    const uint64_t              tick = micros();
+    std::lock_guard<std::mutex> lock(mock_log_mutex);
+    mock_log.push_back({op, bits, levels, tick});
+  }
+}
+}  // namespace
+
+void gpioMockRecord(int enable) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+  mock_log.clear();
+  mock_spi_log.clear();
+  mock_recording = enable != 0;
+}
+
+void gpioMockReset(void) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+  mock_log.clear();
+  mock_spi_log.clear();
+  mock_levels = 0;
+  for (auto& operations : mock_operations) {
+    operations = 0;
+  }
+}
+
+unsigned gpioMockOperations(unsigned op) {
+  if (op >= mock_operations.size()) {
+    return 0;
+  }
+
+  return mock_operations[op].load(std::memory_order_relaxed);
+}
+
+unsigned gpioMockLog(gpioMockOp_t* ops, unsigned count) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+
+  unsigned copied = 0;
+  for (const auto& op : mock_log) {
+    if (copied == count) {
+      break;
+    }
+    ops[copied++] = op;
+  }
+
+  return copied;
+}
+
+unsigned gpioMockLogSize(void) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+  return static_cast<unsigned>(mock_log.size());
+}
+
+unsigned gpioMockSpi(char* buf, unsigned count) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+
+  unsigned copied = 0;
+  for (const auto& byte : mock_spi_log) {
+    if (copied == count) {
+      break;
+    }
+    buf[copied++] = byte;
+  }
+
+  return copied;
+}
+
+unsigned gpioMockSpiSize(void) {
+  std::lock_guard<std::mutex> lock(mock_log_mutex);
+  return static_cast<unsigned>(mock_spi_log.size());
+}
+
+void gpioMockSetReadFunc(gpioMockReadFunc_t func, void* userdata) {
+  // userdata first, so the function never sees the previous one
+  mock_read_userdata.store(userdata, std::memory_order_release);
+  mock_read_func.store(func, std::memory_order_release);
+}
+
+uint32_t gpioMockLevels(void) {
+  return mock_levels.load(std::memory_order_relaxed);
+}
+
+int gpioMockEdge(int gpio, int level) {
+  if (gpio < 0 || gpio > 31) {
+    return PI_BAD_USER_GPIO;
+  }
+
+  if (level != PI_LOW && level != PI_HIGH && level != PI_TIMEOUT) {
+    return PI_BAD_LEVEL;
+  }
+
+  const uint32_t tick = gpioTick();
+
+  if (auto func = mock_alert_func[gpio].load(std::memory_order_acquire);
+      func != nullptr) {
+    func(gpio, level, tick);
+  }
+
+  if (auto func = mock_alert_func_ex[gpio].load(std::memory_order_acquire);
+      func != nullptr) {
+    func(gpio, level, tick,
+         mock_alert_userdata[gpio].load(std::memory_order_acquire));
+  }
+
+  return PI_OK;
+}
+
 // General
 int gpioInitialise(void) {
   return PI_OK;
@@ -16,15 +177,94 @@ int gpioSetMode([[maybe_unused]] int gpio, [[maybe_unused]] int mode) {
   return PI_OK;
 }
 
-int gpioRead([[maybe_unused]] int gpio) {
+int gpioRead(int gpio) {
+  if (gpio < 0 || gpio > 53) {
+    return PI_BAD_GPIO;
+  }
+
+  mock_count(PI_MOCK_READ);
+
+  return mock_read(gpio);
+}
+
+int gpioWrite(int gpio, int level) {
+  if (gpio < 0 || gpio > 53) {
+    return PI_BAD_GPIO;
+  }
+
+  if (level != PI_LOW && level != PI_HIGH) {
+    return PI_BAD_LEVEL;
+  }
+
+  const uint32_t bits = (gpio < 32) ? (uint32_t{1} << gpio) : 0;
+  const uint32_t levels =
+      (level == PI_HIGH)
+          ? mock_levels.fetch_or(bits, std::memory_order_relaxed) | bits
+          : mock_levels.fetch_and(~bits, std::memory_order_relaxed) & ~bits;
+
+  mock_record(PI_MOCK_WRITE, bits, levels);
+
   return PI_OK;
 }
 
-int gpioWrite([[maybe_unused]] int gpio, [[maybe_unused]] int level) {
+int gpioWrite_Bits_0_31_Clear(uint32_t bits) {
+  const uint32_t levels =
+      mock_levels.fetch_and(~bits, std::memory_order_relaxed) & ~bits;
+
+  mock_record(PI_MOCK_WRITE_CLEAR, bits, levels);
+
   return PI_OK;
 }
 
-// SPI
+int gpioWrite_Bits_0_31_Set(uint32_t bits) {
+  const uint32_t levels =
+      mock_levels.fetch_or(bits, std::memory_order_relaxed) | bits;
+
+  mock_record(PI_MOCK_WRITE_SET, bits, levels);
+
+  return PI_OK;
+}
+
+uint32_t gpioRead_Bits_0_31(void) {
+  return mock_read_bits(0, 31);
+}
+
+uint32_t gpioRead_Bits_32_53(void) {
+  return mock_read_bits(32, 53);
+}
+
+// Alert
+int gpioSetAlertFunc(unsigned user_gpio, gpioAlertFunc_t f) {
+  if (user_gpio > 31) {
+    return PI_BAD_USER_GPIO;
+  }
+
+  mock_alert_func_ex[user_gpio].store(nullptr, std::memory_order_release);
+  mock_alert_func[user_gpio].store(f, std::memory_order_release);
+
+  return PI_OK;
+}
+
+int gpioSetAlertFuncEx(unsigned          user_gpio,
+                       gpioAlertFuncEx_t f,
+                       void*             userdata) {
+  if (user_gpio > 31) {
+    return PI_BAD_USER_GPIO;
+  }
+
+  // userdata first, so the function never sees the previous one
+  mock_alert_func[user_gpio].store(nullptr, std::memory_order_release);
+  mock_alert_userdata[user_gpio].store(userdata, std::memory_order_release);
+  mock_alert_func_ex[user_gpio].store(f, std::memory_order_release);
+
+  return PI_OK;
+}
+
+uint32_t gpioTick(void) {
+  return static_cast<uint32_t>(micros());
+}
+
+// I2C
 int i2cOpen([[maybe_unused]] unsigned int i2cBus,
             [[maybe_unused]] unsigned int i2cAddr,
             [[maybe_unused]] unsigned int i2cFlags) {
@@ -56,6 +296,67 @@ int i2cReadByte([[maybe_unused]] unsigned int handle) {
   return PI_OK;
 }
 
+// SPI
+int spiOpen(unsigned spiChan, unsigned baud, unsigned spiFlags) {
+  // auxiliary SPI has channel 0-2, main SPI has channel 0-1
+  if (spiChan > ((spiFlags & (1 << 8)) ? 2U : 1U)) {
+    return PI_BAD_SPI_CHANNEL;
+  }
+
+  if (baud < 32000 || baud > 125000000) {
+    return PI_BAD_SPI_SPEED;
+  }
+
+  // lowest free handle, handles are reloaded when another one is taken
+  uint32_t handles = mock_spi_handles.load(std::memory_order_relaxed);
+  while (handles != ~uint32_t{0}) {
+    unsigned handle = 0;
+    while (handles & (uint32_t{1} << handle)) {
+      ++handle;
+    }
+
+    if (mock_spi_handles.compare_exchange_weak(
+            handles, handles | (uint32_t{1} << handle))) {
+      return static_cast<int>(handle);
+    }
+  }
+
+  return PI_NO_HANDLE;
+}
+
+int spiClose(unsigned handle) {
+  if (handle > 31) {
+    return PI_BAD_HANDLE;
+  }
+
+  const uint32_t bit = uint32_t{1} << handle;
+  if (!(mock_spi_handles.fetch_and(~bit) & bit)) {
+    return PI_BAD_HANDLE;
+  }
+
+  return PI_OK;
+}
+
+int spiWrite(unsigned handle, char* buf, unsigned count) {
+  if (handle > 31 ||
+      !(mock_spi_handles.load(std::memory_order_relaxed) & (1U << handle))) {
+    return PI_BAD_HANDLE;
+  }
+
+  if (count < 1 || count > 65536) {
+    return PI_BAD_SPI_COUNT;
+  }
+
+  mock_record(PI_MOCK_SPI_WRITE, count, mock_levels.load());
+
+  if (mock_recording.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mock_log_mutex);
+    mock_spi_log.insert(mock_spi_log.end(), buf, buf + count);
+  }
+
+  return static_cast<int>(count);
+}
+
 // PWM
 
 int gpioPWM([[maybe_unused]] unsigned int user_gpio,
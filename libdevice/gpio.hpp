@@ -39,6 +39,8 @@ using PI_PUD = int;
 
 #ifdef MOCK_GPIO
 
+#include <cstdint>
+
 // all interfaces are copied from PIGPIO library
 // credits to @joan2937
 // https://github.com/joan2937/pigpio/blob/master/pigpio.h
@@ -223,6 +225,44 @@ using PI_PUD = int;
 #define PI_PUD_DOWN 1
 #define PI_PUD_UP 2
 
+/* level: 0-1, alert level when watchdog times out */
+
+#define PI_TIMEOUT 2
+
+/* alert callbacks, tick is micros since boot and wraps every 72 minutes */
+
+typedef void (*gpioAlertFunc_t)(int gpio, int level, uint32_t tick);
+
+typedef void (*gpioAlertFuncEx_t)(int      gpio,
+                                  int      level,
+                                  uint32_t tick,
+                                  void*    userdata);
+
+/* mock only, recorded operation */
+
+#define PI_MOCK_WRITE 0
+#define PI_MOCK_WRITE_SET 1
+#define PI_MOCK_WRITE_CLEAR 2
+#define PI_MOCK_SPI_WRITE 3
+
+/* mock only, counted read operation, reads are not logged */
+
+#define PI_MOCK_READ 4
+#define PI_MOCK_READ_BITS 5
+
+typedef struct {
+  uint32_t op;      // PI_MOCK_WRITE, PI_MOCK_WRITE_SET, PI_MOCK_WRITE_CLEAR,
+                    // or PI_MOCK_SPI_WRITE
+  uint32_t bits;    // GPIO 0-31 touched by the operation, or number of
+                    // bytes of SPI write
+  uint32_t levels;  // levels of GPIO 0-31 after the operation
+  uint64_t tick;    // micros() of the operation
+} gpioMockOp_t;
+
+/* mock only, level of input GPIO, must not block */
+
+typedef int (*gpioMockReadFunc_t)(int gpio, void* userdata);
+
 // General
 int  gpioInitialise(void);
 void gpioTerminate(void);
@@ -231,8 +271,19 @@ void gpioTerminate(void);
 int gpioSetMode(int gpio, int mode);
 int gpioRead(int gpio);
 int gpioWrite(int gpio, int level);
+int gpioWrite_Bits_0_31_Clear(uint32_t bits);
+int gpioWrite_Bits_0_31_Set(uint32_t bits);
+uint32_t gpioRead_Bits_0_31(void);
+uint32_t gpioRead_Bits_32_53(void);
 
-// SPI
+// Alert
+int      gpioSetAlertFunc(unsigned user_gpio, gpioAlertFunc_t f);
+int      gpioSetAlertFuncEx(unsigned          user_gpio,
+                            gpioAlertFuncEx_t f,
+                            void*             userdata);
+uint32_t gpioTick(void);
+
+// I2C
 int i2cOpen(unsigned int i2cBus, unsigned int i2cAddr, unsigned int i2cFlags);
 int i2cClose(unsigned int handle);
 
@@ -242,6 +293,11 @@ int i2cReadDevice(unsigned int handle, char* buf, unsigned int count);
 int i2cWriteByte(unsigned int handle, unsigned int bVal);
 int i2cReadByte(unsigned int handle);
 
+// SPI
+int spiOpen(unsigned spiChan, unsigned baud, unsigned spiFlags);
+int spiClose(unsigned handle);
+int spiWrite(unsigned handle, char* buf, unsigned count);
+
 // PWM
 int gpioPWM(unsigned int user_gpio, unsigned int dutycycle);
 int gpioGetPWMdutycycle(unsigned int user_gpio);
@@ -256,6 +312,27 @@ int gpioHardwarePWM(unsigned int gpio,
 
 int gpioSetPullUpDown(unsigned gpio, unsigned pud);
 
+// Mock only, every write and read is counted and the levels of GPIO 0-31 are
+// kept, write operations are only logged while recording is enabled
+void     gpioMockRecord(int enable);
+void     gpioMockReset(void);
+unsigned gpioMockOperations(unsigned op);
+unsigned gpioMockLog(gpioMockOp_t* ops, unsigned count);
+unsigned gpioMockLogSize(void);
+uint32_t gpioMockLevels(void);
+
+// Mock only, bytes of every SPI write while recording is enabled, in order
+unsigned gpioMockSpi(char* buf, unsigned count);
+unsigned gpioMockSpiSize(void);
+
+// Mock only, gpioRead and gpioRead_Bits_* are answered by the function for
+// every GPIO, PI_LOW if it is NULL
+void gpioMockSetReadFunc(gpioMockReadFunc_t func, void* userdata);
+
+// Mock only, alert functions of GPIO 0-31 are called with the level, as if
+// the level has changed at gpioTick(), on the calling thread
+int gpioMockEdge(int gpio, int level);
+
 #else
 
 #include <pigpio.h>
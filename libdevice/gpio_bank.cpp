@@ -0,0 +1,80 @@
+#include "device.hpp"
+
+#include "gpio_bank.hpp"
+
+NAMESPACE_BEGIN
+
+namespace device {
+GpioBank::GpioBank()
+    : set_bits_{0}, clear_bits_{0}, fallback_{}, fallback_count_{0} {}
+
+void GpioBank::clear() {
+  set_bits_ = 0;
+  clear_bits_ = 0;
+  fallback_count_ = 0;
+}
+
+void GpioBank::add(const std::shared_ptr<DigitalOutputDevice>& device,
+                   const digital::value&                       level) {
+  massert(device != nullptr, "sanity");
+
+  if (!device->active()) {
+    return;
+  }
+
+  const auto pin = static_cast<PI_PIN>(device->pin());
+
+  if (!bankable(pin)) {
+    massert(fallback_count_ < fallback_.size(), "sanity");
+    if (fallback_count_ < fallback_.size()) {
+      fallback_[fallback_count_++] = {device.get(), level};
+    }
+    return;
+  }
+
+  const std::uint32_t bit = std::uint32_t{1} << pin;
+  // active state is translated here, once per level
+  const bool high = (level == digital::value::high) == device->active_state();
+
+  if (high) {
+    set_bits_ |= bit;
+    clear_bits_ &= ~bit;
+  } else {
+    clear_bits_ |= bit;
+    set_bits_ &= ~bit;
+  }
+}
+
+void GpioBank::invert() {
+  std::swap(set_bits_, clear_bits_);
+
+  for (std::size_t i = 0; i < fallback_count_; ++i) {
+    auto& fallback = fallback_[i];
+    fallback.level = (fallback.level == digital::value::high)
+                         ? digital::value::low
+                         : digital::value::high;
+  }
+}
+
+ATM_STATUS GpioBank::write() const {
+  ATM_STATUS status = ATM_OK;
+
+  if (set_bits_ != 0 && gpioWrite_Bits_0_31_Set(set_bits_) != PI_OK) {
+    status = ATM_ERR;
+  }
+
+  if (clear_bits_ != 0 && gpioWrite_Bits_0_31_Clear(clear_bits_) != PI_OK) {
+    status = ATM_ERR;
+  }
+
+  for (std::size_t i = 0; i < fallback_count_; ++i) {
+    if (fallback_[i].device->write(fallback_[i].level) == ATM_ERR) {
+      status = ATM_ERR;
+    }
+  }
+
+  return status;
+}
+}  // namespace device
+
+NAMESPACE_END
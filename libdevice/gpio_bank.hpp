@@ -0,0 +1,151 @@
+#ifndef LIB_DEVICE_GPIO_BANK_HPP_
+#define LIB_DEVICE_GPIO_BANK_HPP_
+
+/** @file gpio_bank.hpp
+ *  @brief GPIO bank class definition
+ *
+ * Bank-wide write of GPIO 0-31 with a single set and clear operation
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <libcore/core.hpp>
+
+#include "digital.hpp"
+#include "gpio.hpp"
+
+NAMESPACE_BEGIN
+
+namespace device {
+// forward declaration
+class GpioBank;
+
+namespace gpio_bank {
+/** Maximum number of pins outside of bank 0-31 that can be written */
+static constexpr std::size_t fallback_capacity = 8;
+
+/**
+ * @brief Pin outside of bank 0-31
+ *
+ * Written one by one through DigitalDevice::write
+ */
+struct Fallback {
+  /**
+   * Device to write
+   */
+  DigitalOutputDevice* device;
+  /**
+   * Level to write
+   */
+  digital::value level;
+};
+}  // namespace gpio_bank
+
+/**
+ * @brief GPIO bank implementation.
+ *
+ * Collects levels of many output devices into set and clear masks, active
+ * state is translated once when the level is added. Writing the bank takes
+ * at most two operations (gpioWrite_Bits_0_31_Set and
+ * gpioWrite_Bits_0_31_Clear) regardless of the number of devices, so every
+ * pin in the bank changes at the same time.
+ *
+ * Pins outside of 0-31 cannot be written bank-wide, they are written one by
+ * one after the bank
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class GpioBank : public StackObj {
+ public:
+  /**
+   * GpioBank Constructor
+   */
+  GpioBank();
+  /**
+   * GpioBank Destructor
+   */
+  ~GpioBank() = default;
+  /**
+   * Remove every pending level
+   */
+  void clear();
+  /**
+   * Add level of output device to the bank
+   *
+   * Inactive device is ignored
+   *
+   * @param device output device
+   * @param level  digital::value::high or digital::value::low
+   */
+  void add(const std::shared_ptr<DigitalOutputDevice>& device,
+           const digital::value&                       level);
+  /**
+   * Invert every pending level
+   *
+   * Used to end a pulse with the same devices that started it
+   */
+  void invert();
+  /**
+   * Write every pending level
+   *
+   * Pending levels are kept, so the bank can be written again
+   *
+   * @return ATM_STATUS ATM_OK or ATM_ERR, but not both
+   */
+  ATM_STATUS write() const;
+  /**
+   * Check pin can be written bank-wide or not
+   *
+   * @param pin GPIO pin
+   *
+   * @return bankable or not
+   */
+  static constexpr bool bankable(PI_PIN pin) { return pin >= 0 && pin < 32; }
+  /**
+   * Get mask of pins that will be set to high
+   *
+   * @return set mask
+   */
+  inline std::uint32_t set_bits() const { return set_bits_; }
+  /**
+   * Get mask of pins that will be cleared to low
+   *
+   * @return clear mask
+   */
+  inline std::uint32_t clear_bits() const { return clear_bits_; }
+  /**
+   * Check there is any pending level or not
+   *
+   * @return empty or not
+   */
+  inline bool empty() const {
+    return set_bits_ == 0 && clear_bits_ == 0 && fallback_count_ == 0;
+  }
+
+ private:
+  /**
+   * Pins to set to high
+   */
+  std::uint32_t set_bits_;
+  /**
+   * Pins to clear to low
+   */
+  std::uint32_t clear_bits_;
+  /**
+   * Pins outside of bank
+   */
+  std::array<gpio_bank::Fallback, gpio_bank::fallback_capacity> fallback_;
+  /**
+   * Number of pins outside of bank
+   */
+  std::size_t fallback_count_;
+};
+}  // namespace device
+
+NAMESPACE_END
+
+#endif  // LIB_DEVICE_GPIO_BANK_HPP_
@@ -0,0 +1,177 @@
+#include "device.hpp"
+
+#include "gpio_sampler.hpp"
+
+NAMESPACE_BEGIN
+
+namespace device {
+/** Pins of bank 0-31 */
+static constexpr std::uint64_t bank_low = 0xffffffffULL;
+
+/**
+ * Get bit of pin
+ *
+ * @param pin GPIO pin 0-53
+ *
+ * @return bit n for GPIO n
+ */
+static constexpr std::uint64_t pin_bit(PI_PIN pin) {
+  return std::uint64_t{1} << pin;
+}
+
+std::optional<digital::value> GpioSnapshot::read(
+    const std::shared_ptr<DigitalInputDevice>& device) const {
+  massert(device != nullptr, "sanity");
+
+  const auto pin = static_cast<PI_PIN>(device->pin());
+
+  if (!GpioSampler::sampleable(pin) || !(sampled_ & pin_bit(pin))) {
+    return {};
+  }
+
+  return (levels_ & pin_bit(pin)) ? digital::value::high : digital::value::low;
+}
+
+bool GpioSnapshot::read_bool(
+    const std::shared_ptr<DigitalInputDevice>& device) const {
+  return read(device).value_or(digital::value::low) == digital::value::high;
+}
+
+std::optional<digital::edge> GpioSnapshot::edge(
+    const std::shared_ptr<DigitalInputDevice>& device) const {
+  massert(device != nullptr, "sanity");
+
+  const auto pin = static_cast<PI_PIN>(device->pin());
+
+  if (!GpioSampler::sampleable(pin)) {
+    return {};
+  }
+
+  if (rising_ & pin_bit(pin)) {
+    return digital::edge::rising;
+  } else if (falling_ & pin_bit(pin)) {
+    return digital::edge::falling;
+  }
+
+  return {};
+}
+
+GpioSampler::GpioSampler(std::uint32_t period)
+    : pins_{0},
+      inverted_{0},
+      period_{period},
+      primed_{false},
+      stable_{0},
+      counters_{},
+      thresholds_{} {}
+
+void GpioSampler::add(const std::shared_ptr<DigitalInputDevice>& device) {
+  massert(device != nullptr, "sanity");
+
+  if (!device->active()) {
+    return;
+  }
+
+  const auto pin = static_cast<PI_PIN>(device->pin());
+
+  massert(sampleable(pin), "sanity");
+  if (!sampleable(pin)) {
+    return;
+  }
+
+  const std::uint64_t bit = pin_bit(pin);
+  // a pin has a single active state in the mask
+  massert(!(pins_ & bit) || !(inverted_ & bit) == device->active_state(),
+          "sanity");
+
+  pins_ |= bit;
+
+  // active state is translated here, once per device
+  if (device->active_state()) {
+    inverted_ &= ~bit;
+  } else {
+    inverted_ |= bit;
+  }
+
+  // a single sample is enough if levels are not debounced
+  std::uint32_t samples = 1;
+  if (period_ > 0 && device->debounce() > 0) {
+    samples = (device->debounce() + period_ - 1) / period_;
+  }
+
+  if (samples > gpio_sampler::max_samples) {
+    LOG_WARN("Debounce of pin {} is limited to {} samples of {}us", pin,
+             gpio_sampler::max_samples, period_);
+    samples = gpio_sampler::max_samples;
+  }
+
+  for (unsigned int k = 0; k < gpio_sampler::counter_bits; ++k) {
+    if (samples & (1U << k)) {
+      thresholds_[k] |= bit;
+    } else {
+      thresholds_[k] &= ~bit;
+    }
+  }
+}
+
+GpioSnapshot GpioSampler::sample() {
+  const std::uint32_t tick = gpioTick();
+
+  std::uint64_t levels = 0;
+
+  if (pins_ & bank_low) {
+    levels |= gpioRead_Bits_0_31();
+  }
+
+  if (pins_ & ~bank_low) {
+    levels |= std::uint64_t{gpioRead_Bits_32_53()} << 32;
+  }
+
+  levels = (levels ^ inverted_) & pins_;
+
+  if (!primed_) {
+    primed_ = true;
+    stable_ = levels;
+    return {stable_, pins_, 0, 0, tick};
+  }
+
+  const std::uint64_t differ = levels ^ stable_;
+
+  // count up pins that differ, every other counter starts over
+  std::uint64_t carry = differ;
+  for (auto& counter : counters_) {
+    const std::uint64_t previous = counter;
+    counter = (previous ^ carry) & differ;
+    carry = previous & carry;
+  }
+
+  // pins whose counter reached its threshold take the new level
+  std::uint64_t changed = differ;
+  for (unsigned int k = 0; k < gpio_sampler::counter_bits; ++k) {
+    changed &= ~(counters_[k] ^ thresholds_[k]);
+  }
+
+  stable_ ^= changed;
+  for (auto& counter : counters_) {
+    counter &= ~changed;
+  }
+
+  return {stable_, pins_, changed & stable_, changed & ~stable_, tick};
+}
+
+void GpioSampler::reset() {
+  primed_ = true;
+  stable_ = 0;
+  counters_.fill(0);
+}
+
+bool GpioSampler::settled() const {
+  std::uint64_t pending = 0;
+  for (const auto& counter : counters_) {
+    pending |= counter;
+  }
+  return pending == 0;
+}
+}  // namespace device
+
+NAMESPACE_END
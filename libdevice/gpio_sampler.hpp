@@ -0,0 +1,268 @@
+#ifndef LIB_DEVICE_GPIO_SAMPLER_HPP_
+#define LIB_DEVICE_GPIO_SAMPLER_HPP_
+
+/** @file gpio_sampler.hpp
+ *  @brief GPIO sampler class definition
+ *
+ * Bank-wide read of digital inputs into a single snapshot
+ */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <libcore/core.hpp>
+
+#include "digital.hpp"
+#include "gpio.hpp"
+
+NAMESPACE_BEGIN
+
+namespace device {
+// forward declaration
+class GpioSnapshot;
+class GpioSampler;
+
+namespace gpio_sampler {
+/** Number of bits of debounce counter of every pin */
+static constexpr unsigned int counter_bits = 5;
+
+/** Maximum number of samples a level must be stable for */
+static constexpr std::uint32_t max_samples = (1U << counter_bits) - 1;
+}  // namespace gpio_sampler
+
+/**
+ * @brief Levels of digital inputs sampled at the same time
+ *
+ * Levels already follow the active state of every device, so reading a
+ * device from the snapshot is a single bit test
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class GpioSnapshot : public StackObj {
+ public:
+  /**
+   * GpioSnapshot Constructor
+   *
+   * Empty snapshot, no device is sampled
+   */
+  GpioSnapshot()
+      : levels_{0}, sampled_{0}, rising_{0}, falling_{0}, tick_{0} {}
+  /**
+   * GpioSnapshot Constructor
+   *
+   * @param levels  active levels of GPIO 0-53, bit n is GPIO n
+   * @param sampled pins that are sampled, bit n is GPIO n
+   * @param rising  pins that became high since previous snapshot
+   * @param falling pins that became low since previous snapshot
+   * @param tick    time of the sample in microseconds since boot (see
+   *                gpioTick)
+   */
+  GpioSnapshot(std::uint64_t levels,
+               std::uint64_t sampled,
+               std::uint64_t rising,
+               std::uint64_t falling,
+               std::uint32_t tick)
+      : levels_{levels & sampled},
+        sampled_{sampled},
+        rising_{rising & sampled},
+        falling_{falling & sampled},
+        tick_{tick} {}
+  /**
+   * Read the value of input device from the snapshot
+   *
+   * @param device input device
+   *
+   * @return value of device, empty if device is not sampled
+   */
+  std::optional<digital::value> read(
+      const std::shared_ptr<DigitalInputDevice>& device) const;
+  /**
+   * Read the value of input device from the snapshot
+   *
+   * Same as DigitalDevice::read_bool
+   *
+   * @param device input device
+   *
+   * @return true if device is sampled and high
+   */
+  bool read_bool(const std::shared_ptr<DigitalInputDevice>& device) const;
+  /**
+   * Get level change of input device since previous snapshot
+   *
+   * @param device input device
+   *
+   * @return edge of device, empty if level is unchanged or device is not
+   *         sampled
+   */
+  std::optional<digital::edge> edge(
+      const std::shared_ptr<DigitalInputDevice>& device) const;
+  /**
+   * Get active levels of every sampled pin
+   *
+   * @return active levels, bit n is GPIO n
+   */
+  inline std::uint64_t levels() const { return levels_; }
+  /**
+   * Get pins that became high since previous snapshot
+   *
+   * @return rising pins, bit n is GPIO n
+   */
+  inline std::uint64_t rising() const { return rising_; }
+  /**
+   * Get pins that became low since previous snapshot
+   *
+   * @return falling pins, bit n is GPIO n
+   */
+  inline std::uint64_t falling() const { return falling_; }
+  /**
+   * Get time of the sample
+   *
+   * @return microseconds since boot (see gpioTick), wraps around every 72
+   *         minutes
+   */
+  inline std::uint32_t tick() const { return tick_; }
+
+ private:
+  /**
+   * Active levels of sampled pins
+   */
+  std::uint64_t levels_;
+  /**
+   * Pins that are sampled
+   */
+  std::uint64_t sampled_;
+  /**
+   * Pins that became high
+   */
+  std::uint64_t rising_;
+  /**
+   * Pins that became low
+   */
+  std::uint64_t falling_;
+  /**
+   * Time of the sample
+   */
+  std::uint32_t tick_;
+};
+
+/**
+ * @brief GPIO sampler implementation.
+ *
+ * Collects pins of many input devices, active state of each device is
+ * folded into one inversion mask when it is added. Sampling reads the whole
+ * bank with gpioRead_Bits_0_31 (and gpioRead_Bits_32_53 only if a device is
+ * there) and applies the mask with a single XOR, so every input of the
+ * snapshot is read at the same time.
+ *
+ * Levels are debounced by an integrator: a pin reports a new level only
+ * after it has been sampled at that level for the debounce time of its
+ * device, any sample at the reported level starts the count over. Counters
+ * of all pins are sliced into bit planes, so a sample takes the same few
+ * mask operations for any number of pins.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class GpioSampler : public StackObj {
+ public:
+  /**
+   * GpioSampler Constructor
+   *
+   * @param period time between samples (microseconds), levels are not
+   *               debounced if it is 0
+   */
+  explicit GpioSampler(std::uint32_t period = 0);
+  /**
+   * GpioSampler Destructor
+   */
+  ~GpioSampler() = default;
+  /**
+   * Add input device to the sampler
+   *
+   * Inactive device is ignored, so it is never high in the snapshot
+   *
+   * Debounce time of device is rounded up to whole sample periods, at most
+   * gpio_sampler::max_samples
+   *
+   * @param device input device
+   */
+  void add(const std::shared_ptr<DigitalInputDevice>& device);
+  /**
+   * Read every added device at once and debounce the levels
+   *
+   * First sample reports raw levels
+   *
+   * @return snapshot of debounced levels of added devices
+   */
+  GpioSnapshot sample();
+  /**
+   * Forget debounced levels, every pin is low until its level is stable
+   *
+   * Unlike the first sample, a high level is only reported after its
+   * debounce time, so it suits a single check of inputs
+   */
+  void reset();
+  /**
+   * Check if every level is settled
+   *
+   * Sampling must continue every period until it is settled, otherwise a
+   * pending level is never reported
+   *
+   * @return true if no pin is waiting for its level to be stable
+   */
+  bool settled() const;
+  /**
+   * Check pin can be sampled bank-wide or not
+   *
+   * @param pin GPIO pin
+   *
+   * @return sampleable or not
+   */
+  static constexpr bool sampleable(PI_PIN pin) { return pin >= 0 && pin < 54; }
+  /**
+   * Get pins that are sampled
+   *
+   * @return sampled pins, bit n is GPIO n
+   */
+  inline std::uint64_t pins() const { return pins_; }
+
+ private:
+  /**
+   * Pins to sample
+   */
+  std::uint64_t pins_;
+  /**
+   * Pins of active low devices
+   */
+  std::uint64_t inverted_;
+  /**
+   * Time between samples (microseconds)
+   */
+  std::uint32_t period_;
+  /**
+   * Levels are sampled at least once
+   */
+  bool primed_;
+  /**
+   * Debounced levels
+   */
+  std::uint64_t stable_;
+  /**
+   * Bit planes of number of samples each pin differs from its debounced
+   * level, plane k holds bit k of every counter
+   */
+  std::array<std::uint64_t, gpio_sampler::counter_bits> counters_;
+  /**
+   * Bit planes of number of samples each pin must differ before its level
+   * is reported
+   */
+  std::array<std::uint64_t, gpio_sampler::counter_bits> thresholds_;
+};
+}  // namespace device
+
+NAMESPACE_END
+
+#endif  // LIB_DEVICE_GPIO_SAMPLER_HPP_
@@ -2,6 +2,8 @@
 
 #include "init.hpp"
 
+#include <array>
+
 #include "gpio.hpp"
 
 #include "analog.hpp"
@@ -29,9 +31,17 @@ static ATM_STATUS initialize_output_digital_devices();
 static ATM_STATUS initialize_pi_to_plc_comm();
 static ATM_STATUS initialize_shift_register_devices();
 static ATM_STATUS initialize_pwm_devices();
+static ATM_STATUS create_stepper_device(const std::string&           id,
+                                        const std::string&           speed_mode,
+                                        PI_PIN                       step_pin,
+                                        PI_PIN                       dir_pin,
+                                        PI_PIN                       enable_pin,
+                                        const stepper::step&         steps,
+                                        const std::array<PI_PIN, 3>& ms_pins);
 static ATM_STATUS initialize_stepper_devices();
 // static ATM_STATUS initialize_ultrasonic_devices();
 static ATM_STATUS initialize_float_sensor_devices();
+static void       debounce_input(const std::string& id, std::uint32_t debounce);
 
 static ATM_STATUS initialize_analog_devices() {
   // ATM_STATUS status = ATM_OK;
@@ -87,6 +97,17 @@ static ATM_STATUS initialize_plc_to_pi_comm() {
     return status;
   }
 
+  debounce_input(
+      id::comm::plc::spraying_tending_height(),
+      config->plc_to_pi<std::uint32_t>("spraying-tending-height", "debounce"));
+  debounce_input(
+      id::comm::plc::cleaning_height(),
+      config->plc_to_pi<std::uint32_t>("cleaning-height", "debounce"));
+  debounce_input(id::comm::plc::reset(),
+                 config->plc_to_pi<std::uint32_t>("reset", "debounce"));
+  debounce_input(id::comm::plc::e_stop(),
+                 config->plc_to_pi<std::uint32_t>("e-stop", "debounce"));
+
   return status;
 }
 
@@ -133,6 +154,16 @@ static ATM_STATUS initialize_limit_switches() {
     return status;
   }
 
+  debounce_input(id::limit_switch::x(),
+                 config->limit_switch_x<std::uint32_t>("debounce"));
+  debounce_input(id::limit_switch::y(),
+                 config->limit_switch_y<std::uint32_t>("debounce"));
+  debounce_input(id::limit_switch::z1(),
+                 config->limit_switch_z1<std::uint32_t>("debounce"));
+  debounce_input(
+      id::limit_switch::finger_protection(),
+      config->limit_switch_finger_protection<std::uint32_t>("debounce"));
+
   return status;
 }
 
@@ -308,9 +339,19 @@ static ATM_STATUS initialize_shift_register_devices() {
   auto*      config = Config::get();
   ATM_STATUS status = ATM_OK;
 
-  status = ShiftRegister::create(config->shift_register<PI_PIN>("latch-pin"),
-                                 config->shift_register<PI_PIN>("clock-pin"),
-                                 config->shift_register<PI_PIN>("data-pin"));
+  std::optional<shift_register::Spi> spi;
+  if (config->shift_register<std::string>("backend") == "spi") {
+    spi = shift_register::Spi{
+        config->shift_register<unsigned int>("spi-channel"),
+        config->shift_register<unsigned int>("spi-baud")};
+  }
+
+  status = ShiftRegister::create(
+      config->shift_register<PI_PIN>("latch-pin"),
+      config->shift_register<PI_PIN>("clock-pin"),
+      config->shift_register<PI_PIN>("data-pin"),
+      shift_register::bit_order::msb,
+      config->shift_register<unsigned int>("cascade-num"), spi);
   if (status == ATM_ERR) {
     return status;
   }
@@ -349,6 +390,34 @@ static ATM_STATUS initialize_pwm_devices() {
   return status;
 }
 
+static ATM_STATUS create_stepper_device(const std::string&           id,
+                                        const std::string&           speed_mode,
+                                        PI_PIN                       step_pin,
+                                        PI_PIN                       dir_pin,
+                                        PI_PIN                       enable_pin,
+                                        const stepper::step&         steps,
+                                        const std::array<PI_PIN, 3>& ms_pins) {
+  auto* stepper_registry = StepperRegistry::get();
+
+  // motor rpm is the default of A4988Device, steps are per revolution
+  if (speed_mode == "scurve") {
+    return stepper_registry->create<SCurveSpeedA4988Device>(
+        id, step_pin, dir_pin, enable_pin, 200.0, steps, ms_pins[0], ms_pins[1],
+        ms_pins[2]);
+  } else if (speed_mode == "constant") {
+    return stepper_registry->create<ConstantSpeedA4988Device>(
+        id, step_pin, dir_pin, enable_pin, 200.0, steps, ms_pins[0], ms_pins[1],
+        ms_pins[2]);
+  } else if (speed_mode != "linear") {
+    LOG_ERROR("Unknown speed mode {} of stepper {}", speed_mode, id);
+    return ATM_ERR;
+  }
+
+  return stepper_registry->create<LinearSpeedA4988Device>(
+      id, step_pin, dir_pin, enable_pin, 200.0, steps, ms_pins[0], ms_pins[1],
+      ms_pins[2]);
+}
+
 static ATM_STATUS initialize_stepper_devices() {
   auto*      config = Config::get();
   ATM_STATUS status = ATM_OK;
@@ -360,26 +429,44 @@ static ATM_STATUS initialize_stepper_devices() {
 
   auto* stepper_registry = StepperRegistry::get();
 
-  status = stepper_registry->create<LinearSpeedA4988Device>(
-      id::stepper::x(), config->stepper_x<PI_PIN>("step-pin"),
+  // step timing sleeps until wake-up latency before each pulse
+  LOG_INFO("Wake-up latency is calibrated to {} us", calibrate_wait_latency());
+
+  status = create_stepper_device(
+      id::stepper::x(), config->stepper_x<std::string>("speed-mode"),
+      config->stepper_x<PI_PIN>("step-pin"),
       config->stepper_x<PI_PIN>("dir-pin"),
-      config->stepper_x<PI_PIN>("enable-pin"));
+      config->stepper_x<PI_PIN>("enable-pin"),
+      config->stepper_x<stepper::step>("motor-steps"),
+      {config->stepper_x<PI_PIN>("ms1-pin"),
+       config->stepper_x<PI_PIN>("ms2-pin"),
+       config->stepper_x<PI_PIN>("ms3-pin")});
   if (status == ATM_ERR) {
     return status;
   }
 
-  status = stepper_registry->create<LinearSpeedA4988Device>(
-      id::stepper::y(), config->stepper_y<PI_PIN>("step-pin"),
+  status = create_stepper_device(
+      id::stepper::y(), config->stepper_y<std::string>("speed-mode"),
+      config->stepper_y<PI_PIN>("step-pin"),
       config->stepper_y<PI_PIN>("dir-pin"),
-      config->stepper_y<PI_PIN>("enable-pin"));
+      config->stepper_y<PI_PIN>("enable-pin"),
+      config->stepper_y<stepper::step>("motor-steps"),
+      {config->stepper_y<PI_PIN>("ms1-pin"),
+       config->stepper_y<PI_PIN>("ms2-pin"),
+       config->stepper_y<PI_PIN>("ms3-pin")});
   if (status == ATM_ERR) {
     return status;
   }
 
-  status = stepper_registry->create<LinearSpeedA4988Device>(
-      id::stepper::z(), config->stepper_z<PI_PIN>("step-pin"),
+  status = create_stepper_device(
+      id::stepper::z(), config->stepper_z<std::string>("speed-mode"),
+      config->stepper_z<PI_PIN>("step-pin"),
       config->stepper_z<PI_PIN>("dir-pin"),
-      config->stepper_z<PI_PIN>("enable-pin"));
+      config->stepper_z<PI_PIN>("enable-pin"),
+      config->stepper_z<stepper::step>("motor-steps"),
+      {config->stepper_z<PI_PIN>("ms1-pin"),
+       config->stepper_z<PI_PIN>("ms2-pin"),
+       config->stepper_z<PI_PIN>("ms3-pin")});
   if (status == ATM_ERR) {
     return status;
   }
@@ -483,6 +570,20 @@ static ATM_STATUS initialize_float_sensor_devices() {
   return status;
 }
 
+/**
+ * Set debounce time of input device, it is applied by device::GpioSampler
+ *
+ * @param id       unique identifier of input device
+ * @param debounce debounce time (microseconds)
+ */
+static void debounce_input(const std::string& id, std::uint32_t debounce) {
+  auto* digital_input_registry = DigitalInputDeviceRegistry::get();
+
+  if (auto&& device = digital_input_registry->get(id)) {
+    device->debounce(debounce);
+  }
+}
+
 ATM_STATUS initialize_device() {
   if (gpioInitialise() < 0) {
     return ATM_ERR;
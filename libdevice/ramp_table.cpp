@@ -0,0 +1,87 @@
+#include "device.hpp"
+
+#include "ramp_table.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+NAMESPACE_BEGIN
+
+namespace device {
+namespace ramp_table {
+std::size_t KeyHash::operator()(const Key& key) const {
+  std::size_t seed = 0;
+
+  const auto combine = [&seed](std::size_t hash) {
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  };
+
+  combine(std::hash<double>{}(key.rpm));
+  combine(std::hash<double>{}(key.acceleration));
+  combine(std::hash<double>{}(key.deceleration));
+  combine(std::hash<long>{}(key.microsteps));
+  combine(std::hash<long>{}(key.motor_steps));
+
+  return seed;
+}
+}  // namespace ramp_table
+
+RampTable::RampTable(const ramp_table::Key& key) {
+  DEBUG_ONLY_DEFINITION(obj_name_ = "RampTable");
+  massert(key.rpm > 0.0, "sanity");
+  massert(key.acceleration > 0.0, "sanity");
+  massert(key.deceleration > 0.0, "sanity");
+  massert(key.microsteps > 0, "sanity");
+  massert(key.motor_steps > 0, "sanity");
+
+  // speed is in [steps/s]
+  const double speed = key.rpm * key.motor_steps / 60;
+  cruise_pulse_ =
+      static_cast<long>(1e+6 / speed / static_cast<double>(key.microsteps));
+
+  compute(accel_pulses_, key.acceleration, key.microsteps);
+  // deceleration is the mirror of acceleration with its own rate
+  compute(decel_pulses_, key.deceleration, key.microsteps);
+
+  LOG_DEBUG("Ramp table is computed with {} accel and {} decel entries",
+            accel_pulses_.size(), decel_pulses_.size());
+}
+
+void RampTable::compute(std::vector<std::uint32_t>& pulses,
+                        double                      rate,
+                        long                        microsteps) const {
+  // Initial pulse (c0) including error correction factor 0.676 [us]
+  long pulse = static_cast<long>((1e+6) * 0.676 *
+                                 std::sqrt(2.0 / rate / microsteps));
+  long rest = 0;
+
+  pulse = std::max(pulse, cruise_pulse());
+  pulses.push_back(static_cast<std::uint32_t>(pulse));
+
+  // Atmel DOC8017 series, same as the one previously done for every step
+  for (long n = 1; pulse > cruise_pulse() &&
+                   static_cast<std::size_t>(n) < ramp_table::max_size;
+       ++n) {
+    const long denom = 4 * n + 1;
+    const long delta = (2 * pulse + rest) / denom;
+    rest = (2 * pulse + rest) % denom;
+    pulse = std::max(pulse - delta, cruise_pulse());
+    pulses.push_back(static_cast<std::uint32_t>(pulse));
+  }
+
+  pulses.shrink_to_fit();
+}
+
+std::shared_ptr<const RampTable> RampTable::get(const ramp_table::Key& key) {
+  static algo::LRUCache<ramp_table::Key, std::shared_ptr<const RampTable>,
+                        ramp_table::KeyHash>
+      cache{ramp_table::cache_size};
+
+  return cache.get_or_create(
+      key, [&key]() -> std::shared_ptr<const RampTable> {
+        return RampTable::create(key);
+      });
+}
+}  // namespace device
+
+NAMESPACE_END
@@ -0,0 +1,208 @@
+#ifndef LIB_DEVICE_RAMP_TABLE_HPP_
+#define LIB_DEVICE_RAMP_TABLE_HPP_
+
+/** @file ramp_table.hpp
+ *  @brief Stepper ramp table class definition
+ *
+ * Precomputed acceleration and deceleration step pulses for linear speed
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <libcore/core.hpp>
+
+#include <libalgo/algo.hpp>
+
+NAMESPACE_BEGIN
+
+namespace device {
+// forward declaration
+class RampTable;
+
+namespace ramp_table {
+/**
+ * @brief Ramp table key
+ *
+ * Motor parameters that fully determine the ramp table
+ */
+struct Key {
+  /**
+   * Stepper rpm
+   */
+  double rpm;
+  /**
+   * Stepper acceleration (steps / s^2)
+   */
+  double acceleration;
+  /**
+   * Stepper deceleration (steps / s^2)
+   */
+  double deceleration;
+  /**
+   * Stepper microsteps
+   */
+  long microsteps;
+  /**
+   * Motor steps
+   */
+  long motor_steps;
+
+  /**
+   * Equality operator
+   *
+   * @param other other key
+   *
+   * @return equal or not
+   */
+  bool operator==(const Key& other) const = default;
+};
+
+/**
+ * @brief Ramp table key hash
+ */
+struct KeyHash {
+  /**
+   * Hash given key
+   *
+   * @param key ramp table key
+   *
+   * @return hash of key
+   */
+  std::size_t operator()(const Key& key) const;
+};
+
+/** Maximum number of entries for each ramp */
+static constexpr std::size_t max_size = 1 << 16;
+
+/** Maximum number of ramp tables that will be cached */
+static constexpr std::size_t cache_size = 16;
+}  // namespace ramp_table
+
+/**
+ * @brief Ramp Table implementation.
+ *
+ * Step pulses of acceleration and deceleration ramps are precomputed using
+ * Atmel DOC8017 series once, so per-step work becomes a table read without
+ * division in the stepping loop.
+ *
+ * Acceleration ramp is indexed by step count from start, deceleration ramp
+ * is indexed by remaining steps to stop. Tables are shared across moves and
+ * axes through LRU cache, see RampTable::get
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class RampTable : public StackObj {
+ public:
+  /**
+   * Create shared_ptr<RampTable>
+   *
+   * Pass every args to RampTable()
+   *
+   * @param args arguments that will be passed to RampTable()
+   */
+  MAKE_STD_SHARED(RampTable)
+  /**
+   * Get cached ramp table, will be computed if it does not exist
+   *
+   * @param key motor parameters
+   *
+   * @return shared_ptr of ramp table
+   */
+  static std::shared_ptr<const RampTable> get(const ramp_table::Key& key);
+  /**
+   * Get initial step pulse (c0)
+   *
+   * @return initial step pulse
+   */
+  inline long initial_pulse() const { return accel_pulses_.front(); }
+  /**
+   * Get cruise step pulse of the configured rpm
+   *
+   * @return cruise step pulse
+   */
+  inline const long& cruise_pulse() const { return cruise_pulse_; }
+  /**
+   * Get acceleration step pulse
+   *
+   * @param step_count steps taken from start
+   *
+   * @return step pulse, or 0 if out of table
+   */
+  inline long accel(const long& step_count) const {
+    return (static_cast<std::size_t>(step_count) < accel_pulses_.size())
+               ? accel_pulses_[static_cast<std::size_t>(step_count)]
+               : 0;
+  }
+  /**
+   * Get deceleration step pulse
+   *
+   * @param remaining_steps remaining steps to stop
+   *
+   * @return step pulse, or 0 if out of table
+   */
+  inline long decel(const long& remaining_steps) const {
+    return (static_cast<std::size_t>(remaining_steps) < decel_pulses_.size())
+               ? decel_pulses_[static_cast<std::size_t>(remaining_steps)]
+               : 0;
+  }
+  /**
+   * Get acceleration ramp size
+   *
+   * @return acceleration ramp size
+   */
+  inline std::size_t accel_size() const { return accel_pulses_.size(); }
+  /**
+   * Get deceleration ramp size
+   *
+   * @return deceleration ramp size
+   */
+  inline std::size_t decel_size() const { return decel_pulses_.size(); }
+
+ private:
+  /**
+   * RampTable Constructor
+   *
+   * Compute acceleration and deceleration ramps
+   *
+   * @param key motor parameters
+   */
+  explicit RampTable(const ramp_table::Key& key);
+  /**
+   * RampTable Destructor
+   */
+  ~RampTable() = default;
+  /**
+   * Compute ramp from initial pulse until cruise pulse is reached
+   *
+   * @param pulses     container of pulses
+   * @param rate       acceleration or deceleration (steps / s^2)
+   * @param microsteps stepper microsteps
+   */
+  void compute(std::vector<std::uint32_t>& pulses,
+               double                      rate,
+               long                        microsteps) const;
+
+ private:
+  /**
+   * Cruise step pulse of the configured rpm
+   */
+  long cruise_pulse_;
+  /**
+   * Acceleration step pulses, indexed by step count
+   */
+  std::vector<std::uint32_t> accel_pulses_;
+  /**
+   * Deceleration step pulses, indexed by remaining steps
+   */
+  std::vector<std::uint32_t> decel_pulses_;
+};
+}  // namespace device
+
+NAMESPACE_END
+
+#endif  // LIB_DEVICE_RAMP_TABLE_HPP_
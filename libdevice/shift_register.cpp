@@ -7,69 +7,179 @@
 NAMESPACE_BEGIN
 
 namespace device {
+/**
+ * Open hardware SPI bus of shift register
+ *
+ * Main SPI in mode 0, bits are shifted in at the rising edge of the clock
+ *
+ * @param spi hardware SPI bus
+ *
+ * @return SPI handle, negative if bus is empty or cannot be opened
+ */
+static PI_RES open_spi(const std::optional<shift_register::Spi>& spi) {
+  if (!spi) {
+    return PI_BAD_HANDLE;
+  }
+
+  const PI_RES handle = spiOpen(spi->channel, spi->baud, 0);
+  if (handle < 0) {
+    LOG_WARN("Cannot open SPI channel {} of shift register ({}), bit-bang "
+             "clock and data pins instead",
+             spi->channel, handle);
+  }
+
+  return handle;
+}
+
+/**
+ * Reverse bits of byte, SPI always shifts out the most significant bit first
+ *
+ * @param value byte to reverse
+ *
+ * @return reversed byte
+ */
+static byte reverse_bits(byte value) {
+  byte result = 0;
+  for (unsigned int i = 0; i < 8; ++i) {
+    result = static_cast<byte>((result << 1) | ((value >> i) & 1));
+  }
+  return result;
+}
+
+namespace shift_register {
+ATM_STATUS Transaction::write(const std::string&    id,
+                              const digital::value& level) {
+  massert(shift_register_ != nullptr, "sanity");
+
+  if (auto current_change = shift_register_->resolve(id, level)) {
+    changes_.push_back(*current_change);
+    return ATM_OK;
+  }
+
+  status_ = ATM_ERR;
+  return ATM_ERR;
+}
+
+ATM_STATUS Transaction::commit() {
+  const auto status = std::exchange(status_, ATM_OK);
+
+  if (shift_register_ == nullptr || changes_.empty()) {
+    return status;
+  }
+
+  const auto changes = std::exchange(changes_, {});
+
+  if (shift_register_->ShiftRegisterDeviceImpl::write(changes) == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  return status;
+}
+}  // namespace shift_register
 
 namespace impl {
-const unsigned int ShiftRegisterDeviceImpl::cascade_num = 2;
 const unsigned int ShiftRegisterDeviceImpl::shift_bits = 8;
 
 ShiftRegisterDeviceImpl::ShiftRegisterDeviceImpl(
-    PI_PIN                    latch_pin,
-    PI_PIN                    clock_pin,
-    PI_PIN                    data_pin,
-    shift_register::bit_order order)
+    PI_PIN                                    latch_pin,
+    PI_PIN                                    clock_pin,
+    PI_PIN                                    data_pin,
+    shift_register::bit_order                 order,
+    unsigned int                              cascade_num,
+    const std::optional<shift_register::Spi>& spi)
     : latch_pin_{latch_pin},
       clock_pin_{clock_pin},
       data_pin_{data_pin},
       order_{order},
+      cascade_num_{cascade_num},
+      spi_handle_{open_spi(spi)},
       latch_device_{DigitalOutputDevice::create(latch_pin)},
-      clock_device_{DigitalOutputDevice::create(clock_pin)},
-      data_device_{DigitalOutputDevice::create(data_pin)} {
+      // SCLK and MOSI must stay in SPI mode
+      clock_device_{spi_handle_ < 0 ? DigitalOutputDevice::create(clock_pin)
+                                    : nullptr},
+      data_device_{spi_handle_ < 0 ? DigitalOutputDevice::create(data_pin)
+                                   : nullptr},
+      spi_buffer_(cascade_num, 0) {
   DEBUG_ONLY_DEFINITION(obj_name_ = "ShiftRegisterDevice");
+  massert(cascade_num_ > 0, "sanity");
   massert(active(), "sanity");
 
-  bits_ = new byte[cascade_num];
+  bits_ = new byte[cascade_num_];
   reset_bits();
 }
 
 ShiftRegisterDeviceImpl::~ShiftRegisterDeviceImpl() {
-  delete bits_;
+  if (spi_handle_ >= 0) {
+    spiClose(static_cast<unsigned>(spi_handle_));
+  }
+
+  delete[] bits_;
 }
 
 void ShiftRegisterDeviceImpl::reset_bits() {
-  for (unsigned int idx = 0; idx < cascade_num; ++idx) {
+  for (unsigned int idx = 0; idx < cascade_num_; ++idx) {
     bits_[idx] = 0;
   }
 }
 
 ATM_STATUS ShiftRegisterDeviceImpl::write(const byte&           pin,
                                           const digital::value& level) {
-  if (pin > cascade_num * shift_bits) {
-    return ATM_ERR;
+  return write(shift_register::change_container{{pin, level}});
+}
+
+ATM_STATUS ShiftRegisterDeviceImpl::write(
+    const shift_register::change_container& changes) {
+  for (const auto& [pin, level] : changes) {
+    if (pin >= cascade_num_ * shift_bits) {
+      return ATM_ERR;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (const auto& [pin, level] : changes) {
+    unsigned int reg = pin / shift_bits;
+
+    // Determines address for actual register
+    byte address = static_cast<byte>(pin - (shift_bits * reg));
+
+    // turn on the next highest bit in bits
+    bit_write(bits(reg), address, level);
   }
 
-  unsigned int reg = pin / shift_bits;
+  latch();
 
-  // Determines address for actual register
-  byte address = static_cast<byte>(pin - (shift_bits * reg));
+  return ATM_OK;
+}
 
+void ShiftRegisterDeviceImpl::latch() {
   // turn off the output so the pins don't
   // light up while the bits are being shifted in
   latch_device()->write(digital::value::low);
 
-  for (unsigned int idx = 0; idx < cascade_num; ++idx) {
-    if (reg == idx) {
-      // turn on the next highest bit in bits
-      bit_write(bits(idx), address, level);
+  if (backend() == shift_register::backend::spi) {
+    spi_out();
+  } else {
+    for (unsigned int idx = 0; idx < cascade_num_; ++idx) {
+      // shift the bits out
+      shift_out(bits(idx));
     }
-
-    // shift the bits out
-    shift_out(bits(idx));
   }
 
   // turn on the output
   latch_device()->write(digital::value::high);
+}
 
-  return ATM_OK;
+void ShiftRegisterDeviceImpl::spi_out() {
+  // same order of registers as bit-bang
+  for (unsigned int idx = 0; idx < cascade_num_; ++idx) {
+    spi_buffer_[idx] = static_cast<char>(
+        order() == shift_register::bit_order::lsb ? reverse_bits(bits(idx))
+                                                  : bits(idx));
+  }
+
+  spiWrite(static_cast<unsigned>(spi_handle_), spi_buffer_.data(),
+           cascade_num_);
 }
 
 void ShiftRegisterDeviceImpl::shift_out(const byte& value) const {
@@ -98,15 +208,23 @@ void ShiftRegisterDeviceImpl::bit_write(byte&                 value,
 }
 
 bool ShiftRegisterDeviceImpl::active() const {
+  if (backend() == shift_register::backend::spi) {
+    return latch_device()->active();
+  }
+
   return latch_device()->active() && clock_device()->active() &&
          data_device()->active();
 }
 
-ShiftRegisterImpl::ShiftRegisterImpl(PI_PIN                    latch_pin,
-                                     PI_PIN                    clock_pin,
-                                     PI_PIN                    data_pin,
-                                     shift_register::bit_order order)
-    : ShiftRegisterDeviceImpl{latch_pin, clock_pin, data_pin, order} {
+ShiftRegisterImpl::ShiftRegisterImpl(
+    PI_PIN                                    latch_pin,
+    PI_PIN                                    clock_pin,
+    PI_PIN                                    data_pin,
+    shift_register::bit_order                 order,
+    unsigned int                              cascade_num,
+    const std::optional<shift_register::Spi>& spi)
+    : ShiftRegisterDeviceImpl{latch_pin, clock_pin,   data_pin,
+                              order,     cascade_num, spi} {
   massert(active(), "sanity");
 }
 
@@ -130,28 +248,46 @@ ATM_STATUS ShiftRegisterImpl::assign(const std::string& id,
 
 ATM_STATUS ShiftRegisterImpl::write(const std::string&    id,
                                     const digital::value& level) {
+  if (auto current_change = resolve(id, level)) {
+    const auto& [address, address_level] = *current_change;
+    return ShiftRegisterDeviceImpl::write(address, address_level);
+  }
+
+  return ATM_ERR;
+}
+
+ATM_STATUS ShiftRegisterImpl::write_all(const digital::value& level) {
+  auto current_transaction = transaction();
+
+  for (const auto& [id, _] : container_) {
+    current_transaction.write(id, level);
+  }
+
+  return current_transaction.commit();
+}
+
+shift_register::Transaction ShiftRegisterImpl::transaction() {
+  return shift_register::Transaction{this};
+}
+
+std::optional<shift_register::change> ShiftRegisterImpl::resolve(
+    const std::string&    id,
+    const digital::value& level) const {
   if (auto current_metadata = get(id)) {
     const auto& [address, active_state] = *current_metadata;
     DEBUG_ONLY(LOG_DEBUG(
         "Write ShiftRegister with address {} active_state {} level {}", address,
         active_state, level));
     if (active_state) {
-      return ShiftRegisterDeviceImpl::write(address, level);
+      return shift_register::change{address, level};
     }
     // invert output
-    return ShiftRegisterDeviceImpl::write(address, level == digital::value::high
-                                                       ? digital::value::low
-                                                       : digital::value::high);
+    return shift_register::change{address, level == digital::value::high
+                                                ? digital::value::low
+                                                : digital::value::high};
   }
 
-  return ATM_ERR;
-}
-
-void ShiftRegisterImpl::write_all(const digital::value& level) {
-  for (const auto& [id, _] : container_) {
-    write(id, level);
-    sleep_for<time_units::millis>(50);
-  }
+  return {};
 }
 
 std::optional<ShiftRegisterImpl::metadata> ShiftRegisterImpl::get(
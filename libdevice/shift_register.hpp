@@ -10,9 +10,12 @@
 #include <libalgo/algo.hpp>
 #include <libcore/core.hpp>
 
+#include <mutex>
 #include <optional>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "gpio.hpp"
 
@@ -35,7 +38,109 @@ enum class bit_order {
   lsb /**< least significant bit */,
   msb /**< most significant bit */
 };
-}
+
+enum class backend {
+  gpio /**< bit-bang clock and data GPIO pins */,
+  spi /**< hardware SPI, clock and data are SCLK and MOSI */
+};
+
+/**
+ * @brief Hardware SPI bus of shift register
+ */
+struct Spi {
+  /**
+   * SPI channel, chip enable of main SPI
+   */
+  unsigned int channel;
+  /**
+   * Clock frequency (Hz)
+   */
+  unsigned int baud;
+};
+
+/**
+ * @var using change = std::pair<byte, digital::value>
+ * @brief Type definition for level of a shift register pin/bit
+ */
+using change = std::pair<byte, digital::value>;
+
+/**
+ * @var using change_container = std::vector<change>
+ * @brief Type definition for levels that are latched together
+ */
+using change_container = std::vector<change>;
+
+/**
+ * @brief Batch of writes to shift register
+ *
+ * Collects writes of connected devices and latches all of them with a single
+ * shift out, so the outputs change at the same time. Pending writes are
+ * committed when it is destroyed.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Transaction : public StackObj {
+ public:
+  /**
+   * Transaction Constructor
+   *
+   * @param shift_register shift register to write to
+   */
+  explicit Transaction(impl::ShiftRegisterImpl* shift_register)
+      : shift_register_{shift_register}, status_{ATM_OK} {}
+  /**
+   * Transaction Move Constructor
+   *
+   * @param other transaction to move from, has nothing to commit anymore
+   */
+  Transaction(Transaction&& other) noexcept
+      : shift_register_{std::exchange(other.shift_register_, nullptr)},
+        changes_{std::move(other.changes_)},
+        status_{std::exchange(other.status_, ATM_OK)} {}
+  /**
+   * Transaction Destructor
+   *
+   * Commit pending writes
+   */
+  ~Transaction() { commit(); }
+  /**
+   * Write the HIGH/LOW data of connected device, it is latched on commit
+   *
+   * @param  id    device unique id
+   * @param  level HIGH/LOW
+   *
+   * @return ATM_OK or ATM_ERR if device is not connected
+   */
+  ATM_STATUS write(const std::string& id, const digital::value& level);
+  /**
+   * Latch pending writes with a single shift out
+   *
+   * @return ATM_OK or ATM_ERR if any write of the transaction fails
+   */
+  ATM_STATUS commit();
+  /**
+   * Check if there are pending writes
+   *
+   * @return true if there are writes that are not committed
+   */
+  inline bool pending() const { return !changes_.empty(); }
+
+ private:
+  /**
+   * Shift register to write to
+   */
+  impl::ShiftRegisterImpl* shift_register_;
+  /**
+   * Pending writes
+   */
+  change_container changes_;
+  /**
+   * Status of writes since last commit
+   */
+  ATM_STATUS status_;
+};
+}  // namespace shift_register
 
 /** impl::ShiftRegisterImpl singleton class using StaticObj */
 using ShiftRegister = StaticObj<impl::ShiftRegisterImpl>;
@@ -64,6 +169,18 @@ class ShiftRegisterDeviceImpl : public StackObj {
    * @return ATM_OK or ATM_ERR, but not both
    */
   ATM_STATUS write(const byte& pin, const digital::value& level);
+  /**
+   * Write the HIGH/LOW data of multiple pins/bits to ShiftRegisterDeviceImpl
+   *
+   * Every level is latched with a single shift out, later levels of the same
+   * pin/bit override the earlier ones
+   *
+   * @param  changes levels of shift register pins/bits
+   *
+   * @return ATM_OK or ATM_ERR if any pin/bit is out of range, then nothing is
+   *         written
+   */
+  ATM_STATUS write(const shift_register::change_container& changes);
 
  protected:
   /**
@@ -71,16 +188,22 @@ class ShiftRegisterDeviceImpl : public StackObj {
    *
    * Initialize the shift register device by opening GPIO pins
    *
-   * @param  latch_pin  gpio pin, see Raspberry GPIO pinout for details
-   * @param  clock_pin  gpio pin, see Raspberry GPIO pinout for details
-   * @param  data_pin   gpio pin, see Raspberry GPIO pinout for details
-   * @param  order      order of bit, default MSB (Most Significant Bit)
+   * Registers are written over hardware SPI if the bus is given and can be
+   * opened, otherwise clock and data GPIO pins are bit-banged
+   *
+   * @param  latch_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  clock_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  data_pin    gpio pin, see Raspberry GPIO pinout for details
+   * @param  order       order of bit
+   * @param  cascade_num number of cascaded registers
+   * @param  spi         hardware SPI bus, bit-bang if it is empty
    */
-  ShiftRegisterDeviceImpl(
-      PI_PIN                    latch_pin,
-      PI_PIN                    clock_pin,
-      PI_PIN                    data_pin,
-      shift_register::bit_order order = shift_register::bit_order::msb);
+  ShiftRegisterDeviceImpl(PI_PIN                                    latch_pin,
+                          PI_PIN                                    clock_pin,
+                          PI_PIN                                    data_pin,
+                          shift_register::bit_order                 order,
+                          unsigned int                              cascade_num,
+                          const std::optional<shift_register::Spi>& spi);
   /**
    * ShiftRegisterDeviceImpl Destructor
    *
@@ -135,12 +258,37 @@ class ShiftRegisterDeviceImpl : public StackObj {
    * @return bit order
    */
   inline const shift_register::bit_order& order() const { return order_; }
+  /**
+   * Get number of cascaded registers
+   *
+   * @return number of cascaded registers
+   */
+  inline const unsigned int& cascade_num() const { return cascade_num_; }
+  /**
+   * Get backend that writes the registers
+   *
+   * @return backend of registers
+   */
+  inline shift_register::backend backend() const {
+    return spi_handle_ >= 0 ? shift_register::backend::spi
+                            : shift_register::backend::gpio;
+  }
   /**
    * Shift out register
    *
    * @param value      value to set
    */
   void shift_out(const byte& value) const;
+  /**
+   * Shift out bits of every register and latch them to the outputs
+   *
+   * Must be called while holding the lock
+   */
+  void latch();
+  /**
+   * Shift out bits of every register with a single SPI write
+   */
+  void spi_out();
 
   /**
    * Bit Write
@@ -167,7 +315,7 @@ class ShiftRegisterDeviceImpl : public StackObj {
    * @return bits with specified index
    */
   inline const byte& bits(unsigned int idx) const {
-    massert(idx < cascade_num, "sanity");
+    massert(idx < cascade_num_, "sanity");
     return bits_[idx];
   }
   /**
@@ -178,7 +326,7 @@ class ShiftRegisterDeviceImpl : public StackObj {
    * @return bits with specified index
    */
   inline byte& bits(unsigned int idx) {
-    massert(idx < cascade_num, "sanity");
+    massert(idx < cascade_num_, "sanity");
     return bits_[idx];
   }
   /**
@@ -187,10 +335,6 @@ class ShiftRegisterDeviceImpl : public StackObj {
   void reset_bits();
 
  protected:
-  /**
-   * Shift register cascade number
-   */
-  static const unsigned int cascade_num;
   /**
    * Shift register bits
    */
@@ -211,22 +355,38 @@ class ShiftRegisterDeviceImpl : public StackObj {
    * Bit order
    */
   const shift_register::bit_order order_;
+  /**
+   * Shift register cascade number
+   */
+  const unsigned int cascade_num_;
+  /**
+   * SPI handle, negative if registers are bit-banged
+   */
+  const PI_RES spi_handle_;
   /**
    * Latch digital output device
    */
   const std::shared_ptr<DigitalOutputDevice> latch_device_;
   /**
-   * Clock digital output device
+   * Clock digital output device, empty if registers are written over SPI
    */
   const std::shared_ptr<DigitalOutputDevice> clock_device_;
   /**
-   * Data digital output device
+   * Data digital output device, empty if registers are written over SPI
    */
   const std::shared_ptr<DigitalOutputDevice> data_device_;
   /**
    * Last bits of registers
    */
   byte* bits_;
+  /**
+   * Bytes of SPI write
+   */
+  std::vector<char> spi_buffer_;
+  /**
+   * Mutex of bits, one shift out and latch at a time
+   */
+  std::mutex mutex_;
 };
 
 /**
@@ -282,11 +442,32 @@ class ShiftRegisterImpl : public ShiftRegisterDeviceImpl {
   /**
    * Write the HIGH/LOW data to all devices that connected to Shift Register
    *
+   * Every device is latched at the same time
+   *
    * @param  level HIGH/LOW
    *
    * @return ATM_OK or ATM_ERR, but not both
    */
-  void write_all(const digital::value& level);
+  ATM_STATUS write_all(const digital::value& level);
+  /**
+   * Start batch of writes that is latched with a single shift out
+   *
+   * @return transaction of this shift register
+   */
+  shift_register::Transaction transaction();
+  /**
+   * Get level of shift register pin/bit of device with unique id
+   *
+   * Level is inverted if device is active low
+   *
+   * @param  id    device unique id
+   * @param  level HIGH/LOW
+   *
+   * @return level of pin/bit or fail if device is not connected
+   */
+  std::optional<shift_register::change> resolve(
+      const std::string&    id,
+      const digital::value& level) const;
   /**
    * Check device with unique id
    *
@@ -310,16 +491,19 @@ class ShiftRegisterImpl : public ShiftRegisterDeviceImpl {
    *
    * Initialize the shift register device by opening GPIO pins
    *
-   * @param  latch_pin  gpio pin, see Raspberry GPIO pinout for details
-   * @param  clock_pin  gpio pin, see Raspberry GPIO pinout for details
-   * @param  data_pin   gpio pin, see Raspberry GPIO pinout for details
-   * @param  order      order of bit, default MSB (Most Significant Bit)
-   */
-  ShiftRegisterImpl(
-      PI_PIN                    latch_pin,
-      PI_PIN                    clock_pin,
-      PI_PIN                    data_pin,
-      shift_register::bit_order order = shift_register::bit_order::msb);
+   * @param  latch_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  clock_pin   gpio pin, see Raspberry GPIO pinout for details
+   * @param  data_pin    gpio pin, see Raspberry GPIO pinout for details
+   * @param  order       order of bit
+   * @param  cascade_num number of cascaded registers
+   * @param  spi         hardware SPI bus, bit-bang if it is empty
+   */
+  ShiftRegisterImpl(PI_PIN                                    latch_pin,
+                    PI_PIN                                    clock_pin,
+                    PI_PIN                                    data_pin,
+                    shift_register::bit_order                 order,
+                    unsigned int                              cascade_num,
+                    const std::optional<shift_register::Spi>& spi);
   /**
    * ShiftRegisterImpl Destructor
    *
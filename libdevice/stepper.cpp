@@ -2,11 +2,211 @@
 
 #include "stepper.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 NAMESPACE_BEGIN
 
 namespace device {
+namespace stepper {
+Kinematics::Kinematics() {
+  cruise_rate = 0;
+  start_rate = 0;
+  cruise_pulse = 0;
+  acceleration = 0;
+  deceleration = 0;
+  jerk = 0;
+  accel_inverse = 0;
+  decel_inverse = 0;
+  brake_ratio = 0;
+  steps_to_cruise = 0;
+  steps_to_brake = 0;
+  ramp_time = 0;
+  jerk_time = 0;
+}
+
+Kinematics::Kinematics(double rpm,
+                       double acceleration,
+                       double deceleration,
+                       double jerk,
+                       step   microsteps,
+                       step   motor_steps) {
+  massert(rpm > 0.0, "sanity");
+  massert(acceleration > 0.0, "sanity");
+  massert(deceleration > 0.0, "sanity");
+  massert(microsteps > 0, "sanity");
+  massert(motor_steps > 0, "sanity");
+
+  // Only place with floating point math, every move and step after this
+  // uses the precomputed integers
+  const double ms = static_cast<double>(microsteps);
+  // speed is in [full steps/s], rate is in [steps/s]
+  const double speed = rpm * static_cast<double>(motor_steps) / 60;
+  const double rate = speed * ms;
+  const double accel = acceleration * ms;
+  const double decel = deceleration * ms;
+
+  cruise_rate = util::fixed::from_double(rate);
+  // Initial pulse (c0) including error correction factor 0.676, see RampTable
+  start_rate = util::fixed::from_double(
+      std::min(1.0 / (0.676 * std::sqrt(2.0 / accel)), rate));
+  cruise_pulse = static_cast<pulse>(std::lround(1e+6 / rate));
+  this->acceleration = std::llround(accel);
+  this->deceleration = std::llround(decel);
+  this->jerk = (jerk > 0.0) ? std::llround(jerk * ms) : 0;
+  accel_inverse = std::llround(1e+12 / accel);
+  decel_inverse = std::llround(1e+12 / decel);
+  brake_ratio =
+      util::fixed::from_double(deceleration / (acceleration + deceleration));
+  // how many microsteps from 0 to target speed
+  steps_to_cruise =
+      static_cast<step>(ms * (speed * speed / (2 * acceleration)));
+  // how many microsteps are needed from cruise speed to a full stop
+  steps_to_brake = static_cast<step>(static_cast<double>(steps_to_cruise) *
+                                     acceleration / deceleration);
+  ramp_time = std::llround(
+      (speed / (2 * acceleration) + speed / (2 * deceleration)) * 1e+6);
+  jerk_time = (jerk > 0.0) ? std::llround((acceleration + deceleration) /
+                                          (2 * jerk) * 1e+6)
+                           : 0;
+}
+
+SCurve::SCurve() {
+  start_rate = 0;
+  delta_rate = 0;
+  jerk = 0;
+  peak_acceleration = 0;
+  jerk_time = 0;
+  constant_time = 0;
+}
+
+Profile::Profile() {
+  steps = 0;
+  steps_to_cruise = 0;
+  steps_to_brake = 0;
+  start_rate = 0;
+  cruise_rate = 0;
+  cruise_pulse = 0;
+  accelerate = 0;
+  cruise = 0;
+  decelerate = 0;
+}
+
+void SCurve::compute(util::fixed::q16 start,
+                     util::fixed::q16 target,
+                     std::int64_t     acceleration,
+                     std::int64_t     jerk) {
+  massert(acceleration > 0, "sanity");
+
+  start_rate = start;
+  delta_rate = std::max<util::fixed::q16>(target - start, 0);
+  this->jerk = jerk;
+  peak_acceleration = acceleration;
+  jerk_time = 0;
+  constant_time = 0;
+
+  if (delta_rate <= 0) {
+    return;
+  }
+
+  if (jerk <= 0) {
+    // unlimited jerk, plain linear ramp
+    constant_time = delta_rate / acceleration;
+  } else if (delta_rate * jerk >=
+             (acceleration * acceleration) << util::fixed::frac_bits) {
+    // maximum acceleration is reached
+    jerk_time = (acceleration << util::fixed::frac_bits) / jerk;
+    constant_time = delta_rate / acceleration - jerk_time;
+  } else {
+    // maximum acceleration is not reached, no constant acceleration phase
+    peak_acceleration = std::max<std::int64_t>(
+        static_cast<std::int64_t>(util::fixed::isqrt(
+            static_cast<std::uint64_t>(delta_rate * jerk) >>
+            util::fixed::frac_bits)),
+        1);
+    jerk_time = (peak_acceleration << util::fixed::frac_bits) / jerk;
+  }
+}
+
+util::fixed::q16 SCurve::rate(util::fixed::q16 t) const {
+  // jerk * t^2 is Q32, halving it and going back to Q16 is one more shift
+  constexpr int half_q32 = util::fixed::frac_bits + 1;
+
+  if (t <= 0) {
+    return start_rate;
+  } else if (t < jerk_time) {
+    return start_rate + ((jerk * t * t) >> half_q32);
+  } else if (t < jerk_time + constant_time) {
+    return start_rate + peak_acceleration * (jerk_time / 2 + (t - jerk_time));
+  } else if (t < duration()) {
+    const util::fixed::q16 rest = duration() - t;
+    return start_rate + delta_rate - ((jerk * rest * rest) >> half_q32);
+  }
+
+  return start_rate + delta_rate;
+}
+}  // namespace stepper
+
+/**
+ * Convert rate to pulse
+ *
+ * @param rate rate (Q16.16 steps / s)
+ *
+ * @return pulse (us)
+ */
+static inline stepper::pulse rate_to_pulse(util::fixed::q16 rate) {
+  return static_cast<stepper::pulse>((std::int64_t{1000000}
+                                      << util::fixed::frac_bits) /
+                                     rate);
+}
+
+/**
+ * Convert microseconds to Q16.16 seconds
+ *
+ * @param time time (us)
+ *
+ * @return time (Q16.16 s)
+ */
+static inline util::fixed::q16 micros_to_seconds(time_unit time) {
+  return static_cast<util::fixed::q16>(
+      (static_cast<std::int64_t>(time) << util::fixed::frac_bits) / 1000000);
+}
+
+/**
+ * Highest rate to finish the move in the requested time with linear ramps
+ *
+ * Solves t = d / v + v / 2A + v / 2D for v
+ *
+ * @param kinematics precomputed kinematics
+ * @param steps      steps to take
+ * @param time       finish time (us)
+ *
+ * @return rate (Q16.16 steps / s), never higher than cruise rate
+ */
+static util::fixed::q16 time_limited_rate(
+    const stepper::Kinematics& kinematics,
+    const stepper::step&       steps,
+    std::int64_t               time) {
+  // 1 / A + 1 / D [us^2 / step]
+  const std::int64_t a2 = kinematics.accel_inverse + kinematics.decel_inverse;
+  const std::int64_t sqrt_candidate = time * time - 2 * a2 * steps;
+
+  if (time <= 0 || a2 <= 0 || sqrt_candidate < 0) {
+    return kinematics.cruise_rate;
+  }
+
+  const std::int64_t num =
+      (time - static_cast<std::int64_t>(util::fixed::isqrt(
+                  static_cast<std::uint64_t>(sqrt_candidate)))) *
+      1000000;
+  const util::fixed::q16 rate =
+      ((num / a2) << util::fixed::frac_bits) +
+      (((num % a2) << util::fixed::frac_bits) / a2);
+
+  return std::min(rate, kinematics.cruise_rate);
+}
+
 const time_unit StepperDevice::step_high_min = 20;
 
 StepperDevice::StepperDevice(PI_PIN        step_pin,
@@ -30,31 +230,70 @@ StepperDevice::StepperDevice(PI_PIN        step_pin,
   /* Movement mechanism variables initialization */
   last_move_end_ = 0;
   next_move_interval_ = 0;
+  microsteps_ = 1;
   acceleration_ = 1000;
   deceleration_ = 1000;
+  jerk_ = 0;
   direction_ = stepper::direction::forward;
   remaining_steps_ = 0;
+  step_count_ = 0;
+  last_step_ = 0;
+  last_pulse_ = 0;
+  kinematics_dirty_ = true;
   /*  End of movement mechanism variables initialization */
 }
 
+void StepperDevice::record_timing(time_unit scheduled,
+                                  time_unit actual,
+                                  time_unit overrun) {
+  interval_error_.record((actual > scheduled) ? actual - scheduled
+                                              : scheduled - actual);
+  overrun_.record(overrun);
+}
+
+void StepperDevice::reset_timing() {
+  interval_error_.reset();
+  overrun_.reset();
+}
+
 void StepperDevice::microsteps(const stepper::step& microsteps) {
   microsteps_ = microsteps;
+  kinematics_dirty_ = true;
+}
+
+bool StepperDevice::step_resolution(const stepper::step& resolution) {
+  return resolution == microsteps();
 }
 
 void StepperDevice::motor_steps(const stepper::step& motor_steps) {
   motor_steps_ = motor_steps;
+  kinematics_dirty_ = true;
 }
 
 void StepperDevice::rpm(double rpm) {
   rpm_ = rpm;
+  kinematics_dirty_ = true;
 }
 
 void StepperDevice::acceleration(double acceleration) {
   acceleration_ = acceleration;
+  kinematics_dirty_ = true;
 }
 
 void StepperDevice::deceleration(double deceleration) {
   deceleration_ = deceleration;
+  kinematics_dirty_ = true;
+}
+
+void StepperDevice::jerk(double jerk) {
+  jerk_ = jerk;
+  kinematics_dirty_ = true;
+}
+
+void StepperDevice::update_kinematics() {
+  kinematics_ = stepper::Kinematics(rpm(), acceleration(), deceleration(),
+                                    jerk(), microsteps(), motor_steps());
+  kinematics_dirty_ = false;
 }
 
 void StepperDevice::enable() {
@@ -65,6 +304,42 @@ void StepperDevice::disable() {
   enable_device()->write(digital::value::low);
 }
 
+void StepperDevice::yield_step() {
+  if (remaining_steps() <= 0) {
+    return;
+  }
+
+  remaining_steps_--;
+  step_count_++;
+}
+
+void StepperDevice::write_direction() const {
+  // DIR pin is sampled on rising STEP edge, so it must be set first
+  switch (direction()) {
+    case stepper::direction::forward:
+      dir_device()->write(digital::value::high);
+      break;
+    case stepper::direction::backward:
+      dir_device()->write(digital::value::low);
+      break;
+  }
+}
+
+void StepperDevice::write_direction(GpioBank& bank) const {
+  bank.add(dir_device(), (direction() == stepper::direction::forward)
+                             ? digital::value::high
+                             : digital::value::low);
+}
+
+void StepperDevice::write_step(const digital::value& level) const {
+  step_device()->write(level);
+}
+
+void StepperDevice::write_step(GpioBank&             bank,
+                               const digital::value& level) const {
+  bank.add(step_device(), level);
+}
+
 void StepperDevice::step_active_state(const bool& active_state) {
   step_device()->active_state(active_state);
 }
@@ -77,6 +352,196 @@ void StepperDevice::dir_active_state(const bool& active_state) {
   dir_device()->active_state(active_state);
 }
 
+namespace stepper {
+/**
+ * Convert Q16.16 seconds to microseconds
+ *
+ * @param time time (Q16.16 s)
+ *
+ * @return time (us)
+ */
+static inline time_unit seconds_to_micros(util::fixed::q16 time) {
+  return static_cast<time_unit>((time * 1000000) >> util::fixed::frac_bits);
+}
+
+/**
+ * Plan constant speed move
+ *
+ * @param kinematics precomputed kinematics
+ * @param profile    profile with steps to fill
+ * @param time       finish time (us)
+ */
+static void plan_constant(const Kinematics& kinematics,
+                          Profile&          profile,
+                          time_unit         time) {
+  profile.cruise_pulse = kinematics.cruise_pulse;
+  if (time > static_cast<time_unit>(profile.steps * profile.cruise_pulse)) {
+    profile.cruise_pulse = static_cast<pulse>(time) / profile.steps;
+  }
+  profile.start_rate = profile.cruise_rate = kinematics.cruise_rate;
+  profile.cruise =
+      static_cast<time_unit>(profile.steps * profile.cruise_pulse);
+}
+
+/**
+ * Plan linear speed move
+ *
+ * @param kinematics precomputed kinematics
+ * @param profile    profile with steps to fill
+ * @param time       finish time (us)
+ */
+static void plan_linear(const Kinematics& kinematics,
+                        Profile&          profile,
+                        time_unit         time) {
+  const auto& k = kinematics;
+
+  profile.steps_to_cruise = k.steps_to_cruise;
+  profile.steps_to_brake = k.steps_to_brake;
+  profile.start_rate = k.start_rate;
+  profile.cruise_rate = k.cruise_rate;
+  profile.cruise_pulse = k.cruise_pulse;
+
+  if (time > 0) {
+    // Calculate a new speed to finish in the time requested
+    const util::fixed::q16 rate =
+        time_limited_rate(k, profile.steps, static_cast<std::int64_t>(time));
+
+    if (rate < k.cruise_rate) {
+      // rate^2 / 2A, rate^2 is Q32
+      profile.steps_to_cruise = static_cast<step>(
+          (rate * rate / (2 * k.acceleration)) >> (2 * util::fixed::frac_bits));
+      profile.steps_to_brake =
+          profile.steps_to_cruise * k.acceleration / k.deceleration;
+      profile.cruise_rate = rate;
+      profile.cruise_pulse = rate_to_pulse(rate);
+    }
+  }
+
+  if (profile.steps < profile.steps_to_cruise + profile.steps_to_brake) {
+    // cannot reach max speed, will need to brake early
+    profile.steps_to_cruise = static_cast<step>(
+        (profile.steps * k.brake_ratio) >> util::fixed::frac_bits);
+    profile.steps_to_brake = profile.steps - profile.steps_to_cruise;
+
+    // sqrt(2d / A) + sqrt(2d / D)
+    profile.accelerate = static_cast<time_unit>(
+        util::fixed::isqrt(static_cast<std::uint64_t>(
+            2 * profile.steps_to_cruise * k.accel_inverse)));
+    profile.decelerate = static_cast<time_unit>(
+        util::fixed::isqrt(static_cast<std::uint64_t>(
+            2 * profile.steps_to_brake * k.decel_inverse)));
+    return;
+  }
+
+  // v / A + (d - v^2 / 2A - v^2 / 2D) / v + v / D
+  profile.accelerate = seconds_to_micros(profile.cruise_rate / k.acceleration);
+  profile.decelerate = seconds_to_micros(profile.cruise_rate / k.deceleration);
+  profile.cruise = static_cast<time_unit>(
+      ((static_cast<std::int64_t>(profile.steps - profile.steps_to_cruise -
+                                  profile.steps_to_brake) *
+        1000000)
+       << util::fixed::frac_bits) /
+      profile.cruise_rate);
+}
+
+/**
+ * Plan s-curve speed move
+ *
+ * @param kinematics precomputed kinematics
+ * @param profile    profile with steps to fill
+ * @param time       finish time (us)
+ */
+static void plan_scurve(const Kinematics& kinematics,
+                        Profile&          profile,
+                        time_unit         time) {
+  const auto&      k = kinematics;
+  util::fixed::q16 rate = k.cruise_rate;
+
+  if (time > 0) {
+    // Each jerk phase adds (a / jerk) / 2 to the time of linear move with the
+    // same peak acceleration, remove it and solve as linear move
+    const std::int64_t t = static_cast<std::int64_t>(time) - k.jerk_time;
+    if (t > 0) {
+      rate = time_limited_rate(k, profile.steps, t);
+    }
+  }
+
+  const util::fixed::q16 start_rate = std::min(k.start_rate, rate);
+
+  const auto compute = [&](util::fixed::q16 target) {
+    profile.accel_curve.compute(start_rate, target, k.acceleration, k.jerk);
+    profile.decel_curve.compute(start_rate, target, k.deceleration, k.jerk);
+    return profile.accel_curve.distance() + profile.decel_curve.distance();
+  };
+
+  const util::fixed::q16 available = util::fixed::from_int(profile.steps);
+
+  if (compute(rate) > available) {
+    // cannot reach max speed, find the highest peak that still fits
+    util::fixed::q16 low = start_rate;
+    util::fixed::q16 high = rate;
+    while (high - low > 1) {
+      const util::fixed::q16 mid = low + (high - low) / 2;
+      if (compute(mid) > available) {
+        high = mid;
+      } else {
+        low = mid;
+      }
+    }
+    rate = low;
+    compute(rate);
+  }
+
+  // how many microsteps from start to peak speed
+  profile.steps_to_cruise =
+      std::min(static_cast<step>(
+                   util::fixed::round(profile.accel_curve.distance())),
+               profile.steps);
+  // how many microsteps are needed from peak speed to a full stop
+  profile.steps_to_brake =
+      std::min(static_cast<step>(
+                   util::fixed::round(profile.decel_curve.distance())),
+               profile.steps - profile.steps_to_cruise);
+
+  profile.start_rate = start_rate;
+  profile.cruise_rate = rate;
+  profile.cruise_pulse = rate_to_pulse(rate);
+
+  const step cruise_steps = std::max(
+      profile.steps - profile.steps_to_cruise - profile.steps_to_brake, 0L);
+
+  profile.accelerate = seconds_to_micros(profile.accel_curve.duration());
+  profile.decelerate = seconds_to_micros(profile.decel_curve.duration());
+  profile.cruise = static_cast<time_unit>(cruise_steps * profile.cruise_pulse);
+}
+
+Profile plan(const Kinematics& kinematics,
+             speed             speed,
+             step              steps,
+             time_unit         time) {
+  Profile profile;
+  profile.steps = std::abs(steps);
+
+  if (profile.steps <= 0) {
+    return profile;
+  }
+
+  switch (speed) {
+    case speed::constant:
+      plan_constant(kinematics, profile, time);
+      break;
+    case speed::linear:
+      plan_linear(kinematics, profile, time);
+      break;
+    case speed::scurve:
+      plan_scurve(kinematics, profile, time);
+      break;
+  }
+
+  return profile;
+}
+}  // namespace stepper
+
 namespace impl {
 /** For constant speed */
 template <>
@@ -86,14 +551,15 @@ void StepperDeviceImpl<stepper::speed::constant>::start_move(long steps,
     return;
 
   pre_start_move(steps);
+
+  const auto profile =
+      stepper::plan(kinematics(), stepper::speed::constant, remaining_steps(),
+                    static_cast<time_unit>(std::max(time, 0L)));
+
   steps_to_cruise_ = 0;
   steps_to_brake_ = 0;
-  step_pulse_ = cruise_step_pulse_ =
-      calc_step_pulse_from_rpm(motor_steps(), microsteps(), rpm());
-  if (time > remaining_steps() * step_pulse()) {
-    step_pulse_ = static_cast<stepper::pulse>(static_cast<float>(time) /
-                                              remaining_steps());
-  }
+  cruise_step_pulse_ = kinematics().cruise_pulse;
+  step_pulse_ = profile.cruise_pulse;
 }
 
 template <>
@@ -113,42 +579,16 @@ void StepperDeviceImpl<stepper::speed::linear>::start_move(long steps,
                                                            long time) {
   pre_start_move(steps);
 
-  // speed is in [steps/s]
-  double speed = rpm() * motor_steps() / 60;
+  const auto profile =
+      stepper::plan(kinematics(), stepper::speed::linear, remaining_steps(),
+                    static_cast<time_unit>(std::max(time, 0L)));
 
-  if (time > 0) {
-    // Calculate a new speed to finish in the time requested
-    double t = static_cast<double>(time / (1e+6));  // convert to seconds
-    double d = static_cast<double>(remaining_steps() /
-                                   microsteps());  // convert to full steps
-    double a2 = 1.0 / acceleration() + 1.0 / deceleration();
-    double sqrt_candidate = t * t - 2.0 * a2 * d;  // in √b^2-4ac
-
-    if (sqrt_candidate >= 0) {
-      speed = std::min(
-          speed, (t - static_cast<double>(std::sqrt(sqrt_candidate))) / a2);
-    }
-  }
-  // how many microsteps from 0 to target speed
-  steps_to_cruise_ = static_cast<stepper::step>(
-      microsteps() * (speed * speed / (2 * acceleration())));
-  // how many microsteps are needed from cruise speed to a full stop
-  steps_to_brake_ = static_cast<stepper::step>(steps_to_cruise() *
-                                               acceleration() / deceleration());
-  if (remaining_steps() < steps_to_cruise() + steps_to_brake()) {
-    // cannot reach max speed, will need to brake early
-    steps_to_cruise_ = static_cast<stepper::step>(
-        remaining_steps() * deceleration() / (acceleration() + deceleration()));
+  steps_to_cruise_ = profile.steps_to_cruise;
+  steps_to_brake_ = profile.steps_to_brake;
+  cruise_step_pulse_ = profile.cruise_pulse;
 
-    steps_to_brake_ =
-        static_cast<stepper::step>(remaining_steps() - steps_to_cruise());
-  }
   // Initial pulse (c0) including error correction factor 0.676 [us]
-  step_pulse_ = static_cast<stepper::pulse>(
-      (1e+6) * 0.676 * std::sqrt(2.0 / acceleration() / microsteps()));
-  // Save cruise timing since we will no longer have the calculated target speed
-  // later
-  cruise_step_pulse_ = static_cast<stepper::pulse>(1e+6 / speed / microsteps());
+  step_pulse_ = std::max(ramp()->initial_pulse(), cruise_step_pulse());
 }
 
 template <>
@@ -163,25 +603,17 @@ void StepperDeviceImpl<stepper::speed::linear>::calc_step_pulse() {
 
   switch (state()) {
     case stepper::state::accelerating:
-      if (step_count() < steps_to_cruise()) {
-        step_pulse_ = step_pulse() - (2 * step_pulse() + rest_steps()) /
-                                         (4 * step_count() + 1);
-        rest_steps_ =
-            (step_count() < steps_to_cruise())
-                ? (2 * step_pulse() + rest_steps()) % (4 * step_count() + 1)
-                : 0;
-      } else {
-        // The series approximates target, set the final value to what it should
-        // be instead
-        step_pulse_ = cruise_step_pulse();
-      }
+      // The table approximates target, cruise pulse is used once the table
+      // (or steps to cruise) is exhausted
+      step_pulse_ = (step_count() < steps_to_cruise())
+                        ? std::max(ramp()->accel(step_count()),
+                                   cruise_step_pulse())
+                        : cruise_step_pulse();
       break;
 
     case stepper::state::decelerating:
-      step_pulse_ = step_pulse() - (2 * step_pulse() + rest_steps()) /
-                                       (-4 * remaining_steps() + 1);
-      rest_steps_ =
-          (2 * step_pulse() + rest_steps()) % (-4 * remaining_steps() + 1);
+      step_pulse_ = std::max(ramp()->decel(remaining_steps()),
+                             cruise_step_pulse());
       break;
 
     default:
@@ -189,44 +621,65 @@ void StepperDeviceImpl<stepper::speed::linear>::calc_step_pulse() {
   }
 }
 
+/** For s-curve speed */
 template <>
-time_unit StepperDeviceImpl<stepper::speed::constant>::time_for_move(
-    long steps) {
-  if (steps <= 0) {
-    return 0;
-  }
+void StepperDeviceImpl<stepper::speed::scurve>::start_move(long steps,
+                                                           long time) {
+  pre_start_move(steps);
 
-  double t = std::abs(steps) *
-             calc_step_pulse_from_rpm(motor_steps(), microsteps(), rpm());
-  return static_cast<time_unit>(std::lround(t));
+  const auto profile =
+      stepper::plan(kinematics(), stepper::speed::scurve, remaining_steps(),
+                    static_cast<time_unit>(std::max(time, 0L)));
+
+  steps_to_cruise_ = profile.steps_to_cruise;
+  steps_to_brake_ = profile.steps_to_brake;
+  accel_curve_ = profile.accel_curve;
+  decel_curve_ = profile.decel_curve;
+  cruise_step_pulse_ = profile.cruise_pulse;
+  ramp_time_ = 0;
+  step_pulse_ = std::max(rate_to_pulse(profile.start_rate), cruise_step_pulse());
 }
 
 template <>
-time_unit StepperDeviceImpl<stepper::speed::linear>::time_for_move(long steps) {
-  if (steps <= 0) {
-    return 0;
+void StepperDeviceImpl<stepper::speed::scurve>::calc_step_pulse() {
+  // this should not be happening, but avoids strange calculations
+  if (remaining_steps() <= 0) {
+    return;
   }
 
-  double t;
+  remaining_steps_--;
+  step_count_++;
 
-  start_move(steps);
+  // rate of ramps are evaluated in closed form from elapsed time, O(1)
+  switch (state()) {
+    case stepper::state::accelerating:
+      ramp_time_ += static_cast<time_unit>(step_pulse());
+      step_pulse_ = std::max(
+          rate_to_pulse(accel_curve().rate(micros_to_seconds(ramp_time()))),
+          cruise_step_pulse());
+      break;
 
-  if (remaining_steps() >= steps_to_cruise() + steps_to_brake()) {
-    double speed =
-        static_cast<double>(rpm()) * motor_steps() / 60;  // full steps/s
-    t = (static_cast<double>(std::abs(steps)) / (microsteps() * speed)) +
-        (speed / (2 * acceleration())) +
-        (speed / (2 * deceleration()));  // seconds
-  } else {
-    t = std::sqrt(2.0 * steps_to_cruise() / acceleration() /
-                  static_cast<double>(microsteps())) +
-        std::sqrt(2.0 * steps_to_brake() / deceleration() /
-                  static_cast<double>(microsteps()));
-  }
+    case stepper::state::cruising:
+      step_pulse_ = cruise_step_pulse();
+      break;
 
-  t *= (1e+6);  // seconds -> micros
+    case stepper::state::decelerating:
+      if (remaining_steps() + 1 > steps_to_brake()) {
+        // first step of deceleration
+        ramp_time_ = 0;
+      } else {
+        ramp_time_ += static_cast<time_unit>(step_pulse());
+      }
+      // deceleration is acceleration ramp in reverse time
+      step_pulse_ = std::max(
+          rate_to_pulse(decel_curve().rate(decel_curve().duration() -
+                                           micros_to_seconds(ramp_time()))),
+          cruise_step_pulse());
+      break;
 
-  return static_cast<time_unit>(std::lround(t));
+    default:
+      break;  // no speed changes
+  }
 }
 }  // namespace impl
 }  // namespace device
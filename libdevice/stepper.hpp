@@ -7,6 +7,7 @@
  * Stepper device using GPIO
  */
 
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 
@@ -19,6 +20,9 @@
 #include "gpio.hpp"
 
 #include "digital.hpp"
+#include "gpio_bank.hpp"
+
+#include "ramp_table.hpp"
 
 NAMESPACE_BEGIN
 
@@ -42,6 +46,7 @@ namespace stepper {
 enum class speed {
   constant, /**< constant speed */
   linear,   /**< linear speed using equation */
+  scurve,   /**< jerk-limited s-curve speed */
 };
 
 /** Stepper state */
@@ -61,6 +66,250 @@ using step = long;
  * @brief Type definition for stepper pulses
  */
 using pulse = long;
+
+/**
+ * @brief Precomputed stepper kinematics
+ *
+ * Integer and fixed-point values derived from rpm, acceleration, deceleration,
+ * jerk, microsteps, and motor steps. They are recomputed only when one of the
+ * parameters changes, so every move and every step is integer-only.
+ *
+ * Steps are microsteps and rates are Q16.16 steps / s
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+struct Kinematics {
+  Kinematics();
+  /**
+   * Compute kinematics from motor parameters
+   *
+   * @param rpm          target motor rpm
+   * @param acceleration acceleration (full steps / s^2)
+   * @param deceleration deceleration (full steps / s^2)
+   * @param jerk         jerk (full steps / s^3), 0 means unlimited
+   * @param microsteps   stepper microsteps
+   * @param motor_steps  motor steps per revolution
+   */
+  Kinematics(double rpm,
+             double acceleration,
+             double deceleration,
+             double jerk,
+             step   microsteps,
+             step   motor_steps);
+
+  /**
+   * Cruise rate (steps / s)
+   */
+  util::fixed::q16 cruise_rate;
+  /**
+   * Start rate from standstill, 1 / c0 (steps / s)
+   */
+  util::fixed::q16 start_rate;
+  /**
+   * Cruise pulse (us)
+   */
+  pulse cruise_pulse;
+  /**
+   * Acceleration (steps / s^2)
+   */
+  std::int64_t acceleration;
+  /**
+   * Deceleration (steps / s^2)
+   */
+  std::int64_t deceleration;
+  /**
+   * Jerk (steps / s^3), 0 means unlimited
+   */
+  std::int64_t jerk;
+  /**
+   * Reciprocal of acceleration (us^2 / step)
+   */
+  std::int64_t accel_inverse;
+  /**
+   * Reciprocal of deceleration (us^2 / step)
+   */
+  std::int64_t decel_inverse;
+  /**
+   * Share of acceleration when cruise speed cannot be reached, D / (A + D)
+   */
+  util::fixed::q16 brake_ratio;
+  /**
+   * Steps from standstill to cruise speed with linear ramp
+   */
+  step steps_to_cruise;
+  /**
+   * Steps from cruise speed to standstill with linear ramp
+   */
+  step steps_to_brake;
+  /**
+   * Time of both linear ramps on top of cruise time, v / 2A + v / 2D (us)
+   */
+  std::int64_t ramp_time;
+  /**
+   * Time added by jerk phases to both ramps, (A + D) / 2J (us)
+   */
+  std::int64_t jerk_time;
+};
+
+/**
+ * @brief Jerk-limited speed ramp
+ *
+ * Speed change from start rate to target rate with linear acceleration
+ * ramps (constant jerk) on both ends, used by stepper::speed::scurve. The
+ * ramp is symmetric, so deceleration is the same ramp in reverse time.
+ *
+ * Rates are Q16.16 steps / s and times are Q16.16 seconds
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+struct SCurve {
+  SCurve();
+  /**
+   * Compute ramp phases
+   *
+   * @param start        start rate (steps / s)
+   * @param target       target rate (steps / s)
+   * @param acceleration maximum acceleration (steps / s^2)
+   * @param jerk         maximum jerk (steps / s^3), 0 means unlimited
+   */
+  void compute(util::fixed::q16 start,
+               util::fixed::q16 target,
+               std::int64_t     acceleration,
+               std::int64_t     jerk);
+  /**
+   * Get rate at given time of the ramp
+   *
+   * @param t time since start of the ramp (s)
+   *
+   * @return rate (steps / s)
+   */
+  util::fixed::q16 rate(util::fixed::q16 t) const;
+  /**
+   * Get duration of the ramp
+   *
+   * @return duration (s)
+   */
+  inline util::fixed::q16 duration() const {
+    return 2 * jerk_time + constant_time;
+  }
+  /**
+   * Get distance of the ramp
+   *
+   * @return distance (steps)
+   */
+  inline util::fixed::q16 distance() const {
+    return util::fixed::mul(start_rate + delta_rate / 2, duration());
+  }
+
+  /**
+   * Start rate (steps / s)
+   */
+  util::fixed::q16 start_rate;
+  /**
+   * Rate change from start rate to target rate (steps / s)
+   */
+  util::fixed::q16 delta_rate;
+  /**
+   * Jerk (steps / s^3)
+   */
+  std::int64_t jerk;
+  /**
+   * Acceleration that is reached by the ramp (steps / s^2)
+   */
+  std::int64_t peak_acceleration;
+  /**
+   * Duration of each jerk phase (s)
+   */
+  util::fixed::q16 jerk_time;
+  /**
+   * Duration of constant acceleration phase (s)
+   */
+  util::fixed::q16 constant_time;
+};
+
+/**
+ * @brief Speed profile of single move
+ *
+ * Everything a stepper needs to start a move, plus the time spent in each
+ * phase. It is computed by stepper::plan without touching any stepper, so it
+ * can be used to estimate moves that are never taken.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+struct Profile {
+  Profile();
+  /**
+   * Get duration of the move
+   *
+   * @return duration (us)
+   */
+  inline time_unit duration() const { return accelerate + cruise + decelerate; }
+
+  /**
+   * Steps to take
+   */
+  step steps;
+  /**
+   * Steps from standstill to peak speed
+   */
+  step steps_to_cruise;
+  /**
+   * Steps from peak speed to standstill
+   */
+  step steps_to_brake;
+  /**
+   * Start rate from standstill (steps / s)
+   */
+  util::fixed::q16 start_rate;
+  /**
+   * Cruise rate, lowered to finish in the requested time (steps / s)
+   */
+  util::fixed::q16 cruise_rate;
+  /**
+   * Cruise pulse (us)
+   */
+  pulse cruise_pulse;
+  /**
+   * Acceleration ramp, only used by s-curve speed
+   */
+  SCurve accel_curve;
+  /**
+   * Deceleration ramp, only used by s-curve speed
+   */
+  SCurve decel_curve;
+  /**
+   * Time spent accelerating (us)
+   */
+  time_unit accelerate;
+  /**
+   * Time spent at cruise rate (us)
+   */
+  time_unit cruise;
+  /**
+   * Time spent decelerating (us)
+   */
+  time_unit decelerate;
+};
+
+/**
+ * Plan speed profile of a move
+ *
+ * Pure function, the same profile is used by StepperDeviceImpl::start_move
+ *
+ * @param kinematics precomputed kinematics
+ * @param speed      speed mode
+ * @param steps      steps to take (absolute)
+ * @param time       finish time (us), 0 to move as fast as possible
+ *
+ * @return speed profile of the move
+ */
+Profile plan(const Kinematics& kinematics,
+             speed             speed,
+             step              steps,
+             time_unit         time = 0);
 }  // namespace stepper
 
 /** device::StepperDevice registry singleton class using
@@ -76,6 +325,10 @@ using ConstantSpeedStepperDevice =
 using LinearSpeedStepperDevice =
     impl::StepperDeviceImpl<stepper::speed::linear>;
 
+/** S-curve speed specific implementation for Basic Stepper Device */
+using SCurveSpeedStepperDevice =
+    impl::StepperDeviceImpl<stepper::speed::scurve>;
+
 /**
  * @brief Stepper Device implementation.
  *
@@ -87,6 +340,10 @@ using LinearSpeedStepperDevice =
  */
 class StepperDevice : public StackObj {
  public:
+  /**
+   * tWH(STEP) pulse duration, STEP high, min value (us)
+   */
+  static const time_unit step_high_min;
   /**
    * Enable stepper motor
    */
@@ -134,13 +391,52 @@ class StepperDevice : public StackObj {
   /**
    * Get calculated time to complete move with given steps.
    *
-   * This will invoke StepperDevice::start_move
+   * Does not touch the current move, see stepper::plan
    *
    * @param steps to take
    *
    * @return calculated time to complete given move
    */
   virtual time_unit time_for_move(long steps) = 0;
+  /**
+   * Advance stepper by one step following its speed profile
+   *
+   * Will not generate output to the stepper pins and will not wait, it is
+   * used by external step scheduler (e.g. mechanism::Interpolator)
+   *
+   * @return pulse interval (us) until next step is due
+   */
+  virtual stepper::pulse yield_pulse() = 0;
+  /**
+   * Advance step counters by one step without speed profile calculation
+   *
+   * Will not generate output to the stepper pins and will not wait, it is
+   * used for slave axes of external step scheduler
+   */
+  void yield_step();
+  /**
+   * Write current direction to the direction pin
+   */
+  void write_direction() const;
+  /**
+   * Add current direction of the direction pin to the bank
+   *
+   * @param bank GPIO bank to write later
+   */
+  void write_direction(GpioBank& bank) const;
+  /**
+   * Write level to the step pin
+   *
+   * @param level digital::value::high or digital::value::low
+   */
+  void write_step(const digital::value& level) const;
+  /**
+   * Add level of the step pin to the bank
+   *
+   * @param bank  GPIO bank to write later
+   * @param level digital::value::high or digital::value::low
+   */
+  void write_step(GpioBank& bank, const digital::value& level) const;
   /**
    * Get remaining steps
    *
@@ -167,6 +463,24 @@ class StepperDevice : public StackObj {
    * @return current microsteps
    */
   const stepper::step& microsteps() const { return microsteps_; }
+  /**
+   * Switch microstep resolution of the driver, microsteps() is kept
+   *
+   * Every pulse will move microsteps() / resolution microsteps, used for
+   * coarse stepping during fast moves. Position is only exact if it is
+   * switched at a full-step boundary
+   *
+   * @param resolution microsteps of the driver
+   *
+   * @return true if the driver is using given resolution
+   */
+  virtual bool step_resolution(const stepper::step& resolution);
+  /**
+   * Get microstep resolution of the driver can be switched or not
+   *
+   * @return true if step_resolution() can switch the resolution
+   */
+  inline virtual bool switchable() const { return false; }
   /**
    * Set current rpm of stepper motor
    *
@@ -205,6 +519,20 @@ class StepperDevice : public StackObj {
    * @return current deceleration
    */
   inline double deceleration() const { return deceleration_; }
+  /**
+   * Set jerk of stepper motor (steps / s^3)
+   *
+   * Only used by stepper::speed::scurve, 0 means unlimited
+   *
+   * @param jerk jerk to set
+   */
+  virtual void jerk(double jerk);
+  /**
+   * Get current jerk of stepper motor
+   *
+   * @return current jerk
+   */
+  inline double jerk() const { return jerk_; }
   /**
    * Get stepper direction
    *
@@ -261,6 +589,40 @@ class StepperDevice : public StackObj {
    * @return current rpm from calculation
    */
   inline virtual double current_rpm() const { return 0.0; }
+  /**
+   * Get precomputed kinematics
+   *
+   * @return kinematics of current parameters
+   */
+  inline const stepper::Kinematics& kinematics() const { return kinematics_; }
+  /**
+   * Record timing of a step pulse
+   *
+   * Called from the thread that generates the pulses
+   *
+   * @param scheduled scheduled interval from previous step (us)
+   * @param actual    actual interval from previous step (us)
+   * @param overrun   time past the deadline of the step (us)
+   */
+  void record_timing(time_unit scheduled, time_unit actual, time_unit overrun);
+  /**
+   * Clear recorded step timing
+   */
+  void reset_timing();
+  /**
+   * Get histogram of difference between scheduled and actual step interval
+   *
+   * @return histogram in microseconds
+   */
+  inline const algo::Histogram& interval_error() const {
+    return interval_error_;
+  }
+  /**
+   * Get histogram of step deadline overrun
+   *
+   * @return histogram in microseconds
+   */
+  inline const algo::Histogram& overrun() const { return overrun_; }
 
  protected:
   /**
@@ -327,12 +689,14 @@ class StepperDevice : public StackObj {
    * @return enable GPIO pin
    */
   inline const PI_PIN& enable_pin() const { return enable_pin_; }
-
- protected:
   /**
-   * tWH(STEP) pulse duration, STEP high, min value (us)
+   * Recompute kinematics from current parameters
+   *
+   * Called lazily from start of move after any parameter has changed
    */
-  static const time_unit step_high_min;
+  void update_kinematics();
+
+ protected:
   /**
    * Step GPIO pin
    */
@@ -373,6 +737,10 @@ class StepperDevice : public StackObj {
    * Stepper deceleration constant
    */
   double deceleration_;
+  /**
+   * Stepper jerk constant
+   */
+  double jerk_;
   /**
    * Direction state
    */
@@ -383,6 +751,14 @@ class StepperDevice : public StackObj {
    * Usually 200 steps / revolution
    */
   stepper::step motor_steps_;
+  /**
+   * Precomputed kinematics
+   */
+  stepper::Kinematics kinematics_;
+  /**
+   * Kinematics need to be recomputed
+   */
+  bool kinematics_dirty_;
 
   /* Movement mechanism variables */
   /**
@@ -401,7 +777,26 @@ class StepperDevice : public StackObj {
    * Step counter, will be resetted for each move sequence
    */
   stepper::step step_count_;
+  /**
+   * Timestamp of last step pulse, 0 before the first step of a move
+   */
+  time_unit last_step_;
+  /**
+   * Scheduled pulse interval after last step
+   */
+  time_unit last_pulse_;
   /* End of movement mechanism variables */
+
+  /* Step timing instrumentation */
+  /**
+   * Difference between scheduled and actual step interval (us)
+   */
+  algo::Histogram interval_error_;
+  /**
+   * Step deadline overrun (us)
+   */
+  algo::Histogram overrun_;
+  /* End of step timing instrumentation */
 };
 
 namespace impl {
@@ -474,13 +869,19 @@ class StepperDeviceImpl : public StepperDevice {
   /**
    * Get calculated time to complete move with given steps.
    *
-   * This will invoke StepperDeviceImpl::start_move
+   * Does not touch the current move, see stepper::plan
    *
    * @param steps to take
    *
    * @return calculated time to complete given move
    */
   virtual time_unit time_for_move(long steps) override;
+  /**
+   * Advance stepper by one step following its speed profile
+   *
+   * @return pulse interval (us) until next step is due
+   */
+  virtual stepper::pulse yield_pulse() override;
   /**
    * Stop stepper from moving
    *
@@ -551,21 +952,42 @@ class StepperDeviceImpl : public StepperDevice {
   inline const stepper::pulse& cruise_step_pulse() const {
     return cruise_step_pulse_;
   }
-
-  /* Movement mechanism */
   /**
-   * calculate the step pulse in microseconds for a given rpm value.
-   * 60[s/min] * 1000000[us/s] / microsteps / steps / rpm
+   * Get ramp table of current move
+   *
+   * @return shared_ptr of ramp table, only used by linear speed
+   */
+  inline const std::shared_ptr<const RampTable>& ramp() const {
+    return ramp_;
+  }
+  /**
+   * Get acceleration ramp of current move
+   *
+   * @return acceleration ramp, only used by s-curve speed
    */
-  static constexpr stepper::pulse calc_step_pulse_from_rpm(
-      const stepper::step& steps,
-      const stepper::step& microsteps,
-      double               rpm);
+  inline const stepper::SCurve& accel_curve() const { return accel_curve_; }
+  /**
+   * Get deceleration ramp of current move
+   *
+   * @return deceleration ramp, only used by s-curve speed
+   */
+  inline const stepper::SCurve& decel_curve() const { return decel_curve_; }
+  /**
+   * Get elapsed time of current ramp
+   *
+   * @return elapsed time of current ramp (us)
+   */
+  inline const time_unit& ramp_time() const { return ramp_time_; }
 
+  /* Movement mechanism */
   /**
    * calculate the step pulse for each yield move
    */
   void calc_step_pulse();
+  /**
+   * Recompute kinematics (and ramp table) if parameters have changed
+   */
+  void refresh_kinematics();
   /**
    * Pre Start move configuration
    *
@@ -596,6 +1018,22 @@ class StepperDeviceImpl : public StepperDevice {
    * Cruise step pulses
    */
   stepper::pulse cruise_step_pulse_;
+  /**
+   * Precomputed ramp table of current move
+   */
+  std::shared_ptr<const RampTable> ramp_;
+  /**
+   * Acceleration ramp of current move
+   */
+  stepper::SCurve accel_curve_;
+  /**
+   * Deceleration ramp of current move
+   */
+  stepper::SCurve decel_curve_;
+  /**
+   * Elapsed time of current ramp (us)
+   */
+  time_unit ramp_time_;
 };
 }  // namespace impl
 }  // namespace device
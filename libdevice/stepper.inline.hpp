@@ -26,6 +26,7 @@ StepperDeviceImpl<Speed>::StepperDeviceImpl(PI_PIN        step_pin,
   steps_to_brake_ = 0;
   step_pulse_ = 0;
   cruise_step_pulse_ = 0;
+  ramp_time_ = 0;
   /*  End of movement mechanism variables initialization */
 }
 
@@ -49,23 +50,40 @@ stepper::state StepperDeviceImpl<Speed>::state() const {
 }
 
 template <stepper::speed Speed>
-constexpr stepper::pulse StepperDeviceImpl<Speed>::calc_step_pulse_from_rpm(
-    const stepper::step& steps,
-    const stepper::step& microsteps,
-    double               rpm) {
-  return static_cast<stepper::pulse>(
-      std::lround(60.0 * 1000000L / static_cast<double>(steps) /
-                  static_cast<double>(microsteps) / rpm));
+void StepperDeviceImpl<Speed>::refresh_kinematics() {
+  // parameters have changed since last move
+  if (kinematics_dirty_) {
+    update_kinematics();
+    if constexpr (Speed == stepper::speed::linear) {
+      // Ramp table is shared across moves and axes with the same parameters
+      ramp_ = RampTable::get(
+          {rpm(), acceleration(), deceleration(), microsteps(), motor_steps()});
+    }
+  }
+}
+
+template <stepper::speed Speed>
+time_unit StepperDeviceImpl<Speed>::time_for_move(long steps) {
+  if (steps <= 0) {
+    return 0;
+  }
+
+  refresh_kinematics();
+
+  return stepper::plan(kinematics(), Speed, steps).duration();
 }
 
 template <stepper::speed Speed>
 void StepperDeviceImpl<Speed>::pre_start_move(long steps) {
+  refresh_kinematics();
+
   // set direction
   direction_ =
       (steps >= 0) ? stepper::direction::forward : stepper::direction::backward;
 
   // setup timer
   last_move_end_ = 0;
+  last_step_ = 0;
   // initialize steps
   remaining_steps_ = static_cast<stepper::step>(std::abs(steps));
   step_count_ = 0;
@@ -82,11 +100,9 @@ time_unit StepperDeviceImpl<Speed>::next(bool stop_condition) {
   if (remaining_steps() > 0) {
     // original code : delayMicros(next_action_interval, last_action_end);
 
-    // while (micros() - start_us < delay_us);
-    while ((micros() - last_move_end()) < (next_move_interval() + 10)) {
-      // not yet running
-      // return -1;
-    }
+    // sleep until just before the deadline, then spin
+    const time_unit deadline = last_move_end() + next_move_interval() + 10;
+    wait_until(deadline);
 
     // DIR pin is sampled on rising STEP edge, so it is set first
     switch (direction()) {
@@ -113,6 +129,13 @@ time_unit StepperDeviceImpl<Speed>::next(bool stop_condition) {
     step_device()->write(digital::value::low);
     // end of pulsing
 
+    if (last_step_ != 0) {
+      record_timing(last_pulse_, m - last_step_,
+                    (m > deadline) ? m - deadline : 0);
+    }
+    last_step_ = m;
+    last_pulse_ = pulse;
+
     // account for calcStepPulse() execution time;
     // sets ceiling for max rpm on slower MCUs
     last_move_end_ = micros();
@@ -127,6 +150,19 @@ time_unit StepperDeviceImpl<Speed>::next(bool stop_condition) {
   return next_move_interval();
 }
 
+template <stepper::speed Speed>
+stepper::pulse StepperDeviceImpl<Speed>::yield_pulse() {
+  if (remaining_steps() <= 0) {
+    return 0;
+  }
+
+  // save value because calc_step_pulse() will overwrite it
+  stepper::pulse pulse = step_pulse();
+  calc_step_pulse();
+
+  return pulse;
+}
+
 template <stepper::speed Speed>
 void StepperDeviceImpl<Speed>::move(long steps, bool stop_condition) {
   start_move(steps);
@@ -148,8 +184,9 @@ double StepperDeviceImpl<Speed>::current_rpm() const {
   if (step_pulse() == 0) {
     return 0.0;
   }
-  return static_cast<double>(60.0 * 1000000L / step_pulse() / microsteps() /
-                             motor_steps());
+  // 60[s/min] * 1000000[us/s] / pulse / microsteps / steps
+  return 60e+6 / static_cast<double>(step_pulse() * microsteps() *
+                                     motor_steps());
 }
 }  // namespace impl
 }  // namespace device
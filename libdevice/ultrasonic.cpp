@@ -2,13 +2,42 @@
 
 #include "ultrasonic.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include <libutil/util.hpp>
 
 NAMESPACE_BEGIN
 
 namespace device {
-const double UltrasonicDevice::supersonic_speed = 1.0 / 29.1;  // in cm/us
-const double UltrasonicDevice::max_distance = 400.0;           // in cm
+const double      UltrasonicDevice::supersonic_speed = 1.0 / 29.1;  // in cm/us
+const double      UltrasonicDevice::max_distance = 400.0;           // in cm
+const time_unit   UltrasonicDevice::default_period = 60;            // in ms
+const std::size_t UltrasonicDevice::default_window = 5;
+
+/**
+ * Get median of samples
+ *
+ * @param samples samples, reordered in place
+ *
+ * @return median
+ */
+static double median(std::vector<double>& samples) {
+  massert(!samples.empty(), "sanity");
+
+  const auto middle = samples.begin() + samples.size() / 2;
+  std::nth_element(samples.begin(), middle, samples.end());
+
+  if (samples.size() % 2 == 1) {
+    return *middle;
+  }
+
+  // lower half is before middle after nth_element
+  return (*middle + *std::max_element(samples.begin(), middle)) / 2.0;
+}
 
 UltrasonicDevice::UltrasonicDevice(PI_PIN echo_pin,
                                    PI_PIN trigger_pin,
@@ -18,7 +47,9 @@ UltrasonicDevice::UltrasonicDevice(PI_PIN echo_pin,
       trigger_pin_{trigger_pin},
       echo_device_{DigitalInputDevice::create(echo_pin, echo_active_state)},
       trigger_device_{
-          DigitalOutputDevice::create(trigger_pin, trigger_active_state)} {
+          DigitalOutputDevice::create(trigger_pin, trigger_active_state)},
+      running_{false},
+      level_{std::numeric_limits<double>::quiet_NaN()} {
   DEBUG_ONLY_DEFINITION(
       obj_name_ = fmt::format("UltraSonicDevice echo_pin {} echo_active_state "
                               "{} trigger_pin {} trigger_active_state {}",
@@ -27,7 +58,9 @@ UltrasonicDevice::UltrasonicDevice(PI_PIN echo_pin,
   massert(active(), "sanity");
 }
 
-UltrasonicDevice::~UltrasonicDevice() {}
+UltrasonicDevice::~UltrasonicDevice() {
+  stop();
+}
 
 double UltrasonicDevice::max_echo_time(double max_input_distance) const {
   // 10 is correction factor
@@ -35,10 +68,7 @@ double UltrasonicDevice::max_echo_time(double max_input_distance) const {
          10;
 }
 
-std::optional<double> UltrasonicDevice::distance(
-    double max_input_distance) const {
-  const double max_time = max_echo_time(max_input_distance);
-
+void UltrasonicDevice::trigger() const {
   // trigger to low to make sure
   trigger_device()->write(digital::value::low);
 
@@ -53,6 +83,13 @@ std::optional<double> UltrasonicDevice::distance(
 
   // trigger to low
   trigger_device()->write(digital::value::low);
+}
+
+std::optional<double> UltrasonicDevice::distance(
+    double max_input_distance) const {
+  const double max_time = max_echo_time(max_input_distance);
+
+  trigger();
 
   time_unit start_task = micros();
   time_unit start = start_task;
@@ -80,6 +117,146 @@ std::optional<double> UltrasonicDevice::distance(
   return (static_cast<double>(elapsed) / 2.0) * supersonic_speed;
 }
 
+ATM_STATUS UltrasonicDevice::start(time_unit   period,
+                                   std::size_t window,
+                                   double      max_input_distance) {
+  massert(active(), "sanity");
+  massert(window > 0, "sanity");
+
+  if (!active() || window == 0) {
+    return ATM_ERR;
+  }
+
+  if (ranging()) {
+    return ATM_OK;
+  }
+
+  // echo callback takes the mutex, so it is not held while subscribing
+  subscription_ = echo_device()->subscribe(
+      [this](const digital::Event& event) { echo(event); });
+  if (!subscription_) {
+    LOG_ERROR("Cannot listen to echo pin {} of ultrasonic device", echo_pin());
+    return ATM_ERR;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  rise_.reset();
+  echo_.reset();
+
+  running_.store(true, std::memory_order_release);
+  thread_ = std::thread(&UltrasonicDevice::range, this, period, window,
+                        max_input_distance);
+
+  return ATM_OK;
+}
+
+void UltrasonicDevice::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_.store(false, std::memory_order_release);
+  }
+  signal_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  // same as subscribing, the mutex is not held
+  subscription_.reset();
+}
+
+std::optional<double> UltrasonicDevice::level() const {
+  const double level = level_.load(std::memory_order_acquire);
+
+  if (std::isnan(level)) {
+    return {};
+  }
+
+  return level;
+}
+
+void UltrasonicDevice::range(time_unit   period,
+                             std::size_t window,
+                             double      max_input_distance) {
+  const auto max_time = std::chrono::microseconds(
+      static_cast<std::int64_t>(max_echo_time(max_input_distance)));
+  const double max_range = std::min(max_distance, max_input_distance);
+
+  // ring of last samples, empty slot is a missed echo
+  std::vector<std::optional<double>> samples(window);
+  std::vector<double>                valid;
+  valid.reserve(window);
+  std::size_t next = 0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (running_.load(std::memory_order_acquire)) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(period);
+
+    rise_.reset();
+    echo_.reset();
+
+    lock.unlock();
+    trigger();
+    lock.lock();
+
+    // echo starts some time after the pulse, so both are waited for
+    signal_.wait_for(lock, max_time * 2, [this] {
+      return echo_.has_value() || !running_.load(std::memory_order_acquire);
+    });
+
+    std::optional<double> sample;
+    if (echo_) {
+      const double distance =
+          (static_cast<double>(*echo_) / 2.0) * supersonic_speed;
+      if (distance <= max_range) {
+        sample = distance;
+      }
+    }
+
+    samples[next] = sample;
+    next = (next + 1) % window;
+
+    // median drops single outliers, missed echoes are not counted
+    valid.clear();
+    for (const auto& value : samples) {
+      if (value) {
+        valid.push_back(*value);
+      }
+    }
+
+    level_.store(valid.empty() ? std::numeric_limits<double>::quiet_NaN()
+                               : median(valid),
+                 std::memory_order_release);
+
+    signal_.wait_until(lock, deadline, [this] {
+      return !running_.load(std::memory_order_acquire);
+    });
+  }
+}
+
+void UltrasonicDevice::echo(const digital::Event& event) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (event.edge == digital::edge::rising) {
+      rise_ = event.tick;
+      return;
+    }
+
+    if (!rise_ || echo_) {
+      return;
+    }
+
+    // ticks wrap around, the difference does not
+    echo_ = event.tick - *rise_;
+  }
+
+  signal_.notify_all();
+}
+
 bool UltrasonicDevice::active() const {
   return echo_device()->active() && trigger_device()->active();
 }
@@ -7,10 +7,17 @@
  * Ultrasonic HC-SR04 Device using GPIO
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 #include <libalgo/algo.hpp>
 #include <libcore/core.hpp>
+#include <libutil/util.hpp>
 
 #include "gpio.hpp"
 
@@ -33,6 +40,11 @@ using UltrasonicDeviceRegistry = algo::InstanceRegistry<UltrasonicDevice>;
  * Ultrasonic HC-SR04 Device implementation using
  * device::DigitalOutputDevice and device::DigitalOutputDevice
  *
+ * Ranging can run in the background: a thread triggers a pulse every
+ * period, echo is timed from the ticks of its level changes instead of
+ * polling, and the median of the last samples is published, so level() is
+ * a single atomic load for any reader.
+ *
  * @author Ray Andrew
  * @date   June 2020
  */
@@ -51,12 +63,62 @@ class UltrasonicDevice : public StackObj {
    *
    * BEWARE: that this function can block the current thread!
    *
+   * Must not be called while ranging in the background, use level()
+   *
    * @param max_input_distance max input distance
    *
    * @return distance in cm (optional, can be failed)
    */
   std::optional<double> distance(
       double max_input_distance = max_distance) const;
+  /**
+   * Default time between pulses of background ranging in ms
+   */
+  static const time_unit default_period;
+  /**
+   * Default number of samples of median filter
+   */
+  static const std::size_t default_window;
+  /**
+   * Start ranging in the background
+   *
+   * Echo pin must be GPIO 0-31, its level changes are timestamped by Pigpio
+   * lib
+   *
+   * @param period             time between pulses in ms, HC-SR04 needs at
+   *                           least 60 ms
+   * @param window             number of samples of median filter
+   * @param max_input_distance max input distance in cm, farther samples are
+   *                           dropped
+   *
+   * @return ATM_OK or ATM_ERR, but not both
+   */
+  ATM_STATUS start(time_unit   period = default_period,
+                   std::size_t window = default_window,
+                   double      max_input_distance = max_distance);
+  /**
+   * Stop ranging in the background
+   *
+   * Last level is kept
+   */
+  void stop();
+  /**
+   * Check if ranging in the background
+   *
+   * @return true if ranging
+   */
+  inline bool ranging() const {
+    return running_.load(std::memory_order_acquire);
+  }
+  /**
+   * Get latest filtered distance of background ranging
+   *
+   * Lock-free, it never waits for the sensor
+   *
+   * @return distance in cm, empty if there is no valid sample in the last
+   *         window
+   */
+  std::optional<double> level() const;
   /**
    * Get active status
    *
@@ -123,6 +185,26 @@ class UltrasonicDevice : public StackObj {
    * @return max echo time in us
    */
   double max_echo_time(double max_input_distance) const;
+  /**
+   * Background ranging loop
+   *
+   * @param period             time between pulses in ms
+   * @param window             number of samples of median filter
+   * @param max_input_distance max input distance in cm
+   */
+  void range(time_unit period, std::size_t window, double max_input_distance);
+  /**
+   * Send trigger pulse
+   */
+  void trigger() const;
+  /**
+   * Time echo from its level changes
+   *
+   * Runs on the alert thread of Pigpio lib
+   *
+   * @param event level change of echo pin
+   */
+  void echo(const digital::Event& event);
 
  private:
   /**
@@ -156,6 +238,38 @@ class UltrasonicDevice : public StackObj {
    * Trigger digital output device
    */
   const std::shared_ptr<DigitalOutputDevice> trigger_device_;
+  /**
+   * Background ranging thread
+   */
+  std::thread thread_;
+  /**
+   * Background ranging is running
+   */
+  std::atomic<bool> running_;
+  /**
+   * Mutex of echo timing and background ranging thread
+   */
+  std::mutex mutex_;
+  /**
+   * Signal of echo and stop
+   */
+  std::condition_variable signal_;
+  /**
+   * Subscription to level changes of echo pin
+   */
+  digital::Subscription subscription_;
+  /**
+   * Tick of rising edge of current echo
+   */
+  std::optional<std::uint32_t> rise_;
+  /**
+   * Duration of current echo in us
+   */
+  std::optional<std::uint32_t> echo_;
+  /**
+   * Latest filtered distance in cm, NaN if there is none
+   */
+  std::atomic<double> level_;
 };
 }  // namespace device
 
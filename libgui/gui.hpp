@@ -75,6 +75,7 @@
 #include "plc-trigger-window.hpp"
 #include "speed-profile-window.hpp"
 #include "status-window.hpp"
+#include "step-timing-window.hpp"
 #include "system-info-window.hpp"
 
 #endif  // APP_PRECOMPILED_HPP_
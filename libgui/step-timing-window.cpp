@@ -0,0 +1,86 @@
+#include "gui.hpp"
+
+#include "step-timing-window.hpp"
+
+#include <array>
+#include <string>
+#include <utility>
+
+#include <libdevice/device.hpp>
+
+NAMESPACE_BEGIN
+
+namespace gui {
+StepTimingWindow::StepTimingWindow(float                   width,
+                                   float                   height,
+                                   const ImGuiWindowFlags& flags)
+    : Window{"Step Timing", width, height, flags} {}
+
+StepTimingWindow::~StepTimingWindow() {}
+
+void StepTimingWindow::show([[maybe_unused]] Manager* manager) {
+  massert(device::StepperRegistry::get() != nullptr, "sanity");
+
+  auto* stepper_registry = device::StepperRegistry::get();
+
+  const std::array<std::pair<const char*, std::string>, 3> axes{
+      {{"X", device::id::stepper::x()},
+       {"Y", device::id::stepper::y()},
+       {"Z", device::id::stepper::z()}}};
+
+  ImGui::Columns(3, NULL, /* v_borders */ true);
+  for (const auto& [name, id] : axes) {
+    if (ImGui::GetColumnIndex() == 0)
+      ImGui::Separator();
+
+    ImGui::Text("%s", name);
+
+    auto&& stepper = stepper_registry->get(id);
+    if (!stepper) {
+      ImGui::NextColumn();
+      continue;
+    }
+
+    const auto& error = stepper->interval_error();
+    const auto& overrun = stepper->overrun();
+
+    ImGui::Text("Steps   %llu", static_cast<unsigned long long>(error.count()));
+    ImGui::Text("Interval error (us)");
+    ImGui::Text("  p50   %llu",
+                static_cast<unsigned long long>(error.percentile(50.0)));
+    ImGui::Text("  p99   %llu",
+                static_cast<unsigned long long>(error.percentile(99.0)));
+    ImGui::Text("  p99.9 %llu",
+                static_cast<unsigned long long>(error.percentile(99.9)));
+    ImGui::Text("  max   %llu", static_cast<unsigned long long>(error.max()));
+    ImGui::Text("Overrun (us)");
+    ImGui::Text("  p99   %llu",
+                static_cast<unsigned long long>(overrun.percentile(99.0)));
+    ImGui::Text("  max   %llu", static_cast<unsigned long long>(overrun.max()));
+
+    // buckets are log-linear, so the plot is on a log scale of error
+    std::array<float, algo::Histogram::bucket_count> buckets{};
+    std::size_t                                      used = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+      buckets[i] = static_cast<float>(error.bucket(i));
+      if (buckets[i] > 0.0f) {
+        used = i + 1;
+      }
+    }
+
+    ImGui::PushID(name);
+    ImGui::PlotHistogram("", buckets.data(), static_cast<int>(used), 0, NULL,
+                         0.0f, FLT_MAX, ImVec2(-FLT_MIN, 60.0f));
+    if (ImGui::Button("Reset")) {
+      stepper->reset_timing();
+    }
+    ImGui::PopID();
+
+    ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+  ImGui::Separator();
+}
+}  // namespace gui
+
+NAMESPACE_END
@@ -138,12 +138,15 @@ void job::operator()(Event const&, FSM& fsm, SourceState&, TargetState&) const {
   if (state->fault())
     return;
 
-  shift_register->write(device::id::comm::pi::spraying_running(),
-                        device::digital::value::low);
-  state->spraying_running(false);
+  // running and complete of spraying flip at the same latch
+  auto transaction = shift_register->transaction();
+  transaction.write(device::id::comm::pi::spraying_running(),
+                    device::digital::value::low);
+  transaction.write(device::id::comm::pi::spraying_complete(),
+                    device::digital::value::high);
+  transaction.commit();
 
-  shift_register->write(device::id::comm::pi::spraying_complete(),
-                        device::digital::value::high);
+  state->spraying_running(false);
   state->spraying_complete(true);
 }
 
@@ -274,12 +277,15 @@ void job::operator()(Event const&, FSM& fsm, SourceState&, TargetState&) const {
   if (state->fault())
     return;
 
-  shift_register->write(device::id::comm::pi::tending_running(),
-                        device::digital::value::low);
-  state->tending_running(false);
+  // running and complete of tending flip at the same latch
+  auto transaction = shift_register->transaction();
+  transaction.write(device::id::comm::pi::tending_running(),
+                    device::digital::value::low);
+  transaction.write(device::id::comm::pi::tending_complete(),
+                    device::digital::value::high);
+  transaction.commit();
 
-  shift_register->write(device::id::comm::pi::tending_complete(),
-                        device::digital::value::high);
+  state->tending_running(false);
   state->tending_complete(true);
 }
 
@@ -326,16 +332,20 @@ void job::operator()(Event const&, FSM& fsm, SourceState&, TargetState&) const {
   massert(device::ShiftRegister::get() != nullptr, "sanity");
   massert(mechanism::movement_mechanism() != nullptr, "sanity");
   massert(mechanism::movement_mechanism()->active(), "sanity");
+  massert(mechanism::Route::get() != nullptr, "sanity");
 
   auto*  config = Config::get();
   auto*  state = State::get();
   auto*  digital_output_registry = device::DigitalOutputDeviceRegistry::get();
   auto*  shift_register = device::ShiftRegister::get();
   auto&& movement = mechanism::movement_mechanism();
+  auto*  route = mechanism::Route::get();
 
   auto&& sonicator_relay =
       digital_output_registry->get(device::id::sonicator_relay());
 
+  const auto safe_height = config->clearance<Point>("safe-height");
+
   if (state->fault())
     return;
 
@@ -348,12 +358,13 @@ void job::operator()(Event const&, FSM& fsm, SourceState&, TargetState&) const {
   if (state->fault())
     return;
 
-  for (const auto& [x, y, time, sonicator] : config->cleaning_stations()) {
+  for (const auto& [x, y, time, sonicator] : route->cleaning_stations()) {
     if (state->fault())
       return;
 
+    // finger is lifted and lowered within the clearance envelope on the way
     LOG_INFO("Moving to cleaning station with x:{} y:{}", x, y);
-    movement->move<mechanism::movement::unit::mm>(x, y, 0.0);
+    movement->travel(x, y, safe_height);
 
     if (state->fault())
       return;
@@ -389,13 +400,13 @@ void job::operator()(Event const&, FSM& fsm, SourceState&, TargetState&) const {
 
     if (state->fault())
       return;
+  }
 
-    LOG_INFO("Moving finger up");
-    movement->move_finger_up();
+  if (state->fault())
+    return;
 
-    if (state->fault())
-      return;
-  }
+  LOG_INFO("Moving finger up");
+  movement->move_finger_up();
 
   if (state->fault())
     return;
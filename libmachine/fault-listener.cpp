@@ -2,7 +2,10 @@
 
 #include "fault-listener.hpp"
 
+#include <array>
+#include <chrono>
 #include <thread>
+#include <utility>
 
 #include <libdevice/device.hpp>
 #include <libutil/util.hpp>
@@ -10,7 +13,13 @@
 NAMESPACE_BEGIN
 
 namespace machine {
-FaultListener::FaultListener(tending* tsm) : tsm_{tsm} {}
+/**
+ * Checks are repeated at least this often, in case a notification of state
+ * change is missed, since it is not sent under the mutex of the listener
+ */
+static constexpr std::chrono::milliseconds poll_period{50};
+
+FaultListener::FaultListener(tending* tsm) : tsm_{tsm}, pending_{false} {}
 
 FaultListener::~FaultListener() {
   running_ = false;
@@ -44,10 +53,12 @@ void FaultListener::stop() {
 }
 
 void FaultListener::execute() {
+  massert(Config::get() != nullptr, "sanity");
   massert(State::get() != nullptr, "sanity");
   massert(device::DigitalInputDeviceRegistry::get() != nullptr, "sanity");
   massert(tsm()->is_ready(), "sanity");
 
+  auto* config = Config::get();
   auto* state = State::get();
   auto* digital_input_registry = device::DigitalInputDeviceRegistry::get();
 
@@ -63,20 +74,86 @@ void FaultListener::execute() {
       digital_input_registry->get(device::id::comm::plc::cleaning_height());
   auto&& e_stop = digital_input_registry->get(device::id::comm::plc::e_stop());
 
+  // every check evaluates a single snapshot of all inputs, so related inputs
+  // are never torn between reads, levels are debounced across snapshots
+  const std::chrono::microseconds period{
+      config->fault<std::uint32_t>("sample-period")};
+  device::GpioSampler sampler(static_cast<std::uint32_t>(period.count()));
+  sampler.add(e_stop);
+  sampler.add(limit_switch_x);
+  sampler.add(limit_switch_y);
+  sampler.add(finger_protection);
+  sampler.add(spraying_tending_height);
+  sampler.add(cleaning_height);
+
+  // checks are repeated on level change of any input instead of polling them
+  const auto on_change = [this, state](const device::digital::Event&) {
+    {
+      std::lock_guard<std::mutex> lock(mutex());
+      pending_ = true;
+    }
+    state->signal().notify_all();
+  };
+
+  const auto subscriptions = std::array{
+      e_stop->subscribe(on_change),
+      limit_switch_x->subscribe(on_change),
+      limit_switch_y->subscribe(on_change),
+      finger_protection->subscribe(on_change),
+      spraying_tending_height->subscribe(on_change),
+      cleaning_height->subscribe(on_change),
+  };
+
+  // tasks that decide which faults are checked
+  const auto activity = [state] {
+    return std::array{state->homing(), state->spraying_running(),
+                      state->tending_running(), state->cleaning_running()};
+  };
+
+  auto last = activity();
+  bool checked = false;
+
+  const auto ready = [this, state, &activity, &last, &checked] {
+    if (!state->running()) {
+      return true;
+    }
+
+    if (tsm()->is_no_task() || state->fault()) {
+      checked = false;
+      return false;
+    }
+
+    const bool changed = std::exchange(pending_, false);
+    return !checked || changed || activity() != last;
+  };
+
   while (running() && state->running()) {
     {
       std::unique_lock<std::mutex> lock(mutex());
-      state->signal().wait(lock, [this, state] {
-        return !state->running() || !(tsm()->is_no_task() || state->fault());
-      });
+      if (sampler.settled()) {
+        state->signal().wait_for(lock, poll_period, ready);
+      } else {
+        // level waiting for its debounce time is only reported if sampling
+        // goes on every period
+        state->signal().wait_for(lock, period, ready);
+      }
     }
 
     if (!running() || !state->running()) {
       return;
     }
 
+    const auto inputs = sampler.sample();
+
+    if (tsm()->is_no_task() || state->fault()) {
+      continue;
+    }
+
+    last = activity();
+    checked = true;
+
     // case 1: e-stop button is pressed
-    if (!state->fault() && e_stop->read_bool()) {
+    if (!state->fault() && inputs.read_bool(e_stop)) {
       LOG_ERROR("[FAULT] E-stop button is pressed");
       state->fault(true);
       tsm()->fault();
@@ -86,20 +163,21 @@ void FaultListener::execute() {
     //         limit switches are turning on while moving
     //         except for homing
     if (!state->fault() && !state->homing() &&
-        (limit_switch_x->read_bool() || limit_switch_y->read_bool())) {
+        (inputs.read_bool(limit_switch_x) ||
+         inputs.read_bool(limit_switch_y))) {
       LOG_ERROR("[FAULT] Limit switch x or y are touched");
       state->fault(true);
       tsm()->fault();
     }
 
     if (!state->fault() && !state->homing()) {
-      if (limit_switch_x->read_bool()) {
+      if (inputs.read_bool(limit_switch_x)) {
         LOG_ERROR("[FAULT] Limit switch x is touched");
         state->fault(true);
         tsm()->fault();
       }
 
-      if (limit_switch_y->read_bool()) {
+      if (inputs.read_bool(limit_switch_y)) {
         LOG_ERROR("[FAULT] Limit switch y is touched");
         state->fault(true);
         tsm()->fault();
@@ -111,7 +189,7 @@ void FaultListener::execute() {
     //           and the special limit switch for checking the finger
     if (!state->fault() &&
         (state->spraying_running() || state->tending_running())) {
-      if (!state->fault() && !spraying_tending_height->read_bool()) {
+      if (!state->fault() && !inputs.read_bool(spraying_tending_height)) {
         LOG_ERROR(
             "[FAULT] Spraying/Tending height is changed while running spray "
             "or tending task");
@@ -119,7 +197,7 @@ void FaultListener::execute() {
         tsm()->fault();
       }
 
-      if (!state->fault() && finger_protection->read_bool()) {
+      if (!state->fault() && inputs.read_bool(finger_protection)) {
         LOG_ERROR("[FAULT] Finger protection limit switch is touched");
         state->fault(true);
         tsm()->fault();
@@ -128,7 +206,7 @@ void FaultListener::execute() {
 
     // case 3.2: at tending and spraying height
     if (!state->fault() && state->cleaning_running()) {
-      if (!cleaning_height->read_bool()) {
+      if (!inputs.read_bool(cleaning_height)) {
         LOG_ERROR(
             "[FAULT] Cleaning height is changed while running cleaning task");
         state->fault(true);
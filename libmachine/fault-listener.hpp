@@ -56,6 +56,10 @@ class FaultListener : public Listener {
    * Mutex
    */
   std::mutex mutex_;
+  /**
+   * Level of monitored inputs has changed since last check
+   */
+  bool pending_;
 };
 }  // namespace machine
 
@@ -4,6 +4,7 @@
 #pragma GCC system_header
 
 // 1. STD
+#include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <exception>
@@ -2,12 +2,23 @@
 
 #include "restart-fault-listener.hpp"
 
+#include <chrono>
+#include <utility>
+
 #include <libutil/util.hpp>
 
 NAMESPACE_BEGIN
 
 namespace machine {
-RestartFaultListener::RestartFaultListener(tending* tsm) : tsm_{tsm} {}
+/**
+ * Conditions are checked again at least this often, in case a notification
+ * of state change is missed, since it is not sent under the mutex of the
+ * listener
+ */
+static constexpr std::chrono::milliseconds poll_period{50};
+
+RestartFaultListener::RestartFaultListener(tending* tsm)
+    : tsm_{tsm}, pending_{false} {}
 
 RestartFaultListener::~RestartFaultListener() {
   running_ = false;
@@ -40,36 +51,65 @@ void RestartFaultListener::stop() {
 }
 
 void RestartFaultListener::execute() {
+  massert(Config::get() != nullptr, "sanity");
   massert(State::get() != nullptr, "sanity");
   massert(tsm()->is_ready(), "sanity");
   massert(device::DigitalInputDeviceRegistry::get() != nullptr, "sanity");
 
+  auto* config = Config::get();
   auto* state = State::get();
   auto* digital_input_registry = device::DigitalInputDeviceRegistry::get();
 
   auto&& reset = digital_input_registry->get(device::id::comm::plc::reset());
 
+  // reset button is debounced the same way as inputs of fault listener
+  const std::chrono::microseconds period{
+      config->fault<std::uint32_t>("sample-period")};
+  device::GpioSampler sampler(static_cast<std::uint32_t>(period.count()));
+  sampler.add(reset);
+
+  // wait for reset button to be changed instead of polling it
+  const auto subscription =
+      reset->subscribe([this, state](const device::digital::Event&) {
+        {
+          std::lock_guard<std::mutex> lock(mutex());
+          pending_ = true;
+        }
+        state->signal().notify_all();
+      });
+
   while (running() && state->running()) {
     {
       std::unique_lock<std::mutex> lock(mutex());
-      state->signal().wait(
-          lock, [state] { return !state->running() || state->fault(); });
+      state->signal().wait_for(lock, poll_period, [state] {
+        return !state->running() || state->fault();
+      });
     }
 
     if (!running() || !state->running()) {
       return;
     }
 
-    while (!reset->read_bool()) {
-      if (state->fault()) {
-        // sleep a bit
-        sleep_for<time_units::millis>(50);
-      } else {
-        // break if fault is changed from other threads
-        break;
+    {
+      std::unique_lock<std::mutex> lock(mutex());
+      bool pressed = sampler.sample().read_bool(reset);
+      // break if fault is changed from other threads
+      while (!pressed && state->running() && state->fault()) {
+        // level waiting for its debounce time is only reported if sampling
+        // goes on every period
+        state->signal().wait_for(
+            lock, sampler.settled() ? poll_period : period, [this, state] {
+              return !state->running() || !state->fault() ||
+                     std::exchange(pending_, false);
+            });
+        pressed = sampler.sample().read_bool(reset);
       }
     }
 
+    if (!running() || !state->running()) {
+      return;
+    }
+
     if (state->fault()) {
       // restart is pressed
       state->homing(false);
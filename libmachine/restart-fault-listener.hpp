@@ -56,6 +56,10 @@ class RestartFaultListener : public Listener {
    * Mutex
    */
   std::mutex mutex_;
+  /**
+   * Level of reset button is changed while waiting
+   */
+  bool pending_;
 };
 }  // namespace machine
 
@@ -66,6 +66,10 @@ void TendingDef::run_cleaning() {
 }
 
 void TendingDef::task_completed() {
+  if (auto&& movement = mechanism::movement_mechanism(); movement != nullptr) {
+    movement->report_step_timing();
+  }
+
   rebind().process_event(event::task_complete{});
 }
 
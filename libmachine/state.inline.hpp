@@ -21,6 +21,7 @@ void TendingDef::running::no_task::on_enter(Event const&&, FSM& fsm) const {
   massert(mechanism::movement_mechanism() != nullptr, "sanity");
   massert(mechanism::movement_mechanism()->active(), "sanity");
   massert(device::ShiftRegister::get() != nullptr, "sanity");
+  massert(device::DigitalInputDeviceRegistry::get() != nullptr, "sanity");
 
   root_machine(fsm).thread_pool().enqueue([&fsm]() mutable -> void {
     auto*  state = State::get();
@@ -68,6 +69,28 @@ void TendingDef::running::no_task::on_enter(Event const&&, FSM& fsm) const {
     guard::height::spraying_tending spraying_tending_height;
     guard::height::cleaning         cleaning_height;
 
+    // heights are checked again on their level change instead of polling
+    std::mutex height_mutex;
+    bool       height_changed = false;
+
+    const auto on_height_change = [state, &height_mutex, &height_changed](
+                                      const device::digital::Event&) {
+      {
+        std::lock_guard<std::mutex> lock(height_mutex);
+        height_changed = true;
+      }
+      state->signal().notify_all();
+    };
+
+    auto* input_registry = device::DigitalInputDeviceRegistry::get();
+
+    const auto spraying_tending_height_subscription =
+        input_registry->get(device::id::comm::plc::spraying_tending_height())
+            ->subscribe(on_height_change);
+    const auto cleaning_height_subscription =
+        input_registry->get(device::id::comm::plc::cleaning_height())
+            ->subscribe(on_height_change);
+
     while (state->running() && !root_machine(fsm).is_terminated() &&
            !state->fault()) {
       if (spraying_tending_height.check() && !state->fault()) {
@@ -95,7 +118,18 @@ void TendingDef::running::no_task::on_enter(Event const&&, FSM& fsm) const {
         // root_machine(fsm).fault();
         return;
       } else {
-        sleep_for<time_units::millis>(500);
+        const bool tending_complete = state->tending_complete();
+
+        // state changes are not notified under height mutex, so heights are
+        // checked again after the old poll period even without a wake-up
+        std::unique_lock<std::mutex> lock(height_mutex);
+        state->signal().wait_for(
+            lock, std::chrono::milliseconds(500),
+            [&fsm, state, &height_changed, tending_complete] {
+              return !state->running() || root_machine(fsm).is_terminated() ||
+                     state->fault() || std::exchange(height_changed, false) ||
+                     state->tending_complete() != tending_complete;
+            });
       }
     }
   });
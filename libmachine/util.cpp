@@ -49,10 +49,13 @@ void reset_task_ready() {
   // auto* state = State::get();
   auto* shift_register = device::ShiftRegister::get();
 
-  shift_register->write(device::id::comm::pi::spraying_ready(),
-                        device::digital::value::high);
-  shift_register->write(device::id::comm::pi::tending_ready(),
-                        device::digital::value::high);
+  // both tasks are ready at the same latch
+  auto transaction = shift_register->transaction();
+  transaction.write(device::id::comm::pi::spraying_ready(),
+                    device::digital::value::high);
+  transaction.write(device::id::comm::pi::tending_ready(),
+                    device::digital::value::high);
+  transaction.commit();
 
   // state->spraying_ready(true);
   // state->tending_ready(true);
@@ -70,12 +73,14 @@ void reset_spraying() {
   //                       device::digital::value::low);
   // state->spraying_ready(false);
 
-  shift_register->write(device::id::comm::pi::spraying_running(),
-                        device::digital::value::low);
-  state->spraying_running(false);
+  auto transaction = shift_register->transaction();
+  transaction.write(device::id::comm::pi::spraying_running(),
+                    device::digital::value::low);
+  transaction.write(device::id::comm::pi::spraying_complete(),
+                    device::digital::value::low);
+  transaction.commit();
 
-  shift_register->write(device::id::comm::pi::spraying_complete(),
-                        device::digital::value::low);
+  state->spraying_running(false);
   state->spraying_complete(false);
 }
 
@@ -90,12 +95,14 @@ void reset_tending() {
   //                       device::digital::value::low);
   // state->tending_ready(false);
 
-  shift_register->write(device::id::comm::pi::tending_running(),
-                        device::digital::value::low);
-  state->tending_running(false);
+  auto transaction = shift_register->transaction();
+  transaction.write(device::id::comm::pi::tending_running(),
+                    device::digital::value::low);
+  transaction.write(device::id::comm::pi::tending_complete(),
+                    device::digital::value::low);
+  transaction.commit();
 
-  shift_register->write(device::id::comm::pi::tending_complete(),
-                        device::digital::value::low);
+  state->tending_running(false);
   state->tending_complete(false);
 }
 
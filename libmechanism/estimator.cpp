@@ -0,0 +1,145 @@
+#include "mechanism.hpp"
+
+#include "estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+Estimator::Estimator() {
+  axes_.fill({device::stepper::Kinematics{}, device::stepper::speed::linear,
+              1});
+}
+
+estimator::Axis Estimator::axis(const config::Speed&          speed,
+                                const device::stepper::speed& mode,
+                                const device::stepper::step&  steps_per_mm,
+                                const device::stepper::step&  microsteps,
+                                const device::stepper::step&  motor_steps) {
+  massert(steps_per_mm > 0, "sanity");
+
+  return {device::stepper::Kinematics(speed.rpm, speed.acceleration,
+                                      speed.deceleration, speed.jerk,
+                                      microsteps, motor_steps),
+          mode, steps_per_mm};
+}
+
+device::stepper::speed Estimator::speed_mode(const std::string& mode) {
+  if (mode == "scurve") {
+    return device::stepper::speed::scurve;
+  } else if (mode == "constant") {
+    return device::stepper::speed::constant;
+  }
+
+  return device::stepper::speed::linear;
+}
+
+void Estimator::axes(const estimator::Axis& x,
+                     const estimator::Axis& y,
+                     const estimator::Axis& z) {
+  massert(x.kinematics.cruise_rate > 0, "sanity");
+  massert(y.kinematics.cruise_rate > 0, "sanity");
+  massert(z.kinematics.cruise_rate > 0, "sanity");
+  axes_ = {x, y, z};
+}
+
+void Estimator::axes(const config::MechanismSpeed& speed) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  axes(axis(speed.x, speed_mode(config->stepper_x<std::string>("speed-mode")),
+            config->stepper_x<device::stepper::step>("steps-per-mm"),
+            config->stepper_x<device::stepper::step>("microsteps"),
+            config->stepper_x<device::stepper::step>("motor-steps")),
+       axis(speed.y, speed_mode(config->stepper_y<std::string>("speed-mode")),
+            config->stepper_y<device::stepper::step>("steps-per-mm"),
+            config->stepper_y<device::stepper::step>("microsteps"),
+            config->stepper_y<device::stepper::step>("motor-steps")),
+       axis(speed.z, speed_mode(config->stepper_z<std::string>("speed-mode")),
+            config->stepper_z<device::stepper::step>("steps-per-mm"),
+            config->stepper_z<device::stepper::step>("microsteps"),
+            config->stepper_z<device::stepper::step>("motor-steps")));
+}
+
+estimator::Move Estimator::move(const motion::position& steps) const {
+  estimator::Move result{};
+
+  // every axis is slowed down to the time needed by the slowest axis, same
+  // as MotionExecutor
+  time_unit move_time = 0;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    move_time = std::max(
+        move_time, device::stepper::plan(axes_[axis].kinematics,
+                                         axes_[axis].speed, steps[axis])
+                       .duration());
+  }
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (steps[axis] == 0) {
+      continue;
+    }
+
+    result.axes[axis] =
+        device::stepper::plan(axes_[axis].kinematics, axes_[axis].speed,
+                              steps[axis], move_time);
+    result.duration = std::max(result.duration, result.axes[axis].duration());
+  }
+
+  return result;
+}
+
+estimator::Move Estimator::move(const planner::position& from,
+                                const planner::position& to) const {
+  // difference of absolute step positions, same as Movement::move
+  const auto steps = [this, &from, &to](std::size_t axis) {
+    const auto spm = static_cast<double>(axes_[axis].steps_per_mm);
+    return std::lround(to[axis] * spm) - std::lround(from[axis] * spm);
+  };
+
+  return move({steps(0), steps(1), steps(2)});
+}
+
+time_unit Estimator::reach(const device::stepper::Profile& profile,
+                           device::stepper::step           steps) {
+  const auto& p = profile;
+
+  if (steps <= 0) {
+    return 0;
+  } else if (steps >= p.steps) {
+    return p.duration();
+  }
+
+  // distance grows with t^2 on both ramps
+  const auto ramp = [](time_unit time, double ratio) {
+    return static_cast<time_unit>(
+        std::lround(static_cast<double>(time) * std::sqrt(ratio)));
+  };
+
+  if (steps <= p.steps_to_cruise) {
+    return ramp(p.accelerate, static_cast<double>(steps) /
+                                  static_cast<double>(p.steps_to_cruise));
+  }
+
+  const device::stepper::step brake_start = p.steps - p.steps_to_brake;
+
+  if (steps <= brake_start) {
+    const auto cruise_steps = brake_start - p.steps_to_cruise;
+    return p.accelerate +
+           ((cruise_steps > 0)
+                ? p.cruise *
+                      static_cast<time_unit>(steps - p.steps_to_cruise) /
+                      static_cast<time_unit>(cruise_steps)
+                : 0);
+  }
+
+  return p.duration() -
+         ramp(p.decelerate, static_cast<double>(p.steps - steps) /
+                                static_cast<double>(p.steps_to_brake));
+}
+}  // namespace mechanism
+
+NAMESPACE_END
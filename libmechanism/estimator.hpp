@@ -0,0 +1,171 @@
+#ifndef LIB_MECHANISM_ESTIMATOR_HPP_
+#define LIB_MECHANISM_ESTIMATOR_HPP_
+
+/** @file estimator.hpp
+ *  @brief Move time estimator class definition
+ *
+ * Side-effect-free estimation of move duration and axis timelines
+ */
+
+#include <array>
+#include <string>
+
+#include <libutil/util.hpp>
+
+#include <libcore/core.hpp>
+
+#include <libdevice/device.hpp>
+
+#include "motion.hpp"
+#include "planner.hpp"
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+class Estimator;
+
+namespace estimator {
+/**
+ * @brief Axis parameters
+ *
+ * Everything needed to plan a move of single axis without a stepper device
+ */
+struct Axis {
+  /**
+   * Precomputed kinematics
+   */
+  device::stepper::Kinematics kinematics;
+  /**
+   * Speed mode
+   */
+  device::stepper::speed speed;
+  /**
+   * Conversion of mm to steps
+   */
+  device::stepper::step steps_per_mm;
+};
+
+/**
+ * @brief Estimated move
+ *
+ * Duration of synchronized move and the timeline of each axis
+ */
+struct Move {
+  /**
+   * Duration of move (us)
+   */
+  time_unit duration;
+  /**
+   * Speed profile of each axis, empty if the axis does not move
+   */
+  std::array<device::stepper::Profile, 3> axes;
+};
+}  // namespace estimator
+
+/**
+ * @brief Move time estimator.
+ *
+ * Plans synchronized moves the same way as MotionExecutor (every axis is
+ * slowed down to the time of the slowest axis), but only from kinematics,
+ * so no stepper is touched and it can run offline from configuration.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Estimator : public StackObj {
+ public:
+  /**
+   * Estimator Constructor
+   */
+  Estimator();
+  /**
+   * Estimator Destructor
+   */
+  ~Estimator() = default;
+  /**
+   * Create axis parameters from speed configuration
+   *
+   * @param speed        speed configuration of the axis
+   * @param mode         speed mode of the stepper
+   * @param steps_per_mm conversion of mm to steps
+   * @param microsteps   stepper microsteps
+   * @param motor_steps  motor steps per revolution
+   *
+   * @return axis parameters
+   */
+  static estimator::Axis axis(const config::Speed&          speed,
+                              const device::stepper::speed& mode,
+                              const device::stepper::step&  steps_per_mm,
+                              const device::stepper::step&  microsteps,
+                              const device::stepper::step&  motor_steps);
+  /**
+   * Get speed mode from configuration value
+   *
+   * @param mode speed mode in key "speed-mode" of stepper
+   *
+   * @return speed mode, linear if it is unknown
+   */
+  static device::stepper::speed speed_mode(const std::string& mode);
+  /**
+   * Set parameters for all axes
+   *
+   * @param x parameters of x-axis
+   * @param y parameters of y-axis
+   * @param z parameters of z-axis
+   */
+  void axes(const estimator::Axis& x,
+            const estimator::Axis& y,
+            const estimator::Axis& z);
+  /**
+   * Set parameters for all axes from speed profile and stepper configuration
+   *
+   * Same parameters as the steppers that are set up with the speed profile
+   *
+   * @param speed speed profile of every axis
+   */
+  void axes(const config::MechanismSpeed& speed);
+  /**
+   * Estimate synchronized move
+   *
+   * @param steps steps to take for each axis
+   *
+   * @return estimated move
+   */
+  estimator::Move move(const motion::position& steps) const;
+  /**
+   * Estimate synchronized move between absolute positions
+   *
+   * @param from start position (mm)
+   * @param to   target position (mm)
+   *
+   * @return estimated move
+   */
+  estimator::Move move(const planner::position& from,
+                       const planner::position& to) const;
+  /**
+   * Estimate time when axis has taken given steps of its move
+   *
+   * Used for moves that are halted by an input before they finish. Ramps
+   * are taken as constant acceleration, so it is approximate for s-curve
+   * speed
+   *
+   * @param profile speed profile of the axis
+   * @param steps   steps taken
+   *
+   * @return elapsed time since start of the move (us)
+   */
+  static time_unit reach(const device::stepper::Profile& profile,
+                         device::stepper::step           steps);
+
+ private:
+  /**
+   * Parameters of each axis
+   */
+  std::array<estimator::Axis, 3> axes_;
+};
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_ESTIMATOR_HPP_
@@ -6,6 +6,8 @@
 
 #include "liquid-refilling.hpp"
 #include "movement.hpp"
+#include "plan-cache.hpp"
+#include "route.hpp"
 
 NAMESPACE_BEGIN
 
@@ -57,6 +59,27 @@ static ATM_STATUS initialize_movement_mechanism() {
   massert(movement_mechanism() != nullptr, "sanity");
   massert(movement_mechanism()->active(), "sanity");
 
+  status = Route::create();
+
+  if (status == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  massert(Route::get() != nullptr, "sanity");
+
+  Route::get()->optimize();
+
+  // plans follow the visiting order of route optimizer
+  status = PlanCache::create();
+
+  if (status == ATM_ERR) {
+    return ATM_ERR;
+  }
+
+  massert(PlanCache::get() != nullptr, "sanity");
+
+  PlanCache::get()->prepare();
+
   status = LiquidRefilling::create();
 
   if (status == ATM_ERR) {
@@ -0,0 +1,278 @@
+#include "mechanism.hpp"
+
+#include "interpolator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <libutil/util.hpp>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+Interpolator::Interpolator()
+    : master_{nullptr},
+      use_profile_{false},
+      entry_rate_{0},
+      cruise_rate_{0},
+      exit_rate_{0},
+      acceleration_{0},
+      accel_steps_{0},
+      decel_steps_{0},
+      last_move_end_{0},
+      next_move_interval_{0},
+      last_pulse_{0} {
+  axes_.reserve(3);
+}
+
+Interpolator::~Interpolator() {}
+
+void Interpolator::reset() {
+  axes_.clear();
+  master_ = nullptr;
+  use_profile_ = false;
+}
+
+void Interpolator::add_axis(
+    const std::shared_ptr<device::StepperDevice>& stepper,
+    const device::stepper::step&                  steps) {
+  massert(stepper != nullptr, "sanity");
+
+  if (steps == 0) {
+    return;
+  }
+
+  axes_.push_back({stepper, std::abs(steps), 0, false, false, 0, 0});
+}
+
+void Interpolator::profile(const interpolator::Profile& profile) {
+  massert(profile.cruise_rate > 0.0, "sanity");
+  massert(profile.acceleration > 0.0, "sanity");
+
+  use_profile_ = true;
+  entry_rate_ = util::fixed::from_double(profile.entry_rate);
+  cruise_rate_ = util::fixed::from_double(profile.cruise_rate);
+  exit_rate_ = util::fixed::from_double(profile.exit_rate);
+  acceleration_ = std::max<std::int64_t>(std::llround(profile.acceleration), 1);
+}
+
+void Interpolator::start(bool blend) {
+  master_ = nullptr;
+
+  for (auto& axis : axes_) {
+    if (master_ == nullptr || axis.steps > master_->steps) {
+      master_ = &axis;
+    }
+  }
+
+  if (master_ == nullptr) {
+    last_move_end_ = 0;
+    next_move_interval_ = 0;
+    return;
+  }
+
+  bank_.clear();
+
+  for (auto& axis : axes_) {
+    // start from the middle to distribute steps evenly
+    axis.error = master_->steps / 2;
+    axis.due = false;
+    axis.stepper->write_direction(bank_);
+  }
+
+  // DIR pin is sampled on rising STEP edge, so every direction is written
+  // at once before the first step
+  bank_.write();
+
+  if (use_profile_) {
+    // rates squared are Q32, 2A * steps is shifted to Q32 as well
+    constexpr int q32 = 2 * util::fixed::frac_bits;
+
+    const std::int64_t steps = master_->steps;
+    const std::int64_t a2 = 2 * acceleration_;
+    const std::int64_t entry2 = entry_rate_ * entry_rate_;
+    const std::int64_t exit2 = exit_rate_ * exit_rate_;
+    const std::int64_t cruise2 = cruise_rate_ * cruise_rate_;
+
+    std::int64_t accel_steps = ((cruise2 - entry2) / a2) >> q32;
+    std::int64_t decel_steps = ((cruise2 - exit2) / a2) >> q32;
+
+    if (accel_steps + decel_steps > steps) {
+      // cannot reach cruise speed, meet in the middle
+      accel_steps = steps / 2 + (((exit2 - entry2) / (2 * a2)) >> q32);
+      accel_steps = std::clamp<std::int64_t>(accel_steps, 0, steps);
+      decel_steps = steps - accel_steps;
+    }
+
+    accel_steps_ = static_cast<device::stepper::step>(accel_steps);
+    decel_steps_ = static_cast<device::stepper::step>(decel_steps);
+  }
+
+  if (blend && last_move_end() > 0 && use_profile_ && entry_rate_ > 0) {
+    // keep the timeline of previous move
+    next_move_interval_ = profile_pulse(0);
+  } else {
+    last_move_end_ = 0;
+    next_move_interval_ = 1;
+  }
+}
+
+time_unit Interpolator::profile_pulse(
+    const device::stepper::step& step_count) const {
+  const std::int64_t            a2 = 2 * acceleration_;
+  const device::stepper::step remaining = master_->steps - step_count;
+
+  util::fixed::q16 rate = cruise_rate_;
+
+  // v^2 = v0^2 + 2as, evaluated in Q16 with integer square root
+  if (step_count < accel_steps_) {
+    rate = util::fixed::sqrt(util::fixed::mul(entry_rate_, entry_rate_) +
+                             util::fixed::from_int(a2 * (step_count + 1)));
+  } else if (remaining <= decel_steps_) {
+    rate = util::fixed::sqrt(
+        util::fixed::mul(exit_rate_, exit_rate_) +
+        util::fixed::from_int(a2 * std::max<std::int64_t>(remaining, 1)));
+  }
+
+  rate = std::clamp<util::fixed::q16>(rate, 1, cruise_rate_);
+
+  return static_cast<time_unit>(
+      (std::int64_t{1000000} << util::fixed::frac_bits) / rate);
+}
+
+void Interpolator::record_timing(time_unit tick, time_unit deadline) {
+  const time_unit overrun = (tick > deadline) ? tick - deadline : 0;
+
+  for (auto& axis : axes_) {
+    if (axis.halted) {
+      continue;
+    }
+
+    if (axis.last_step == 0) {
+      // first step of the axis in current move
+      if (axis.due) {
+        axis.last_step = tick;
+      }
+      continue;
+    }
+
+    axis.scheduled += last_pulse_;
+
+    if (axis.due) {
+      axis.stepper->record_timing(axis.scheduled, tick - axis.last_step,
+                                  overrun);
+      axis.last_step = tick;
+      axis.scheduled = 0;
+    }
+  }
+}
+
+void Interpolator::halt_axis(const device::StepperDevice* stepper) {
+  for (auto& axis : axes_) {
+    if (axis.stepper.get() != stepper || axis.halted) {
+      continue;
+    }
+
+    axis.halted = true;
+    axis.due = false;
+
+    if (&axis != master_) {
+      [[maybe_unused]] auto remaining = axis.stepper->stop();
+    }
+  }
+}
+
+bool Interpolator::ready() const {
+  if (master_ == nullptr) {
+    return true;
+  }
+
+  if (!master_->halted) {
+    return master_->stepper->remaining_steps() <= 0;
+  }
+
+  // halted master keeps the timeline for the rest of the axes
+  return std::none_of(axes_.begin(), axes_.end(), [](const auto& axis) {
+    return !axis.halted && axis.stepper->remaining_steps() > 0;
+  });
+}
+
+time_unit Interpolator::next() {
+  if (ready()) {
+    last_move_end_ = 0;
+    next_move_interval_ = 0;
+    return next_move_interval();
+  }
+
+  // sleep until just before the shared deadline, then spin
+  const time_unit deadline = last_move_end() + next_move_interval();
+  wait_until(deadline);
+
+  // execution time is accounted from the wake up
+  time_unit m = micros();
+
+  // distribute slave steps along master timeline
+  for (auto& axis : axes_) {
+    if (&axis == master_) {
+      axis.due = true;
+      continue;
+    }
+
+    axis.due = false;
+    axis.error -= axis.steps;
+    if (axis.error < 0) {
+      axis.error += master_->steps;
+      axis.due = axis.stepper->remaining_steps() > 0;
+    }
+  }
+
+  time_unit pulse;
+
+  if (use_profile_) {
+    master_->stepper->yield_step();
+    pulse = profile_pulse(master_->stepper->step_count());
+  } else {
+    // save value because yield_pulse() will calculate the next one
+    pulse = static_cast<time_unit>(master_->stepper->yield_pulse());
+  }
+
+  bank_.clear();
+  for (const auto& axis : axes_) {
+    if (axis.due && !axis.halted) {
+      axis.stepper->write_step(bank_, device::digital::value::high);
+    }
+  }
+
+  // start pulsing every due axis at once, in a single bank write
+  bank_.write();
+  // We should pull HIGH for at least 1-2us (step_high_min)
+  sleep_for<time_units::micros>(device::StepperDevice::step_high_min);
+  bank_.invert();
+  bank_.write();
+  // end of pulsing
+
+  for (auto& axis : axes_) {
+    if (axis.due && &axis != master_) {
+      axis.stepper->yield_step();
+    }
+  }
+
+  record_timing(m, deadline);
+  last_pulse_ = pulse;
+
+  // account for execution time
+  last_move_end_ = micros();
+  m = last_move_end() - m;
+
+  if (ready()) {
+    next_move_interval_ = 0;
+  } else {
+    next_move_interval_ = (pulse > m) ? pulse - m : 1;
+  }
+
+  return next_move_interval();
+}
+}  // namespace mechanism
+
+NAMESPACE_END
@@ -0,0 +1,264 @@
+#ifndef LIB_MECHANISM_INTERPOLATOR_HPP_
+#define LIB_MECHANISM_INTERPOLATOR_HPP_
+
+/** @file interpolator.hpp
+ *  @brief Multi-axis step interpolator class definition
+ *
+ * Coordinated multi-axis step distribution using Bresenham / DDA
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <libutil/util.hpp>
+
+#include <libcore/core.hpp>
+
+#include <libdevice/device.hpp>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+class Interpolator;
+
+namespace interpolator {
+/**
+ * @brief Interpolated axis
+ *
+ * Single axis that participates in interpolated move
+ */
+struct Axis {
+  /**
+   * Stepper device of the axis
+   */
+  std::shared_ptr<device::StepperDevice> stepper;
+  /**
+   * Absolute steps to take in current move
+   */
+  device::stepper::step steps;
+  /**
+   * Bresenham error accumulator
+   */
+  device::stepper::step error;
+  /**
+   * Step is due in current tick
+   */
+  bool due;
+  /**
+   * Axis has been halted, no more pulses are generated for it
+   */
+  bool halted;
+  /**
+   * Timestamp of last step of the axis, 0 before the first step
+   */
+  time_unit last_step;
+  /**
+   * Scheduled time elapsed since last step of the axis (us)
+   */
+  time_unit scheduled;
+};
+
+/**
+ * @brief Master-axis speed profile
+ *
+ * Explicit trapezoid for master axis, used for blended moves from
+ * mechanism::Planner
+ */
+struct Profile {
+  /**
+   * Entry speed (steps / s)
+   */
+  double entry_rate;
+  /**
+   * Cruise speed (steps / s)
+   */
+  double cruise_rate;
+  /**
+   * Exit speed (steps / s)
+   */
+  double exit_rate;
+  /**
+   * Acceleration (steps / s^2)
+   */
+  double acceleration;
+};
+}  // namespace interpolator
+
+/**
+ * @brief Multi-axis step interpolator.
+ *
+ * Single master-axis timeline (axis with the most steps) drives the step
+ * timing using its speed profile, the other axes are distributed using
+ * Bresenham error accumulators. Every axis shares the same deadline, so
+ * multi-axis move is truly synchronous and the per-step overhead is
+ * constant regardless of the number of moving axes. Step pins of every due
+ * axis are toggled together with device::GpioBank.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Interpolator : public StackObj {
+ public:
+  /**
+   * Interpolator Constructor
+   */
+  Interpolator();
+  /**
+   * Interpolator Destructor
+   */
+  ~Interpolator();
+  /**
+   * Clear all axes from previous move
+   */
+  void reset();
+  /**
+   * Add axis to the next move
+   *
+   * Stepper should have been prepared with StepperDevice::start_move
+   *
+   * @param stepper stepper device
+   * @param steps   steps to take (sign is ignored)
+   */
+  void add_axis(const std::shared_ptr<device::StepperDevice>& stepper,
+                const device::stepper::step&                  steps);
+  /**
+   * Use explicit speed profile for master axis in the next move
+   *
+   * Without profile, master axis will follow its own speed profile. The
+   * profile is converted to fixed-point once, so every step is integer-only
+   *
+   * @param profile master-axis speed profile
+   */
+  void profile(const interpolator::Profile& profile);
+  /**
+   * Start interpolated move
+   *
+   * Will select master axis and write direction of every axis
+   *
+   * @param blend continue from the last step of previous move, so the first
+   * step waits for the entry speed instead of firing immediately
+   */
+  void start(bool blend = false);
+  /**
+   * Yield move for each master step
+   *
+   * Will wait until shared deadline and generate output to the stepper pins
+   * of every axis that is due
+   *
+   * @return time until next change is needed, 0 when move is finished
+   */
+  time_unit next();
+  /**
+   * Halt single axis, every other axis keeps moving
+   *
+   * Halted master axis keeps driving the timeline without pulsing, so the
+   * speed of other axes does not change
+   *
+   * @param stepper stepper device of the axis
+   */
+  void halt_axis(const device::StepperDevice* stepper);
+  /**
+   * Get status of interpolated move
+   *
+   * @return move is finished or not, true once every axis is halted
+   */
+  bool ready() const;
+  /**
+   * Get master axis
+   *
+   * @return pointer of master axis, nullptr if no axis
+   */
+  inline const interpolator::Axis* master() const { return master_; }
+  /**
+   * Get timestamp of ending of last move
+   *
+   * @return time of last move end
+   */
+  inline const time_unit& last_move_end() const { return last_move_end_; }
+  /**
+   * Get timestamp of ending of last action
+   *
+   * @return next move interval time
+   */
+  inline const time_unit& next_move_interval() const {
+    return next_move_interval_;
+  }
+
+ private:
+  /**
+   * Calculate master-axis pulse from explicit speed profile
+   *
+   * @param step_count steps that have been taken by master axis
+   *
+   * @return pulse interval (us) until next step is due
+   */
+  time_unit profile_pulse(const device::stepper::step& step_count) const;
+  /**
+   * Record step timing of every due axis to its stepper
+   *
+   * @param tick     timestamp of current tick
+   * @param deadline scheduled timestamp of current tick
+   */
+  void record_timing(time_unit tick, time_unit deadline);
+
+ private:
+  /**
+   * Axes of current move
+   */
+  std::vector<interpolator::Axis> axes_;
+  /**
+   * Master axis, axis with the most steps
+   */
+  interpolator::Axis* master_;
+  /**
+   * Explicit master-axis speed profile is used or not
+   */
+  bool use_profile_;
+  /**
+   * Entry rate of explicit speed profile (Q16.16 steps / s)
+   */
+  util::fixed::q16 entry_rate_;
+  /**
+   * Cruise rate of explicit speed profile (Q16.16 steps / s)
+   */
+  util::fixed::q16 cruise_rate_;
+  /**
+   * Exit rate of explicit speed profile (Q16.16 steps / s)
+   */
+  util::fixed::q16 exit_rate_;
+  /**
+   * Acceleration of explicit speed profile (steps / s^2)
+   */
+  std::int64_t acceleration_;
+  /**
+   * Master steps to accelerate with explicit speed profile
+   */
+  device::stepper::step accel_steps_;
+  /**
+   * Master steps to decelerate with explicit speed profile
+   */
+  device::stepper::step decel_steps_;
+  /**
+   * GPIO bank to write step and direction pins of every axis at once
+   */
+  device::GpioBank bank_;
+  /**
+   * Timestamp of ending of last move
+   */
+  time_unit last_move_end_;
+  /**
+   * Next move interval
+   */
+  time_unit next_move_interval_;
+  /**
+   * Scheduled pulse interval of last tick (us)
+   */
+  time_unit last_pulse_;
+};
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_INTERPOLATOR_HPP_
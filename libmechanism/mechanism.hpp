@@ -9,10 +9,14 @@
  */
 
 // 1. STL
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 // 2. Vendor
 
@@ -29,6 +33,16 @@
 #include "init.hpp"
 
 // 4.1. Movement Mechanism
+#include "interpolator.hpp"
+#include "planner.hpp"
+
+#include "motion.hpp"
+
+#include "estimator.hpp"
+
+#include "route.hpp"
+#include "plan-cache.hpp"
+
 #include "movement.hpp"
 #include "movement.inline.hpp"
 
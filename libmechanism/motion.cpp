@@ -0,0 +1,492 @@
+#include "mechanism.hpp"
+
+#include "motion.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#include <libutil/util.hpp>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+/**
+ * Get coarse stepping divisor of the command
+ *
+ * @param command command
+ *
+ * @return divisor, 1 for native microsteps
+ */
+static device::stepper::step step_divisor(const motion::Command& command) {
+  return std::max<device::stepper::step>(command.divisor, 1);
+}
+
+/**
+ * Convert block command with coarse stepping to native microsteps
+ *
+ * @param command block command with coarse stepping divisor
+ *
+ * @return the same block command with native microsteps
+ */
+static motion::Command refine(const motion::Command& command) {
+  const auto      scale = static_cast<double>(step_divisor(command));
+  motion::Command result = command;
+
+  for (auto& steps : result.steps) {
+    steps *= step_divisor(command);
+  }
+
+  result.profile.entry_rate *= scale;
+  result.profile.cruise_rate *= scale;
+  result.profile.exit_rate *= scale;
+  result.profile.acceleration *= scale;
+  result.divisor = 1;
+
+  return result;
+}
+
+MotionExecutor::MotionExecutor()
+    : last_id_{0},
+      signal_{0},
+      completed_{0},
+      aborted_{0},
+      halted_{0},
+      running_{false},
+      options_{-1, 0, false} {
+  halted_steps_.fill(-1);
+  divisors_.fill(1);
+  for (auto* counters : {&counters_, &move_origin_, &move_target_}) {
+    for (auto& counter : *counters) {
+      counter.store(0);
+    }
+  }
+  for (auto& id : withdrawn_) {
+    id.store(0);
+  }
+}
+
+MotionExecutor::~MotionExecutor() {
+  shutdown();
+}
+
+void MotionExecutor::steppers(
+    const std::shared_ptr<device::StepperDevice>& x,
+    const std::shared_ptr<device::StepperDevice>& y,
+    const std::shared_ptr<device::StepperDevice>& z) {
+  massert(!running(), "sanity");
+  steppers_ = {x, y, z};
+}
+
+ATM_STATUS MotionExecutor::start(const motion::Options& options) {
+  if (running()) {
+    return ATM_ERR;
+  }
+
+  for (const auto& stepper : steppers_) {
+    if (!stepper) {
+      return ATM_ERR;
+    }
+  }
+
+  options_ = options;
+  running_ = true;
+  thread_ = std::thread(&MotionExecutor::run, this);
+
+  return ATM_OK;
+}
+
+void MotionExecutor::shutdown() {
+  if (!running()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    aborted_.store(last_id_.load(), std::memory_order_release);
+    running_.store(false, std::memory_order_release);
+  }
+
+  signal_.fetch_add(1, std::memory_order_release);
+  signal_.notify_one();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+motion::sequence MotionExecutor::submit(motion::Command command) {
+  std::lock_guard<std::mutex> lock(producer_mutex_);
+
+  command.id = last_id_.load(std::memory_order_relaxed) + 1;
+
+  while (!queue_.push(command)) {
+    // motion thread is draining the queue
+    std::this_thread::yield();
+  }
+
+  last_id_.store(command.id, std::memory_order_release);
+
+  signal_.fetch_add(1, std::memory_order_release);
+  signal_.notify_one();
+
+  return command.id;
+}
+
+motion::sequence MotionExecutor::stop() {
+  motion::Command command{};
+  command.type = motion::command::stop;
+
+  std::lock_guard<std::mutex> lock(producer_mutex_);
+
+  command.id = last_id_.load(std::memory_order_relaxed) + 1;
+  // cancel current and queued commands before the stop is queued, so the
+  // queue is drained without stepping
+  aborted_.store(command.id, std::memory_order_release);
+
+  while (!queue_.push(command)) {
+    std::this_thread::yield();
+  }
+
+  last_id_.store(command.id, std::memory_order_release);
+
+  signal_.fetch_add(1, std::memory_order_release);
+  signal_.notify_one();
+
+  return command.id;
+}
+
+void MotionExecutor::cancel(motion::sequence id) {
+  // only moves forward, so a late cancel of a completed command never
+  // overwrites the command in flight that shares its slot
+  auto&            slot = withdrawn_[id % motion::in_flight];
+  motion::sequence withdrawn = slot.load(std::memory_order_relaxed);
+  while (withdrawn < id &&
+         !slot.compare_exchange_weak(withdrawn, id, std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+    // withdrawn is reloaded by failed exchange
+  }
+}
+
+void MotionExecutor::cancel_until(motion::sequence id) {
+  // only moves forward, so a later cancel or stop is never undone
+  motion::sequence aborted = aborted_.load(std::memory_order_relaxed);
+  while (aborted < id &&
+         !aborted_.compare_exchange_weak(aborted, id,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    // aborted is reloaded by failed exchange
+  }
+}
+
+bool MotionExecutor::cancelled(motion::sequence id) const {
+  return id <= aborted_.load(std::memory_order_acquire) ||
+         withdrawn_[id % motion::in_flight].load(std::memory_order_acquire) ==
+             id;
+}
+
+bool MotionExecutor::completed(motion::sequence id) const {
+  return !running() || completed_.load(std::memory_order_acquire) >= id;
+}
+
+bool MotionExecutor::idle() const {
+  return completed_.load(std::memory_order_acquire) >=
+         last_id_.load(std::memory_order_acquire);
+}
+
+motion::sequence MotionExecutor::halted() const {
+  return halted_.load(std::memory_order_acquire);
+}
+
+float MotionExecutor::progress() const {
+  float remainder = 0.0f;
+  float percentage = 0.0f;
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    const auto origin = move_origin_[axis].load(std::memory_order_acquire);
+    const auto target = move_target_[axis].load(std::memory_order_acquire);
+    if (origin == target) {
+      continue;
+    }
+
+    const auto done =
+        static_cast<float>(counters_[axis].load(std::memory_order_acquire) -
+                           origin) /
+        static_cast<float>(target - origin);
+    if (done < 1.0f) {
+      remainder += 1.0f;
+      percentage += std::max(done, 0.0f);
+    }
+  }
+
+  return (remainder == 0.0f) ? 1.0f : percentage / remainder;
+}
+
+void MotionExecutor::run() {
+  setup_realtime();
+
+  motion::Command command{};
+
+  while (true) {
+    const auto signal = signal_.load(std::memory_order_acquire);
+
+    if (queue_.pop(command)) {
+      execute(command);
+      continue;
+    }
+
+    if (!running_.load(std::memory_order_acquire)) {
+      break;
+    }
+
+    // sleep until next submit
+    signal_.wait(signal, std::memory_order_acquire);
+  }
+}
+
+void MotionExecutor::setup_realtime() const {
+#if defined(__linux__)
+  if (options_.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    LOG_WARN("Cannot lock memory of motion thread: {}", std::strerror(errno));
+  }
+
+  if (options_.cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(options_.cpu, &cpus);
+    if (const int error =
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        error != 0) {
+      LOG_WARN("Cannot pin motion thread to CPU {}: {}", options_.cpu,
+               std::strerror(error));
+    }
+  }
+
+  if (options_.priority > 0) {
+    sched_param param{};
+    param.sched_priority =
+        std::clamp(options_.priority, sched_get_priority_min(SCHED_FIFO),
+                   sched_get_priority_max(SCHED_FIFO));
+    if (const int error =
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        error != 0) {
+      LOG_WARN("Cannot run motion thread with SCHED_FIFO: {}",
+               std::strerror(error));
+    }
+  }
+#else
+  LOG_WARN("Real-time motion thread is only supported on Linux");
+#endif
+
+  LOG_INFO("Motion thread is started, cpu={} priority={} lock-memory={}",
+           options_.cpu, options_.priority, options_.lock_memory);
+}
+
+void MotionExecutor::execute(const motion::Command& command) {
+  if (command.type == motion::command::stop) {
+    halt();
+    complete(command.id);
+    return;
+  }
+
+  // never cancelled, so the steppers keep the speed of the last profile
+  if (command.type == motion::command::profile) {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      steppers_[axis]->rpm(command.speed[axis].rpm);
+      steppers_[axis]->acceleration(command.speed[axis].acceleration);
+      steppers_[axis]->deceleration(command.speed[axis].deceleration);
+      steppers_[axis]->jerk(command.speed[axis].jerk);
+    }
+    complete(command.id);
+    return;
+  }
+
+  if (cancelled(command.id)) {
+    // cancelled while queued
+    complete(command.id);
+    return;
+  }
+
+  const std::array<std::int64_t, 3> origin{
+      counters_[0].load(std::memory_order_relaxed),
+      counters_[1].load(std::memory_order_relaxed),
+      counters_[2].load(std::memory_order_relaxed)};
+
+  if (command.absolute) {
+    motion::Command relative = command;
+    relative.absolute = false;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      relative.steps[axis] = static_cast<device::stepper::step>(
+          command.steps[axis] - origin[axis]);
+    }
+    execute(relative);
+    return;
+  }
+
+  if (step_divisor(command) > 1 && !aligned(command, origin)) {
+    // position would drift, take the same block with native microsteps
+    execute(refine(command));
+    return;
+  }
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    move_origin_[axis].store(origin[axis], std::memory_order_relaxed);
+    move_target_[axis].store(
+        origin[axis] + command.steps[axis] * step_divisor(command),
+        std::memory_order_release);
+  }
+
+  start_move(command);
+
+  while (!interpolator_.ready()) {
+    if (cancelled(command.id)) {
+      halt();
+      break;
+    }
+
+    // each input halts only its own axis
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      if (command.until[axis] != nullptr && halted_steps_[axis] < 0 &&
+          command.until[axis]->read().value_or(device::digital::value::low) ==
+              device::digital::value::high) {
+        halted_steps_[axis] = steppers_[axis]->step_count();
+        interpolator_.halt_axis(steppers_[axis].get());
+        halted_.store(command.id, std::memory_order_release);
+      }
+    }
+
+    if (interpolator_.ready()) {
+      break;
+    }
+
+    interpolator_.next();
+    publish(command, origin);
+  }
+
+  publish(command, origin);
+  complete(command.id);
+}
+
+void MotionExecutor::start_move(const motion::Command& command) {
+  const auto& steps = command.steps;
+
+  interpolator_.reset();
+  halted_steps_.fill(-1);
+
+  // MS pins are switched between two pulses, while every moving axis is at a
+  // full-step boundary, see MotionExecutor::aligned
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (steps[axis] != 0) {
+      resolution(axis, step_divisor(command));
+    }
+  }
+
+  if (command.type == motion::command::block) {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      if (steps[axis] != 0) {
+        steppers_[axis]->start_move(steps[axis]);
+        interpolator_.add_axis(steppers_[axis], steps[axis]);
+      }
+    }
+
+    interpolator_.profile(command.profile);
+    interpolator_.start(command.blend);
+    return;
+  }
+
+  // master axis drives the timeline, so it has to be slowed down to the
+  // time needed by the slowest axis
+  time_unit move_time = 0;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    move_time = std::max(move_time,
+                         steppers_[axis]->time_for_move(std::abs(steps[axis])));
+  }
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (steps[axis] != 0) {
+      steppers_[axis]->start_move(steps[axis], static_cast<long>(move_time));
+      interpolator_.add_axis(steppers_[axis], steps[axis]);
+    }
+  }
+
+  interpolator_.start();
+}
+
+void MotionExecutor::halt() {
+  for (const auto& stepper : steppers_) {
+    [[maybe_unused]] auto remaining = stepper->stop();
+  }
+
+  // coarse pulses only stop on a coarse step, so native microsteps are exact
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    resolution(axis, 1);
+  }
+}
+
+bool MotionExecutor::aligned(const motion::Command&             command,
+                             const std::array<std::int64_t, 3>& origin) const {
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (command.steps[axis] == 0) {
+      continue;
+    }
+
+    // step position is counted in native microsteps since the start, so a
+    // full step is a multiple of microsteps
+    const auto& stepper = steppers_[axis];
+    const auto& full_step = stepper->microsteps();
+    const std::int64_t end =
+        origin[axis] + command.steps[axis] * step_divisor(command);
+
+    if (!stepper->switchable() || full_step % step_divisor(command) != 0 ||
+        origin[axis] % full_step != 0 || end % full_step != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void MotionExecutor::resolution(std::size_t           axis,
+                                device::stepper::step divisor) {
+  if (divisors_[axis] == divisor) {
+    return;
+  }
+
+  const auto& stepper = steppers_[axis];
+  if (stepper->step_resolution(stepper->microsteps() / divisor)) {
+    divisors_[axis] = divisor;
+  }
+}
+
+void MotionExecutor::publish(const motion::Command&             command,
+                             const std::array<std::int64_t, 3>& origin) {
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (command.steps[axis] == 0) {
+      continue;
+    }
+
+    // halted master axis keeps counting without pulsing
+    const std::int64_t count = ((halted_steps_[axis] >= 0)
+                                    ? halted_steps_[axis]
+                                    : steppers_[axis]->step_count()) *
+                               step_divisor(command);
+    counters_[axis].store(
+        origin[axis] + ((command.steps[axis] > 0) ? count : -count),
+        std::memory_order_release);
+  }
+}
+
+void MotionExecutor::complete(motion::sequence id) {
+  completed_.store(id, std::memory_order_release);
+  completed_.notify_all();
+}
+}  // namespace mechanism
+
+NAMESPACE_END
@@ -0,0 +1,445 @@
+#ifndef LIB_MECHANISM_MOTION_HPP_
+#define LIB_MECHANISM_MOTION_HPP_
+
+/** @file motion.hpp
+ *  @brief Motion executor class definition
+ *
+ * Dedicated real-time thread that generates every step pulse
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <libutil/util.hpp>
+
+#include <libcore/core.hpp>
+
+#include <libalgo/algo.hpp>
+
+#include <libdevice/device.hpp>
+
+#include "interpolator.hpp"
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+class MotionExecutor;
+
+namespace motion {
+/**
+ * @var using sequence = std::uint64_t
+ * @brief Type definition for command sequence number, starts from 1
+ */
+using sequence = std::uint64_t;
+
+/**
+ * @var using position = std::array<device::stepper::step, 3>
+ * @brief Type definition for absolute step position of x, y, and z
+ */
+using position = std::array<device::stepper::step, 3>;
+
+/** Number of commands that can be queued */
+static constexpr std::size_t queue_capacity = 64;
+
+/** Number of commands that can be queued or running at the same time */
+static constexpr std::size_t in_flight = queue_capacity + 1;
+
+/**
+ * Command type
+ */
+enum class command {
+  /**
+   * Synchronized move, every axis finishes at the same time
+   */
+  move,
+  /**
+   * Planned block with explicit master-axis speed profile
+   */
+  block,
+  /**
+   * Halt the steppers
+   */
+  stop,
+  /**
+   * Change speed of the steppers, applied between two moves
+   */
+  profile,
+};
+
+/**
+ * @brief Motion executor options
+ *
+ * Loaded from "mechanisms.motion" key
+ */
+struct Options {
+  /**
+   * CPU to pin the thread, -1 to not pin
+   */
+  int cpu;
+  /**
+   * SCHED_FIFO priority (1-99), 0 to use default scheduler
+   */
+  int priority;
+  /**
+   * Lock current and future memory pages
+   */
+  bool lock_memory;
+};
+
+/**
+ * @brief Motion command
+ *
+ * Trivially copyable, so it can be passed through lock-free queue
+ */
+struct Command {
+  /**
+   * Command type
+   */
+  motion::command type;
+  /**
+   * Sequence number, assigned on submit
+   */
+  motion::sequence id;
+  /**
+   * Steps to take for x, y, and z (sign is direction)
+   */
+  motion::position steps;
+  /**
+   * Steps are the absolute step position to reach instead, so the move
+   * starts from wherever previous commands have ended. Only for
+   * motion::command::move
+   */
+  bool absolute;
+  /**
+   * Master-axis speed profile, only for motion::command::block
+   */
+  interpolator::Profile profile;
+  /**
+   * Continue from the last step of previous command, only for
+   * motion::command::block
+   */
+  bool blend;
+  /**
+   * Halt each axis as soon as its input reads high, nullptr to ignore, every
+   * other axis keeps moving
+   */
+  std::array<const device::DigitalInputDevice*, 3> until;
+  /**
+   * Coarse stepping divisor, steps and profile are in pulses of
+   * microsteps / divisor of every moving axis, 0 or 1 for native microsteps.
+   * Only for motion::command::block
+   */
+  device::stepper::step divisor;
+  /**
+   * Speed of x, y, and z, only for motion::command::profile
+   */
+  std::array<config::Speed, 3> speed;
+};
+}  // namespace motion
+
+/**
+ * @brief Motion executor.
+ *
+ * Single thread that owns the step interpolator. Other threads submit
+ * commands through a single-producer single-consumer ring buffer and observe
+ * completion and step position through atomics, so nothing on the stepping
+ * path takes a lock, allocates, or notifies a condition variable.
+ *
+ * Producers are serialized by a mutex, so any thread may submit while the
+ * ring buffer itself stays single-producer. The thread tries to run with
+ * SCHED_FIFO, pinned to a CPU, and with locked memory. Each of them is
+ * skipped with a warning if it is not permitted.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class MotionExecutor : public StackObj {
+ public:
+  /**
+   * MotionExecutor Constructor
+   */
+  MotionExecutor();
+  /**
+   * MotionExecutor Destructor
+   *
+   * Will shutdown the thread
+   */
+  ~MotionExecutor();
+  /**
+   * Set the stepper devices
+   *
+   * Must be called before start
+   *
+   * @param x stepper of x-axis
+   * @param y stepper of y-axis
+   * @param z stepper of z-axis
+   */
+  void steppers(const std::shared_ptr<device::StepperDevice>& x,
+                const std::shared_ptr<device::StepperDevice>& y,
+                const std::shared_ptr<device::StepperDevice>& z);
+  /**
+   * Start the motion thread
+   *
+   * @param options real-time options
+   *
+   * @return ATM_STATUS ATM_OK or ATM_ERR, but not both
+   */
+  ATM_STATUS start(const motion::Options& options);
+  /**
+   * Cancel every command and join the motion thread
+   */
+  void shutdown();
+  /**
+   * Submit command
+   *
+   * Thread-safe, will wait while the queue is full
+   *
+   * @param command command to execute
+   *
+   * @return sequence number of the command
+   */
+  motion::sequence submit(motion::Command command);
+  /**
+   * Cancel current and queued commands and halt the steppers
+   *
+   * Thread-safe
+   *
+   * @return sequence number of the stop command
+   */
+  motion::sequence stop();
+  /**
+   * Cancel single command
+   *
+   * Command is halted at its next step if it is running, or completed without
+   * stepping if it is queued. Every other command is not affected.
+   *
+   * Thread-safe and lock-free, so it can be called from stop callbacks
+   *
+   * @param id sequence number of the command
+   */
+  void cancel(motion::sequence id);
+  /**
+   * Cancel every command up to the sequence number
+   *
+   * Same as cancel() for each of them. Commands submitted later are not
+   * affected.
+   *
+   * Thread-safe and lock-free, so it can be called from stop callbacks
+   *
+   * @param id sequence number of the last command to cancel
+   */
+  void cancel_until(motion::sequence id);
+  /**
+   * Check command has been cancelled (by cancel, cancel_until, or stop)
+   *
+   * Single cancelled command is only remembered until the command that
+   * shares its slot is cancelled, which is submitted after it is completed
+   *
+   * @param id sequence number of the command
+   *
+   * @return cancelled or not
+   */
+  bool cancelled(motion::sequence id) const;
+  /**
+   * Get sequence number of the last submitted command
+   *
+   * @return sequence number, 0 if none
+   */
+  inline motion::sequence last() const {
+    return last_id_.load(std::memory_order_acquire);
+  }
+  /**
+   * Check command has been completed (finished, halted, or cancelled)
+   *
+   * @param id sequence number of the command
+   *
+   * @return completed or not, always true if thread is not running
+   */
+  bool completed(motion::sequence id) const;
+  /**
+   * Check every submitted command has been completed
+   *
+   * @return idle or not
+   */
+  bool idle() const;
+  /**
+   * Get sequence number of the last command that had any axis halted by its
+   * input
+   *
+   * @return sequence number, 0 if none
+   */
+  motion::sequence halted() const;
+  /**
+   * Get absolute step position of every axis
+   *
+   * Position is counted from the start of the thread and updated after
+   * every step without any lock, see StateImpl::track
+   *
+   * @return step position counters of x, y, and z
+   */
+  inline const StepCounters& counters() const { return counters_; }
+  /**
+   * Get progress of current command
+   *
+   * Derived from the published step position, so it can be called from any
+   * thread
+   *
+   * @return average fraction of the moving axes that has been stepped, 1 if
+   *         every axis is finished
+   */
+  float progress() const;
+  /**
+   * Check the motion thread is running or not
+   *
+   * @return running or not
+   */
+  inline bool running() const { return running_.load(); }
+
+ private:
+  /**
+   * Body of the motion thread
+   */
+  void run();
+  /**
+   * Apply real-time options to the calling thread
+   */
+  void setup_realtime() const;
+  /**
+   * Execute single command until it is finished
+   *
+   * @param command command to execute
+   */
+  void execute(const motion::Command& command);
+  /**
+   * Prepare the steppers and interpolator for a move
+   *
+   * @param command move or block command
+   */
+  void start_move(const motion::Command& command);
+  /**
+   * Halt every stepper
+   */
+  void halt();
+  /**
+   * Check that coarse stepping of the command keeps position exact
+   *
+   * Every moving axis has to switch its microstep resolution and start and
+   * end at a full-step boundary of the driver
+   *
+   * @param command block command with coarse stepping divisor
+   * @param origin  step position at the start of the command
+   *
+   * @return true if command can be executed with coarse stepping
+   */
+  bool aligned(const motion::Command&             command,
+               const std::array<std::int64_t, 3>& origin) const;
+  /**
+   * Switch microstep resolution of an axis
+   *
+   * @param axis    index of the axis
+   * @param divisor coarse stepping divisor, 1 for native microsteps
+   */
+  void resolution(std::size_t axis, device::stepper::step divisor);
+  /**
+   * Publish step position of every axis
+   *
+   * @param command current command
+   * @param origin  step position at the start of current command
+   */
+  void publish(const motion::Command&             command,
+               const std::array<std::int64_t, 3>& origin);
+  /**
+   * Mark command as completed and wake up the waiters
+   *
+   * @param id sequence number of the command
+   */
+  void complete(motion::sequence id);
+
+ private:
+  /**
+   * Stepper devices of x, y, and z
+   */
+  std::array<std::shared_ptr<device::StepperDevice>, 3> steppers_;
+  /**
+   * Step interpolator, only touched by the motion thread
+   */
+  Interpolator interpolator_;
+  /**
+   * Command queue
+   */
+  algo::SPSCQueue<motion::Command, motion::queue_capacity> queue_;
+  /**
+   * Mutex to serialize producers
+   */
+  std::mutex producer_mutex_;
+  /**
+   * Last sequence number that has been submitted, only written while holding
+   * producer_mutex_
+   */
+  std::atomic<motion::sequence> last_id_;
+  /**
+   * Incremented on each submit to wake up the motion thread
+   */
+  std::atomic<std::uint64_t> signal_;
+  /**
+   * Last completed sequence number
+   */
+  std::atomic<motion::sequence> completed_;
+  /**
+   * Every command up to this sequence number is cancelled
+   */
+  std::atomic<motion::sequence> aborted_;
+  /**
+   * Single cancelled commands, indexed by sequence number modulo
+   * motion::in_flight, so commands in flight never share a slot
+   */
+  std::array<std::atomic<motion::sequence>, motion::in_flight> withdrawn_;
+  /**
+   * Last sequence number that was halted by its input
+   */
+  std::atomic<motion::sequence> halted_;
+  /**
+   * Absolute step position of x, y, and z
+   */
+  StepCounters counters_;
+  /**
+   * Step position of x, y, and z where current command started
+   */
+  StepCounters move_origin_;
+  /**
+   * Step position of x, y, and z where current command ends
+   */
+  StepCounters move_target_;
+  /**
+   * Step count of each axis when it was halted by its input in current
+   * command, -1 if it is not halted. Only touched by the motion thread
+   */
+  std::array<device::stepper::step, 3> halted_steps_;
+  /**
+   * Coarse stepping divisor each axis is switched to, only touched by the
+   * motion thread
+   */
+  std::array<device::stepper::step, 3> divisors_;
+  /**
+   * Motion thread is running or not
+   */
+  std::atomic<bool> running_;
+  /**
+   * Real-time options
+   */
+  motion::Options options_;
+  /**
+   * Motion thread
+   */
+  std::thread thread_;
+};
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_MOTION_HPP_
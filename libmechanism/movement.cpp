@@ -2,14 +2,82 @@
 
 #include "movement.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <libutil/util.hpp>
 
 NAMESPACE_BEGIN
 
 namespace mechanism {
+/**
+ * Wait until command has been completed by motion executor
+ *
+ * Listeners are notified of the position at a limited rate while waiting
+ *
+ * @param executor motion executor
+ * @param id       sequence number of the command
+ *
+ * @return false if the command is cancelled
+ */
+static bool wait_for(const MotionExecutor& executor, motion::sequence id) {
+  massert(State::get() != nullptr, "sanity");
+
+  auto* state = State::get();
+
+  while (!executor.completed(id)) {
+    state->notify_position();
+    sleep_for<time_units::millis>(1);
+  }
+
+  state->notify_all();
+
+  return !executor.cancelled(id);
+}
+
+namespace movement {
+Future::Future() : executor_{nullptr}, id_{0}, source_{std::nostopstate} {}
+
+Future::Future(MotionExecutor* executor,
+               motion::sequence id,
+               std::stop_token  token)
+    : executor_{executor}, id_{id} {
+  massert(executor_ != nullptr, "sanity");
+
+  // captures no member, so future can be moved while the callback is alive
+  callback_ = std::make_unique<std::stop_callback<std::function<void()>>>(
+      std::move(token), [source = source_, executor, id]() mutable {
+        source.request_stop();
+        executor->cancel(id);
+      });
+}
+
+bool Future::done() const {
+  return !valid() || executor_->completed(id_);
+}
+
+bool Future::cancelled() const {
+  return !valid() || executor_->cancelled(id_);
+}
+
+bool Future::wait() const {
+  return valid() && wait_for(*executor_, id_);
+}
+
+void Future::cancel() {
+  if (!valid()) {
+    return;
+  }
+
+  source_.request_stop();
+  executor_->cancel(id_);
+}
+}  // namespace movement
+
 namespace impl {
 MovementBuilderImpl::MovementBuilderImpl() {}
 
@@ -120,12 +188,6 @@ std::shared_ptr<Movement>& MovementBuilderImpl::build() {
 Movement::Movement(const impl::MovementBuilderImpl* builder)
     : builder_{builder} {
   active_ = true;
-  ready_ = true;
-  next_move_interval_ = 0;
-  last_move_end_ = 0;
-  event_timer_x_ = 0;
-  event_timer_y_ = 0;
-  event_timer_z_ = 0;
 
   setup_stepper();
   if (active()) {
@@ -135,9 +197,18 @@ Movement::Movement(const impl::MovementBuilderImpl* builder)
   if (active()) {
     setup_finger();
   }
+
+  if (active()) {
+    setup_executor();
+  }
 }
 
-Movement::~Movement() {}
+Movement::~Movement() {
+  if (State::get() != nullptr) {
+    State::get()->track(nullptr);
+  }
+  executor_.shutdown();
+}
 
 void Movement::setup_stepper() {
   auto*  stepper_registry = device::StepperRegistry::get();
@@ -238,6 +309,46 @@ void Movement::setup_finger() {
   finger_infrared_ = finger_infrared;
 }
 
+void Movement::setup_executor() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  motion::Options options;
+  options.cpu = config->motion<int>("cpu");
+  options.priority = config->motion<int>("priority");
+  options.lock_memory = config->motion<bool>("lock-memory");
+
+  executor_.steppers(stepper_x(), stepper_y(), stepper_z());
+
+  // planner follows the steppers until the first motor profile
+  const auto speed = [](const std::shared_ptr<device::StepperDevice>& stepper) {
+    config::Speed result;
+    result.rpm = stepper->rpm();
+    result.acceleration = stepper->acceleration();
+    result.deceleration = stepper->deceleration();
+    result.jerk = stepper->jerk();
+    return result;
+  };
+
+  profile_.x = speed(stepper_x());
+  profile_.y = speed(stepper_y());
+  profile_.z = speed(stepper_z());
+
+  if (executor_.start(options) == ATM_ERR) {
+    LOG_ERROR("Failed to start motion executor");
+    active_ = false;
+    return;
+  }
+
+  // coordinate is derived from the step counters on read
+  State::get()->track(
+      &executor_.counters(),
+      {static_cast<double>(builder()->steps_per_mm_x()),
+       static_cast<double>(builder()->steps_per_mm_y()),
+       static_cast<double>(builder()->steps_per_mm_z())});
+}
+
 device::stepper::step Movement::stop_x(void) {
   return stepper_x()->stop();
 }
@@ -251,275 +362,371 @@ device::stepper::step Movement::stop_z(void) {
 }
 
 void Movement::stop(void) {
-  [[maybe_unused]] auto step_x = stop_x();
-  [[maybe_unused]] auto step_y = stop_y();
-  [[maybe_unused]] auto step_z = stop_z();
-  ready_ = true;
+  if (!executor_.running()) {
+    [[maybe_unused]] auto step_x = stop_x();
+    [[maybe_unused]] auto step_y = stop_y();
+    [[maybe_unused]] auto step_z = stop_z();
+    return;
+  }
+
+  // steppers are only touched by motion thread while it is running, wait
+  // until they are halted
+  const auto id = executor_.stop();
+  while (!executor_.completed(id)) {
+    sleep_for<time_units::millis>(1);
+  }
+}
+
+motion::sequence Movement::start_move(
+    const long& x,
+    const long& y,
+    const long& z,
+    const std::array<std::shared_ptr<device::DigitalInputDevice>, 3>& until) {
+  // point-to-point moves are only coarse if no axis is halted by its input
+  if (std::none_of(until.begin(), until.end(),
+                   [](const auto& input) { return input != nullptr; })) {
+    if (const auto id = start_traverse(x, y, z)) {
+      return *id;
+    }
+  }
+
+  motion::Command command{};
+  command.type = motion::command::move;
+  command.steps = {x, y, z};
+  command.until = {until[0].get(), until[1].get(), until[2].get()};
+
+  return dispatch(command);
 }
 
-void Movement::start_move(const long& x, const long& y, const long& z) {
+motion::sequence Movement::start_move(const planner::Block&        block,
+                                      bool                         blend,
+                                      const device::stepper::step& divisor) {
+  const auto scale = static_cast<double>(divisor);
+
+  // steps and rates are in pulses of the coarse microsteps
+  motion::Command command{};
+  command.type = motion::command::block;
+  command.steps = {block.steps[0] / divisor, block.steps[1] / divisor,
+                   block.steps[2] / divisor};
+  command.profile = {block.entry_rate / scale, block.cruise_rate / scale,
+                     block.exit_rate / scale, block.acceleration / scale};
+  command.blend = blend;
+  command.divisor = divisor;
+
+  return dispatch(command);
+}
+
+std::optional<motion::sequence> Movement::start_traverse(const long& x,
+                                                         const long& y,
+                                                         const long& z) {
+  massert(Config::get() != nullptr, "sanity");
   massert(State::get() != nullptr, "sanity");
 
+  auto* config = Config::get();
   auto* state = State::get();
 
-  if (state->fault() && !state->manual_mode()) {
-    return;
+  const std::array<std::shared_ptr<device::StepperDevice>, 3> steppers{
+      stepper_x(), stepper_y(), stepper_z()};
+  const std::array<double, 3> steps_per_mm{
+      static_cast<double>(builder()->steps_per_mm_x()),
+      static_cast<double>(builder()->steps_per_mm_y()),
+      static_cast<double>(builder()->steps_per_mm_z())};
+  const std::array<long, 3> steps{x, y, z};
+
+  const auto coarse =
+      config->motion<device::stepper::step>("coarse-microsteps");
+  const auto min_rate = config->motion<double>("coarse-min-rate");
+
+  // every moving axis is switched with the same divisor
+  device::stepper::step divisor = 0;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (steps[axis] == 0) {
+      continue;
+    }
+
+    const auto& microsteps = steppers[axis]->microsteps();
+    if (coarse <= 0 || !steppers[axis]->switchable() ||
+        microsteps % coarse != 0 ||
+        (divisor != 0 && divisor != microsteps / coarse)) {
+      return std::nullopt;
+    }
+    divisor = microsteps / coarse;
   }
 
-#if defined(SYNC_DRIVER)
-  const time_unit time_x = stepper_x()->time_for_move(x);
-  const time_unit time_y = stepper_y()->time_for_move(y);
-  const time_unit time_z = stepper_z()->time_for_move(z);
+  if (divisor <= 1) {
+    return std::nullopt;
+  }
 
-  // find which motor would take the longest to finish,
-  const time_unit move_time = std::max(time_x, std::max(time_y, time_z));
+  Planner planner;
+  setup_planner(planner);
+
+  // planner rounds positions to steps, so every waypoint is a whole number of
+  // steps away from the start
+  const auto              current = state->coordinate();
+  const planner::position start{current.x, current.y, current.z};
+  const auto              waypoint = [&start, &steps_per_mm](
+                            const std::array<std::int64_t, 3>& offset) {
+    planner::position result;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      result[axis] = (std::round(start[axis] * steps_per_mm[axis]) +
+                      static_cast<double>(offset[axis])) /
+                     steps_per_mm[axis];
+    }
+    return result;
+  };
 
-  LOG_DEBUG("Will move about {} micros", move_time);
+  const std::array<std::int64_t, 3> target{x, y, z};
 
-  // start moving x
-  if (x == 0) {
-    event_timer_x_ = 0;
-  } else {
-    stepper_x()->start_move(x, move_time);
-    event_timer_x_ = 1;
+  const auto direct = planner.plan(start, {waypoint(target)}, false);
+  if (direct.size() != 1) {
+    return std::nullopt;
   }
 
-  // start moving y
-  if (y == 0) {
-    event_timer_y_ = 0;
-  } else {
-    stepper_y()->start_move(y, move_time);
-    event_timer_y_ = 1;
+  // master steps until speed of the master axis reaches the threshold,
+  // v^2 = 2as
+  const double master = static_cast<double>(
+      std::max({std::abs(x), std::abs(y), std::abs(z)}));
+  const double ramp = min_rate * min_rate / (2.0 * direct[0].acceleration);
+  if (direct[0].cruise_rate <= min_rate || 2.0 * ramp >= master) {
+    return std::nullopt;
   }
 
-  // start moving z
-  if (z == 0) {
-    event_timer_z_ = 0;
-  } else {
-    stepper_z()->start_move(z, move_time);
-    event_timer_z_ = 1;
-  }
-#else
+  // step position is counted in native microsteps since the start, queued
+  // moves are not known here, so the executor takes a block that is not
+  // aligned with native microsteps instead
+  const auto&                       counters = executor_.counters();
+  const std::array<std::int64_t, 3> origin{
+      counters[0].load(std::memory_order_acquire),
+      counters[1].load(std::memory_order_acquire),
+      counters[2].load(std::memory_order_acquire)};
+
+  const auto floor_to = [](std::int64_t value, std::int64_t multiple) {
+    return value - ((value % multiple) + multiple) % multiple;
+  };
 
-  // start moving x
-  if (x == 0) {
-    event_timer_x_ = 0;
-  } else {
-    stepper_x()->start_move(x);
-    event_timer_x_ = 1;
-  }
+  // first and last full step of each axis inside the fast part of the move
+  std::array<std::int64_t, 3> cruise_start;
+  std::array<std::int64_t, 3> cruise_end;
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    const std::int64_t full_step = steppers[axis]->microsteps();
+    const std::int64_t low =
+        origin[axis] + std::llround(steps[axis] * ramp / master);
+    const std::int64_t high =
+        origin[axis] + steps[axis] - std::llround(steps[axis] * ramp / master);
+
+    std::int64_t first;
+    std::int64_t last;
+    if (steps[axis] >= 0) {
+      first = -floor_to(-low, full_step);
+      last = floor_to(high, full_step);
+    } else {
+      first = floor_to(low, full_step);
+      last = -floor_to(-high, full_step);
+    }
 
-  // start moving y
-  if (y == 0) {
-    event_timer_y_ = 0;
-  } else {
-    stepper_y()->start_move(y);
-    event_timer_y_ = 1;
+    // axis without a full step inside does not move during the cruise
+    if ((steps[axis] >= 0) ? first > last : first < last) {
+      first = last = low;
+    }
+
+    cruise_start[axis] = first - origin[axis];
+    cruise_end[axis] = last - origin[axis];
   }
 
-  // start moving z
-  if (z == 0) {
-    event_timer_z_ = 0;
-  } else {
-    stepper_z()->start_move(z);
-    event_timer_z_ = 1;
+  if (cruise_start == cruise_end) {
+    return std::nullopt;
   }
-#endif
 
-  ready_ = false;
-  last_move_end_ = 0;
-  next_move_interval_ = 1;
-}
+  const auto blocks = planner.plan(
+      start, {waypoint(cruise_start), waypoint(cruise_end), waypoint(target)});
+
+  LOG_DEBUG("Traverse of {} blocks, cruise above {} steps/s with {} microsteps",
+            blocks.size(), min_rate, coarse);
+
+  // only the cruise between both ramps is coarse
+  motion::sequence id = 0;
+  bool             blend = false;
+  auto             position = origin;
+  for (const auto& block : blocks) {
+    bool aligned = block.entry_rate > 0.0 && block.exit_rate > 0.0;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const std::int64_t full_step = steppers[axis]->microsteps();
+      if (block.steps[axis] != 0 &&
+          (position[axis] % full_step != 0 ||
+           (position[axis] + block.steps[axis]) % full_step != 0)) {
+        aligned = false;
+      }
+      position[axis] += block.steps[axis];
+    }
 
-void Movement::update_x() const {
-  auto steps = stepper_x()->step_count();
-  auto remaining_steps = stepper_x()->remaining_steps();
+    id = start_move(block, blend, aligned ? divisor : 1);
+    if (id == 0) {
+      break;
+    }
 
-  if (remaining_steps == 0) {
-    return;
+    blend = block.exit_rate > 0.0;
   }
 
-  if ((steps % builder()->steps_per_mm_x()) == 0) {
-    if (stepper_x()->direction() == device::stepper::direction::forward) {
-      State::get()->inc_x();
-    } else {
-      State::get()->dec_x();
-    }
-  }
+  return id;
 }
 
-void Movement::update_y() const {
-  auto steps = stepper_y()->step_count();
-  auto remaining_steps = stepper_y()->remaining_steps();
-
-  if (remaining_steps == 0) {
-    return;
+motion::sequence Movement::dispatch(const motion::Command& command) {
+  if (faulted()) {
+    return 0;
   }
 
-  if ((steps % builder()->steps_per_mm_y()) == 0) {
-    if (stepper_y()->direction() == device::stepper::direction::forward) {
-      State::get()->inc_y();
-    } else {
-      State::get()->dec_y();
-    }
+  const auto id = executor_.submit(command);
+
+  // fault may have been raised before the command was queued
+  if (faulted()) {
+    executor_.cancel_until(id);
   }
+
+  return id;
 }
 
-void Movement::update_z() const {
-  auto steps = stepper_z()->step_count();
-  auto remaining_steps = stepper_z()->remaining_steps();
+bool Movement::faulted() {
+  massert(State::get() != nullptr, "sanity");
+
+  auto token = State::get()->fault_token();
 
-  if (remaining_steps == 0) {
-    return;
-  }
+  // movement is shared by task, manual movement, and homing threads
+  std::lock_guard<std::mutex> lock(fault_mutex_);
 
-  if ((steps % builder()->steps_per_mm_z()) == 0) {
-    if (stepper_z()->direction() == device::stepper::direction::forward) {
-      State::get()->inc_z();
-    } else {
-      State::get()->dec_z();
-    }
+  // state creates a new token after fault is cleared
+  if (token != fault_token_) {
+    fault_callback_.reset();
+    fault_token_ = std::move(token);
+    fault_callback_.emplace(fault_token_, [this]() {
+      executor_.cancel_until(executor_.last());
+    });
   }
-}
 
-void Movement::update_position() const {
-  update_x();
-  update_y();
-  update_z();
+  return fault_token_.stop_requested();
 }
 
-float Movement::progress() const {
-  const auto& step_remain_x = stepper_x()->remaining_steps();
-  const auto& step_remain_y = stepper_y()->remaining_steps();
-  const auto& step_remain_z = stepper_z()->remaining_steps();
+bool Movement::wait(motion::sequence id) {
+  return wait_for(executor_, id);
+}
 
-  const auto& step_count_x = stepper_x()->step_count();
-  const auto& step_count_y = stepper_y()->step_count();
-  const auto& step_count_z = stepper_z()->step_count();
+void Movement::setup_planner(Planner& planner) const {
+  std::lock_guard<std::mutex> lock(profile_mutex_);
+  planner.limits(profile_);
+}
 
-  const auto f = [](const device::stepper::step& remain,
-                    const device::stepper::step& count) {
-    return static_cast<float>(count) / static_cast<float>(remain + count);
-  };
+float Movement::progress() const {
+  return executor_.progress();
+}
 
-  float remainder = 0.0f;
-  float percentage = 0.0f;
+void Movement::travel(Point x, Point y, Point z) {
+  massert(Config::get() != nullptr, "sanity");
+  massert(State::get() != nullptr, "sanity");
 
-  float percentage_x = f(step_remain_x, step_count_x);
-  float percentage_y = f(step_remain_y, step_count_y);
-  float percentage_z = f(step_remain_z, step_count_z);
+  auto* config = Config::get();
+  auto* state = State::get();
 
-  if (percentage_x < 1.0f) {
-    remainder += 1.0f;
-    percentage += percentage_x;
+  if (state->manual_mode()) {
+    move<movement::unit::mm>(x, y, z);
+    return;
   }
 
-  if (percentage_y < 1.0f) {
-    remainder += 1.0f;
-    percentage += percentage_y;
+  if (!ready()) {
+    return;
   }
 
-  if (percentage_z < 1.0f) {
-    remainder += 1.0f;
-    percentage += percentage_z;
-  }
+  const auto current = state->coordinate();
+  const auto safe_height = config->clearance<Point>("safe-height");
 
-  if (percentage == 0.0f) {
-    percentage = 1.0f;
-  } else {
-    percentage /= remainder;
-  }
+  // finger height when x-axis and y-axis start and stop
+  const Point lift_z = std::min(current.z, safe_height);
+  const Point land_z = std::min(z, safe_height);
 
-  return percentage;
-}
+  const auto steps = [](Point from, Point to, device::stepper::step spm) {
+    return convert_length_to_steps<movement::unit::mm>(to, spm) -
+           convert_length_to_steps<movement::unit::mm>(from, spm);
+  };
 
-time_unit Movement::next() {
-  while ((micros() - last_move_end()) < next_move_interval()) {
-    // not yet running
-  }
+  const long steps_x = steps(current.x, x, builder()->steps_per_mm_x());
+  const long steps_y = steps(current.y, y, builder()->steps_per_mm_y());
 
-  // bool next_x = false;
-  // bool next_y = false;
-  // bool next_z = false;
+  LOG_DEBUG("Travel from ({}, {}, {}) to ({}, {}, {}), safe height {}",
+            current.x, current.y, current.z, x, y, z, safe_height);
 
-  // std::future<time_unit> timer_x;
-  // std::future<time_unit> timer_y;
-  // std::future<time_unit> timer_z;
+  enable_motors();
 
-  if (event_timer_x() <= next_move_interval()) {
-    // with thread version
-    // next_x = true;
-    // timer_x = thread_pool().enqueue([this] { return stepper_x()->next(); });
+  motion::sequence id = 0;
 
-    // without thread version
-    event_timer_x_ = stepper_x()->next();
-  } else {
-    event_timer_x_ -= next_move_interval();
+  if (current.z > lift_z) {
+    id = start_move(0, 0,
+                    steps(current.z, lift_z, builder()->steps_per_mm_z()));
+    if (id == 0) {
+      return;
+    }
   }
 
-  if (event_timer_y() <= next_move_interval()) {
-    // with thread version
-    // next_y = true;
-    // timer_y = thread_pool().enqueue([this] { return stepper_y()->next(); });
-
-    // without thread version
-    event_timer_y_ = stepper_y()->next();
-  } else {
-    event_timer_y_ -= next_move_interval();
+  id = start_move(steps_x, steps_y,
+                  steps(lift_z, land_z, builder()->steps_per_mm_z()));
+  if (id == 0) {
+    return;
   }
 
-  if (event_timer_z() <= next_move_interval()) {
-    // with thread version
-    // next_z = true;
-    // timer_z = thread_pool().enqueue([this] { return stepper_z()->next(); });
-
-    // without thread version
-    event_timer_z_ = stepper_z()->next();
-  } else {
-    event_timer_z_ -= next_move_interval();
+  if (z > land_z) {
+    id = start_move(0, 0, steps(land_z, z, builder()->steps_per_mm_z()));
+    if (id == 0) {
+      return;
+    }
   }
 
-  // if (next_x) {
-  //   event_timer_x_ = timer_x.get();
-  // }
+  if (!wait(id)) {
+    return;
+  }
 
-  // if (next_y) {
-  //   event_timer_y_ = timer_y.get();
-  // }
+  state->coordinate({x, y, z});
 
-  // if (next_z) {
-  //   event_timer_z_ = timer_z.get();
-  // }
+  disable_motors();
+}
 
-  update_position();
-  // auto x = State::get()->x();
-  // auto y = State::get()->y();
-  // auto z = State::get()->z();
-  // LOG_DEBUG("Position X {} Y {} Z {}", x, y, z);
+movement::Future Movement::submit(Point           x,
+                                  Point           y,
+                                  Point           z,
+                                  std::stop_token token) {
+  massert(State::get() != nullptr, "sanity");
 
-  last_move_end_ = micros();
-  next_move_interval_ = 0;
+  auto* state = State::get();
 
-  // Find the time when the next pulse needs to fire
-  // this is the smallest non-zero timer value from all active motorsA
-  if (event_timer_x() > 0 &&
-      (event_timer_x() < next_move_interval() || next_move_interval() == 0)) {
-    next_move_interval_ = event_timer_x();
+  if (!ready()) {
+    return {};
   }
 
-  if (event_timer_y() > 0 &&
-      (event_timer_y() < next_move_interval() || next_move_interval() == 0)) {
-    next_move_interval_ = event_timer_y();
-  }
+  // earlier moves may still be running, so the target is taken as absolute
+  // step position and reached from wherever they end
+  std::array<std::int64_t, 3> position;
+  const auto                  current = state->coordinate(position);
 
-  if (event_timer_z() > 0 &&
-      (event_timer_z() < next_move_interval() || next_move_interval() == 0)) {
-    next_move_interval_ = event_timer_z();
-  }
+  const auto steps = [](Point from, Point to, device::stepper::step spm) {
+    return convert_length_to_steps<movement::unit::mm>(to, spm) -
+           convert_length_to_steps<movement::unit::mm>(from, spm);
+  };
 
-  ready_ = (next_move_interval() == 0);
+  LOG_DEBUG("Submit move from ({}, {}, {}) to ({}, {}, {})", current.x,
+            current.y, current.z, x, y, z);
 
-  return next_move_interval();
+  enable_motors();
+
+  motion::Command command{};
+  command.type = motion::command::move;
+  command.absolute = true;
+  command.steps = {
+      position[0] + steps(current.x, x, builder()->steps_per_mm_x()),
+      position[1] + steps(current.y, y, builder()->steps_per_mm_y()),
+      position[2] + steps(current.z, z, builder()->steps_per_mm_z())};
+
+  const auto id = dispatch(command);
+  if (id == 0) {
+    return {};
+  }
+
+  return movement::Future(&executor_, id, std::move(token));
 }
 
 void Movement::move_to_spraying_position() {
@@ -531,16 +738,95 @@ void Movement::move_to_spraying_position() {
 }
 
 void Movement::move_to_tending_position() {
+  massert(Config::get() != nullptr, "sanity");
+  massert(State::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+  auto* state = State::get();
+
   LOG_DEBUG("Move to tending position...");
-  const auto& iter = Config::get()->tending_position();
-  move<movement::unit::mm>(iter.first, iter.second, 0.0);
+  const auto& iter = config->tending_position();
+  // finger is lowered to the safe height on the way
+  travel(iter.first, iter.second, config->clearance<Point>("safe-height"));
   // reset position so imaginary homing equals tending position
-  State::get()->coordinate({0.0, 0.0, 0.0});
+  state->coordinate({0.0, 0.0, state->z()});
+}
+
+void Movement::follow_path(const ns(impl::ConfigImpl)::path_container& path,
+                           const Point&                                z,
+                           const plan::path&                           id) {
+  massert(State::get() != nullptr, "sanity");
+
+  auto* state = State::get();
+
+  if (!ready() || path.empty()) {
+    return;
+  }
+
+  // compiled plans move at the height of their start
+  plan::block_view blocks;
+  if (PlanCache::get() != nullptr && state->z() == z) {
+    blocks = PlanCache::get()->find(id, state->speed_profile(), state->x(),
+                                    state->y(), state->z());
+  }
+
+  planner::block_container planned;
+  if (blocks.empty()) {
+    std::vector<planner::position> waypoints;
+    waypoints.reserve(path.size());
+    for (const auto& iter : path) {
+      waypoints.push_back({iter.first, iter.second, z});
+    }
+
+    Planner planner;
+    setup_planner(planner);
+
+    planned = planner.plan({state->x(), state->y(), state->z()}, waypoints);
+    blocks = planned;
+
+    LOG_DEBUG("Planned {} blocks, will move about {} micros", planned.size(),
+              Planner::duration(planned));
+  } else {
+    LOG_DEBUG("Streaming {} compiled blocks", blocks.size());
+  }
+
+  // enabling motor
+  enable_motors();
+
+  // one block is queued ahead, so the motion thread continues to the next
+  // block without waiting for this thread
+  motion::sequence previous = 0;
+  bool             blend = false;
+  for (const auto& block : blocks) {
+    LOG_DEBUG("Move to x={}mm y={}mm", block.target[0], block.target[1]);
+    const auto id = start_move(block, blend);
+    if (id == 0) {
+      stop();
+      break;
+    }
+
+    // sequence 0 is never submitted, there is nothing to wait for yet
+    if (previous != 0 && !wait(previous)) {
+      break;
+    }
+
+    previous = id;
+    blend = block.exit_rate > 0.0;
+  }
+
+  if (previous != 0 && wait(previous) && !faulted()) {
+    const auto& target = blocks.back().target;
+    state->coordinate({target[0], target[1], z});
+  }
+
+  // disabling motor
+  disable_motors();
 }
 
 void Movement::follow_spraying_paths() {
   massert(Config::get() != nullptr, "sanity");
   massert(State::get() != nullptr, "sanity");
+  massert(Route::get() != nullptr, "sanity");
 
   auto* config = Config::get();
   auto* state = State::get();
@@ -548,12 +834,10 @@ void Movement::follow_spraying_paths() {
   motor_profile(config->spraying_speed_profile(state->speed_profile()));
 
   LOG_DEBUG("Following spraying paths...");
-  for (const auto& iter : Config::get()->spraying_path()) {
-    if (state->fault())
-      return;
-    LOG_DEBUG("Move to x={}mm y={}mm", iter.first, iter.second);
-    move<movement::unit::mm>(iter.first, iter.second, 0.0);
-  }
+  follow_path(Route::get()->spraying_path(), 0.0, plan::path::spraying);
+
+  if (state->fault())
+    return;
 
   revert_motor_params();
 }
@@ -568,13 +852,11 @@ void Movement::follow_tending_paths_edge() {
   motor_profile(config->tending_speed_profile(state->speed_profile()));
 
   LOG_DEBUG("Following tending paths edge...");
+  follow_path(config->tending_path_edge(), state->z(),
+              plan::path::tending_edge);
 
-  for (const auto& iter : config->tending_path_edge()) {
-    if (state->fault())
-      return;
-    LOG_DEBUG("Move to x={}mm y={}mm", iter.first, iter.second);
-    move<movement::unit::mm>(iter.first, iter.second, state->z());
-  }
+  if (state->fault())
+    return;
 
   revert_motor_params();
 }
@@ -589,35 +871,69 @@ void Movement::follow_tending_paths_zigzag() {
   motor_profile(config->tending_speed_profile(state->speed_profile()));
 
   LOG_DEBUG("Following tending paths zigzag...");
+  follow_path(config->tending_path_zigzag(), state->z(),
+              plan::path::tending_zigzag);
 
-  for (const auto& iter : config->tending_path_zigzag()) {
-    if (state->fault())
-      return;
-    LOG_DEBUG("Move to x={}mm y={}mm", iter.first, iter.second);
-    move<movement::unit::mm>(iter.first, iter.second, state->z());
-  }
+  if (state->fault())
+    return;
 
   revert_motor_params();
 }
 
-void Movement::motor_profile(
-    const config::MechanismSpeed& speed_profile) const {
+void Movement::motor_profile(const config::MechanismSpeed& speed_profile) {
   LOG_INFO("Changing motors' parameters...");
 
-  stepper_x()->rpm(speed_profile.x.rpm);
-  stepper_x()->acceleration(speed_profile.x.acceleration);
-  stepper_x()->deceleration(speed_profile.x.deceleration);
+  std::lock_guard<std::mutex> lock(profile_mutex_);
+
+  profile_ = speed_profile;
+
+  if (!executor_.running()) {
+    // no motion thread, so nothing else touches the steppers
+    for (const auto& [stepper, speed] :
+         {std::pair{stepper_x(), speed_profile.x},
+          std::pair{stepper_y(), speed_profile.y},
+          std::pair{stepper_z(), speed_profile.z}}) {
+      stepper->rpm(speed.rpm);
+      stepper->acceleration(speed.acceleration);
+      stepper->deceleration(speed.deceleration);
+      stepper->jerk(speed.jerk);
+    }
+    return;
+  }
+
+  // queued even after fault, so the steppers always follow the last profile
+  motion::Command command{};
+  command.type = motion::command::profile;
+  command.speed = {speed_profile.x, speed_profile.y, speed_profile.z};
+  executor_.submit(command);
+}
+
+void Movement::report_step_timing() const {
+  const std::array<std::pair<const char*, device::StepperDevice*>, 3> axes{
+      {{"x", stepper_x().get()},
+       {"y", stepper_y().get()},
+       {"z", stepper_z().get()}}};
+
+  for (const auto& [name, stepper] : axes) {
+    const auto& error = stepper->interval_error();
+    const auto& overrun = stepper->overrun();
 
-  stepper_y()->rpm(speed_profile.y.rpm);
-  stepper_y()->acceleration(speed_profile.y.acceleration);
-  stepper_y()->deceleration(speed_profile.y.deceleration);
+    if (error.count() == 0) {
+      continue;
+    }
 
-  stepper_z()->rpm(speed_profile.z.rpm);
-  stepper_z()->acceleration(speed_profile.z.acceleration);
-  stepper_z()->deceleration(speed_profile.z.deceleration);
+    LOG_INFO(
+        "Step timing of {}-axis: {} steps, interval error p50={}us p99={}us "
+        "p99.9={}us max={}us, overrun p99={}us max={}us",
+        name, error.count(), error.percentile(50.0), error.percentile(99.0),
+        error.percentile(99.9), error.max(), overrun.percentile(99.0),
+        overrun.max());
+
+    stepper->reset_timing();
+  }
 }
 
-void Movement::revert_motor_params() const {
+void Movement::revert_motor_params() {
   massert(Config::get() != nullptr, "sanity");
   massert(State::get() != nullptr, "sanity");
 
@@ -636,7 +952,7 @@ void Movement::move_finger_up() {
   auto* config = Config::get();
   auto* state = State::get();
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -652,40 +968,28 @@ void Movement::move_finger_up() {
   bool z_completed =
       limit_switch_z_top()->read().value_or(device::digital::value::low) ==
       device::digital::value::high;
-  while ((!state->fault() || (state->fault() && state->manual_mode())) &&
-         !z_completed) {
-    if (state->fault() && !state->manual_mode()) {
-      state->homing(false);
-      stop();
-      return;
-    }
-
+  while (!faulted() && !z_completed) {
     z_completed =
         limit_switch_z_top()->read().value_or(device::digital::value::low) ==
         device::digital::value::high;
-    if (z_completed) {
-      stepper_z()->stop();
-    } else {
-      start_move(0, 0, -1200);
-      while (!ready()) {
-        if (state->fault() && !state->manual_mode()) {
-          state->homing(false);
-          stop();
-          return;
-        }
-
-        if (limit_switch_z_top()->read().value_or(
-                device::digital::value::low) == device::digital::value::high) {
-          stepper_z()->stop();
-          z_completed = true;
-          ready_ = true;
-        } else {
-          next();
-        }
+    if (!z_completed) {
+      // motion thread halts as soon as the limit switch is high
+      const auto id =
+          start_move(0, 0, -1200, {nullptr, nullptr, limit_switch_z_top()});
+      if (!wait(id)) {
+        state->homing(false);
+        return;
       }
     }
   }
 
+  // loop only ends early because of fault
+  if (!z_completed) {
+    state->homing(false);
+    stop();
+    return;
+  }
+
   disable_motors();
 
   state->z(0.0);
@@ -698,7 +1002,7 @@ void Movement::move_finger_down() {
   auto* config = Config::get();
   auto* state = State::get();
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -715,43 +1019,31 @@ void Movement::move_finger_down() {
       limit_switch_z_bottom()->read().value_or(device::digital::value::low) ==
       device::digital::value::high;
 
-  while ((!state->fault() || (state->fault() && state->manual_mode())) &&
-         !z_completed) {
-    if (state->fault() && !state->manual_mode()) {
-      state->homing(false);
-      stop();
-      return;
-    }
-
+  while (!faulted() && !z_completed) {
     z_completed =
         limit_switch_z_bottom()->read().value_or(device::digital::value::low) ==
         device::digital::value::high;
-    if (z_completed) {
-      stepper_z()->stop();
-    } else {
-      start_move(0, 0, 1200);
-      while (!ready()) {
-        if (state->fault() && !state->manual_mode()) {
-          state->homing(false);
-          stop();
-          return;
-        }
-
-        if (limit_switch_z_bottom()->read().value_or(
-                device::digital::value::low) == device::digital::value::high) {
-          stepper_z()->stop();
-          z_completed = true;
-          ready_ = true;
-        } else {
-          next();
-        }
+    if (!z_completed) {
+      // motion thread halts as soon as the limit switch is high
+      const auto id = start_move(0, 0, 1200,
+                                 {nullptr, nullptr, limit_switch_z_bottom()});
+      if (!wait(id)) {
+        state->homing(false);
+        return;
       }
     }
   }
 
+  // loop only ends early because of fault
+  if (!z_completed) {
+    state->homing(false);
+    stop();
+    return;
+  }
+
   disable_motors();
 
-  state->z(52.0);
+  state->z(movement::finger_travel);
 }
 
 void Movement::rotate_finger() const {
@@ -813,7 +1105,7 @@ void Movement::homing() {
 
   state->homing(true);
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -828,107 +1120,69 @@ void Movement::homing() {
   // enabling motor
   enable_motors();
 
-  // homing y
-  bool is_y_completed =
-      limit_switch_y()->read().value_or(device::digital::value::low) ==
-      device::digital::value::high;
-
-  while ((!state->fault() || (state->fault() && state->manual_mode())) &&
-         !is_y_completed) {
-    if (state->fault() && !state->manual_mode()) {
-      state->homing(false);
-      stop();
-      return;
-    }
-
-    long steps_y = 0;
+  // phase 1: seek both limit switches at homing speed
+  if (!seek_home(1500.0)) {
+    state->homing(false);
+    return;
+  }
 
-    if (limit_switch_y()->read().value_or(device::digital::value::low) ==
-        device::digital::value::high) {
-      is_y_completed = true;
-      stepper_y()->stop();
-    } else {
-      steps_y = convert_length_to_steps<movement::unit::mm>(
-          -1200.0, builder()->steps_per_mm_y());
-    }
+  if (faulted()) {
+    state->homing(false);
+    stop();
+    return;
+  }
 
-    start_move(0, steps_y, 0);
-    while (!ready()) {
-      if (state->fault() && !state->manual_mode()) {
-        state->homing(false);
-        stop();
-        return;
-      }
+  // switches are the origin of the back-off, so it is relative to them
+  state->reset_coordinate();
 
-      bool y_complete =
-          limit_switch_y()->read().value_or(device::digital::value::low) ==
-          device::digital::value::high;
-      if (y_complete) {
-        is_y_completed = true;
-        stepper_y()->stop();
-      }
-      if (y_complete) {
-        ready_ = true;
-      } else {
-        next();
-      }
-    }
+  // back off through the executor, so the drivers stay enabled for phase 2
+  const auto back_off = config->homing<double>("back-off");
+  if (!wait(start_move(convert_length_to_steps<movement::unit::mm>(
+                           back_off, builder()->steps_per_mm_x()),
+                       convert_length_to_steps<movement::unit::mm>(
+                           back_off, builder()->steps_per_mm_y()),
+                       0))) {
+    state->homing(false);
+    return;
   }
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
   }
 
-  // homing x
-  bool is_x_completed =
-      limit_switch_x()->read().value_or(device::digital::value::low) ==
-      device::digital::value::high;
+  // latching a switch that is still pressed gives no repeatable home
+  if (limit_switch_x()->read().value_or(device::digital::value::high) ==
+          device::digital::value::high ||
+      limit_switch_y()->read().value_or(device::digital::value::high) ==
+          device::digital::value::high) {
+    LOG_ERROR("Limit switches are still pressed after back-off of {} mm",
+              back_off);
+    state->homing(false);
+    stop();
+    return;
+  }
 
-  while ((!state->fault() || (state->fault() && state->manual_mode())) &&
-         !is_x_completed) {
-    if (state->fault() && !state->manual_mode()) {
-      state->homing(false);
-      stop();
-      return;
-    }
+  state->coordinate({back_off, back_off, 0.0});
 
-    long steps_x = 0;
+  // phase 2: latch both limit switches again slowly for a repeatable home
+  const auto latch_ratio = config->homing<double>("latch-ratio");
+  auto latch_profile = config->homing_speed_profile(state->speed_profile());
+  latch_profile.x.rpm *= latch_ratio;
+  latch_profile.y.rpm *= latch_ratio;
+  motor_profile(latch_profile);
 
-    if (limit_switch_x()->read().value_or(device::digital::value::low) ==
-        device::digital::value::high) {
-      is_x_completed = true;
-      stepper_x()->stop();
-    } else {
-      steps_x = convert_length_to_steps<movement::unit::mm>(
-          -1500.0, builder()->steps_per_mm_x());
-    }
+  const bool latched = seek_home(2 * back_off);
 
-    start_move(steps_x, 0, 0);
-    while (!ready()) {
-      if (state->fault() && !state->manual_mode()) {
-        state->homing(false);
-        stop();
-        return;
-      }
+  motor_profile(config->homing_speed_profile(state->speed_profile()));
 
-      bool x_complete =
-          limit_switch_x()->read().value_or(device::digital::value::low) ==
-          device::digital::value::high;
-      if (x_complete) {
-        is_x_completed = true;
-        stepper_x()->stop();
-      }
-      if (x_complete) {
-        ready_ = true;
-      } else {
-        next();
-      }
-    }
+  if (!latched) {
+    state->homing(false);
+    return;
   }
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -937,7 +1191,7 @@ void Movement::homing() {
   // set state to 0,0,0
   state->reset_coordinate();
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -946,7 +1200,7 @@ void Movement::homing() {
   // move a bit (5mm for each axis)
   move<movement::unit::mm>(5.0, 5.0, 5.0);
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -955,7 +1209,7 @@ void Movement::homing() {
   // set state to 0,0,0
   state->reset_coordinate();
 
-  if (state->fault() && !state->manual_mode()) {
+  if (faulted()) {
     state->homing(false);
     stop();
     return;
@@ -969,6 +1223,40 @@ void Movement::homing() {
   LOG_DEBUG("Homing is finished...");
 }
 
+bool Movement::seek_home(double distance) {
+  while (!faulted()) {
+    const bool is_x_completed =
+        limit_switch_x()->read().value_or(device::digital::value::low) ==
+        device::digital::value::high;
+    const bool is_y_completed =
+        limit_switch_y()->read().value_or(device::digital::value::low) ==
+        device::digital::value::high;
+
+    if (is_x_completed && is_y_completed) {
+      return true;
+    }
+
+    // equal length for both axes, so both run at their own full speed
+    const long steps_x =
+        is_x_completed ? 0
+                       : convert_length_to_steps<movement::unit::mm>(
+                             -distance, builder()->steps_per_mm_x());
+    const long steps_y =
+        is_y_completed ? 0
+                       : convert_length_to_steps<movement::unit::mm>(
+                             -distance, builder()->steps_per_mm_y());
+
+    // motion thread halts each axis as soon as its limit switch is high
+    if (!wait(start_move(steps_x, steps_y, 0,
+                         {limit_switch_x(), limit_switch_y(), nullptr}))) {
+      return false;
+    }
+  }
+
+  stop();
+  return false;
+}
+
 void Movement::enable_motors() const {
   LOG_DEBUG("Enabling motors...");
   stepper_x()->enable();
@@ -984,9 +1272,27 @@ void Movement::disable_motors() const {
 }
 
 bool Movement::is_home() const {
-  return util::and_(limit_switch_x()->read_bool(),
-                    limit_switch_y()->read_bool(),
-                    limit_switch_z_top()->read_bool());
+  massert(Config::get() != nullptr, "sanity");
+
+  const auto period = Config::get()->fault<std::uint32_t>("sample-period");
+
+  device::GpioSampler sampler(period);
+  sampler.add(limit_switch_x());
+  sampler.add(limit_switch_y());
+  sampler.add(limit_switch_z_top());
+
+  // every limit switch must be high for its debounce time
+  sampler.reset();
+
+  auto inputs = sampler.sample();
+  while (!sampler.settled()) {
+    sleep_for<time_units::micros>(period);
+    inputs = sampler.sample();
+  }
+
+  return util::and_(inputs.read_bool(limit_switch_x()),
+                    inputs.read_bool(limit_switch_y()),
+                    inputs.read_bool(limit_switch_z_top()));
 }
 }  // namespace mechanism
 
@@ -7,18 +7,28 @@
  * Movement mechanism
  */
 
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
 
 #include <libcore/core.hpp>
 #include <libdevice/device.hpp>
 
+#include "interpolator.hpp"
+#include "motion.hpp"
+#include "plan-cache.hpp"
+#include "planner.hpp"
+
 NAMESPACE_BEGIN
 
 namespace mechanism {
 // forward declaration
 namespace movement {
 enum class unit;
+class Future;
 }
 namespace impl {
 class MovementBuilderImpl;
@@ -27,6 +37,114 @@ class Movement;
 
 namespace movement {
 enum class unit { cm, mm };
+
+/** Height of finger at its bottom limit switch (mm) */
+static constexpr Point finger_travel = 52.0;
+
+/**
+ * @brief Future of submitted move.
+ *
+ * Move runs on the motion thread while the submitter continues. Cancelling
+ * halts the move at its next step, or skips it if it is still queued. Other
+ * moves are not affected, see MotionExecutor::cancel
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Future {
+ public:
+  /**
+   * Future Constructor
+   *
+   * Future of a move that has not been submitted
+   */
+  Future();
+  /**
+   * Future Constructor
+   *
+   * @param executor motion executor that runs the move
+   * @param id       sequence number of the last command of the move
+   * @param token    move is cancelled as soon as stop is requested
+   */
+  Future(MotionExecutor* executor, motion::sequence id, std::stop_token token);
+  /**
+   * Future Destructor
+   *
+   * Move is not cancelled, it keeps running
+   */
+  ~Future() = default;
+  /**
+   * Future move constructor
+   */
+  Future(Future&&) = default;
+  /**
+   * Future move assignment
+   *
+   * @return this future
+   */
+  Future& operator=(Future&&) = default;
+  /**
+   * Check move has been submitted
+   *
+   * @return submitted or not
+   */
+  inline bool valid() const { return executor_ != nullptr; }
+  /**
+   * Check move has been completed (finished or cancelled)
+   *
+   * @return completed or not, always true if move is not submitted
+   */
+  bool done() const;
+  /**
+   * Check move has been cancelled, by cancel() or by fault
+   *
+   * @return cancelled or not, always true if move is not submitted
+   */
+  bool cancelled() const;
+  /**
+   * Wait until the move has been completed
+   *
+   * Listeners are notified of the position at a limited rate while waiting
+   *
+   * @return true if the move is finished, false if it is cancelled or not
+   *         submitted
+   */
+  bool wait() const;
+  /**
+   * Cancel the move
+   *
+   * Only this move is cancelled, moves queued before and after it still run.
+   * Thread-safe
+   */
+  void cancel();
+  /**
+   * Get token of the move
+   *
+   * Stop is requested when the move is cancelled by cancel() or by the token
+   * it was submitted with
+   *
+   * @return stop token
+   */
+  inline std::stop_token token() const { return source_.get_token(); }
+
+ private:
+  /**
+   * Motion executor that runs the move
+   */
+  MotionExecutor* executor_;
+  /**
+   * Sequence number of the last command of the move
+   */
+  motion::sequence id_;
+  /**
+   * Source of the move token
+   */
+  std::stop_source source_;
+  /**
+   * Cancels the move when stop of submit token is requested
+   */
+  std::unique_ptr<std::stop_callback<std::function<void()>>> callback_;
+};
 }  // namespace movement
 
 using MovementBuilder = StaticObj<impl::MovementBuilderImpl>;
@@ -323,6 +441,46 @@ class Movement : public StackObj {
    */
   template <movement::unit Unit>
   void move(Point x, Point y, Point z);
+  /**
+   * Travel to absolute position within the clearance envelope
+   *
+   * X-axis and y-axis only move while finger is at the safe height or above
+   * (see "mechanisms.clearance"). Finger is lifted to the safe height first,
+   * then the travel and the rest of finger move up to the safe height are
+   * done in one move, and finger is lowered below the safe height last.
+   * Every part is queued to the motion executor at once, so there is no gap
+   * between them.
+   *
+   * Same as move() in manual mode
+   *
+   * @param x  position of x-axis (mm)
+   * @param y  position of y-axis (mm)
+   * @param z  position of z-axis (mm)
+   */
+  void travel(Point x, Point y, Point z);
+  /**
+   * Submit move to absolute position without waiting for it
+   *
+   * Move is cancelled as soon as fault happens outside of manual mode, or
+   * stop of the token is requested. Motors are left enabled, see
+   * disable_motors()
+   *
+   * Moves may be submitted while earlier ones are outstanding, each of them
+   * ends at its own target even if an earlier one is cancelled. It is a
+   * single synchronized move, without coarse stepping
+   *
+   * @param x      position of x-axis (mm)
+   * @param y      position of y-axis (mm)
+   * @param z      position of z-axis (mm)
+   * @param token  token to cancel the move
+   *
+   * @return future of the move, not valid if movement is not ready or fault
+   *         happens
+   */
+  movement::Future submit(Point           x,
+                          Point           y,
+                          Point           z,
+                          std::stop_token token = {});
   /**
    * Movement progress in percentage
    *
@@ -364,7 +522,13 @@ class Movement : public StackObj {
    *
    * @return ready or not
    */
-  inline const bool& ready() const { return ready_; }
+  inline bool ready() const { return executor_.idle(); }
+  /**
+   * Get motion executor that generates every step
+   *
+   * @return motion executor
+   */
+  inline const MotionExecutor& executor() const { return executor_; }
   /**
    * Homing all stepper
    */
@@ -403,6 +567,21 @@ class Movement : public StackObj {
    * Move to position zero tending
    */
   void move_to_tending_position();
+  /**
+   * Move along the path with look-ahead planning
+   *
+   * Speed is carried through the waypoints instead of stopping at every
+   * waypoint, see mechanism::Planner. Blocks are streamed from the compiled
+   * plan if there is one starting at current position, see
+   * mechanism::PlanCache
+   *
+   * @param path absolute waypoints of x and y (mm)
+   * @param z    z-axis position during the move (mm)
+   * @param id   path of the compiled plan
+   */
+  void follow_path(const ns(impl::ConfigImpl)::path_container& path,
+                   const Point&                                z,
+                   const plan::path&                           id);
   /**
    * Move according to spraying paths
    */
@@ -426,9 +605,18 @@ class Movement : public StackObj {
   /**
    * Set Motor Profile for steppers
    *
+   * Steppers are changed by the motion thread between two moves, every move
+   * submitted after it runs with the new profile
+   *
    * @param speed_profile speed profile configuration
    **/
-  void motor_profile(const config::MechanismSpeed& speed_profile) const;
+  void motor_profile(const config::MechanismSpeed& speed_profile);
+  /**
+   * Log step timing of every axis, then clear it
+   *
+   * Called at the end of each task, see StepperDevice::record_timing
+   */
+  void report_step_timing() const;
 
  private:
   /**
@@ -573,101 +761,137 @@ class Movement : public StackObj {
    */
   void setup_finger();
   /**
-   * Setup move action for steppers
+   * Submit move action for steppers to motion executor
    *
-   * @param x  length of x-axis
-   * @param y  length of y-axis
-   * @param z  length of z-axis
+   * @param x      steps of x-axis
+   * @param y      steps of y-axis
+   * @param z      steps of z-axis
+   * @param until  per-axis input, halt that axis as soon as it reads high
+   *
+   * @return sequence number of the move, 0 if it is not submitted
    */
-  void start_move(const long& x, const long& y, const long& z);
+  motion::sequence start_move(
+      const long& x,
+      const long& y,
+      const long& z,
+      const std::array<std::shared_ptr<device::DigitalInputDevice>, 3>& until =
+          {});
   /**
-   * Yield move for each step
+   * Submit move action for steppers from planned block to motion executor
    *
-   * Will generate output to the stepper pins
+   * @param block   planned block
+   * @param blend   continue from the last step of previous block
+   * @param divisor coarse stepping divisor, see motion::Command
    *
-   * @return time until next change is needed
+   * @return sequence number of the move, 0 if it is not submitted
    */
-  time_unit next();
+  motion::sequence start_move(const planner::Block&        block,
+                              bool                         blend,
+                              const device::stepper::step& divisor = 1);
   /**
-   * Get event timers of x-axis stepper
+   * Submit rapid move with coarse microstepping while it is fast
    *
-   * @return timer of x-axis stepper
-   */
-  inline const time_unit& event_timer_x() const { return event_timer_x_; }
-  /**
-   * Get event timers of y-axis stepper
+   * Move is planned as three blocks: ramp up, cruise above key
+   * "mechanisms.motion.coarse-min-rate", and ramp down. Cruise is taken with
+   * key "mechanisms.motion.coarse-microsteps" and starts and ends at a
+   * full-step boundary of every moving axis, so position stays exact
    *
-   * @return timer of y-axis stepper
-   */
-  inline const time_unit& event_timer_y() const { return event_timer_y_; }
-  /**
-   * Get event timers of z-axis stepper
+   * @param x steps of x-axis
+   * @param y steps of y-axis
+   * @param z steps of z-axis
    *
-   * @return timer of z-axis stepper
+   * @return sequence number of the last block, std::nullopt if the move is
+   * too slow or the steppers cannot switch microsteps
    */
-  inline const time_unit& event_timer_z() const { return event_timer_z_; }
+  std::optional<motion::sequence> start_traverse(const long& x,
+                                                 const long& y,
+                                                 const long& z);
   /**
-   * Get timestamp of ending of last move
+   * Submit command to motion executor
    *
-   * @return time of last move end
+   * Command is not submitted if fault has happened outside of manual mode
+   *
+   * @param command command to submit
+   *
+   * @return sequence number of the command, 0 if it is not submitted
    */
-  inline const time_unit& last_move_end() const { return last_move_end_; }
+  motion::sequence dispatch(const motion::Command& command);
   /**
-   * Get timestamp of ending of last action
+   * Wait until the move has been completed by motion executor
+   *
+   * Listeners are notified of the position at a limited rate while waiting.
+   * Every move is cancelled as soon as fault happens outside of manual mode,
+   * see faulted()
    *
-   * @return next move interval time
+   * @param id sequence number of the move
+   *
+   * @return false if the move is cancelled because of fault
    */
-  inline const time_unit& next_move_interval() const {
-    return next_move_interval_;
-  }
+  bool wait(motion::sequence id);
   /**
-   * Update position of x
+   * Check fault has happened outside of manual mode
+   *
+   * Also links the fault token of state to the motion executor, so every
+   * submitted command is cancelled from the thread that raises the fault
+   * instead of being polled. Safe to call from any thread
+   *
+   * @return true if fault has happened
    */
-  void update_x() const;
+  bool faulted();
   /**
-   * Update position of y
+   * Move x-axis and y-axis toward their limit switches at the same time
+   *
+   * Each axis is halted by its own limit switch, so both are seeked with
+   * one move per attempt
+   *
+   * @param distance length to travel for each attempt (mm)
+   *
+   * @return true if both limit switches are high, false if it is stopped
+   *         because of fault
    */
-  void update_y() const;
+  bool seek_home(double distance);
   /**
-   * Update position of z
+   * Start motion executor with options from configuration
    */
-  void update_z() const;
+  void setup_executor();
   /**
-   * Update position
+   * Create axis limits for planner from current motor profile
+   *
+   * @param planner planner to setup
    */
-  void update_position() const;
+  void setup_planner(Planner& planner) const;
   /**
    * Reverting motor params
    *
    * Reverting to homing speed profile
    */
-  void revert_motor_params() const;
+  void revert_motor_params();
 
  private:
   /**
-   * Check whether ready to start a new move or not
+   * Motion executor, every step is generated by its thread
    */
-  bool ready_;
+  MotionExecutor executor_;
   /**
-   * When next state change is due for x-axis stepper
+   * Mutex of fault token and its callback
    */
-  time_unit event_timer_x_;
+  std::mutex fault_mutex_;
   /**
-   * When next state change is due for y-axis stepper
+   * Fault token that is linked to the motion executor
    */
-  time_unit event_timer_y_;
+  std::stop_token fault_token_;
   /**
-   * When next state change is due for z-axis stepper
+   * Cancels every submitted command when stop of fault token is requested
    */
-  time_unit event_timer_z_;
+  std::optional<std::stop_callback<std::function<void()>>> fault_callback_;
   /**
-   * When next state change is due for each motor
+   * Mutex of motor profile
    */
-  time_unit next_move_interval_;
+  mutable std::mutex profile_mutex_;
   /**
-   * When next state change is due for each motor
+   * Last motor profile that has been submitted to the motion executor
    */
-  time_unit last_move_end_;
+  config::MechanismSpeed profile_;
 
  private:
   /**
@@ -12,10 +12,11 @@ template <movement::unit Unit>
 long Movement::convert_length_to_steps(
     double                       length,
     const device::stepper::step& steps_per_mm) {
+  // round after scaling, so sub-mm length is not lost
   if (Unit == movement::unit::cm) {
-    return static_cast<long>(std::lround(length) * steps_per_mm * 10);
+    return std::lround(length * static_cast<double>(steps_per_mm * 10));
   } else {
-    return static_cast<long>(std::lround(length) * steps_per_mm);
+    return std::lround(length * static_cast<double>(steps_per_mm));
   }
 }
 
@@ -45,24 +46,23 @@ void Movement::move(Point x, Point y, Point z) {
       steps_z = convert_length_to_steps<Unit>(z, builder()->steps_per_mm_z());
 
     } else {
-      steps_x = convert_length_to_steps<Unit>(x - current_x,
-                                              builder()->steps_per_mm_x());
-      steps_y = convert_length_to_steps<Unit>(y - current_y,
-                                              builder()->steps_per_mm_y());
-      steps_z = convert_length_to_steps<Unit>(z - current_z,
-                                              builder()->steps_per_mm_z());
+      // difference of absolute step positions, rounding error of each target
+      // does not accumulate along the path
+      steps_x =
+          convert_length_to_steps<Unit>(x, builder()->steps_per_mm_x()) -
+          convert_length_to_steps<Unit>(current_x, builder()->steps_per_mm_x());
+      steps_y =
+          convert_length_to_steps<Unit>(y, builder()->steps_per_mm_y()) -
+          convert_length_to_steps<Unit>(current_y, builder()->steps_per_mm_y());
+      steps_z =
+          convert_length_to_steps<Unit>(z, builder()->steps_per_mm_z()) -
+          convert_length_to_steps<Unit>(current_z, builder()->steps_per_mm_z());
     }
 
     LOG_INFO("Starting to move steps_x={}, steps_y={}, steps_z={}...", steps_x,
              steps_y, steps_z);
-    start_move(steps_x, steps_y, steps_z);  // will trigger ready to false
-    while (!ready()) {
-      if (state->fault() && !state->manual_mode()) {
-        stop();
-        return;
-      } else {
-        next();
-      }
+    if (!wait(start_move(steps_x, steps_y, steps_z))) {
+      return;
     }
     LOG_INFO("Move is finished");
 
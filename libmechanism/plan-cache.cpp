@@ -0,0 +1,363 @@
+#include "mechanism.hpp"
+
+#include "plan-cache.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+/** Version of plan file, bump when the format or the planner changes */
+static constexpr std::uint64_t plan_version = 2;
+
+/** Magic of plan file */
+static constexpr char plan_magic[8] = "ATMPLAN";
+
+/** Maximum distance between start of the move and start of the plan (mm) */
+static constexpr Point start_tolerance = 1e-6;
+
+/** Every speed profile that is compiled */
+static constexpr config::speed speeds[] = {
+    config::speed::slow, config::speed::normal, config::speed::fast};
+
+/**
+ * Get waypoints of the path
+ *
+ * @param path waypoints of x and y (mm)
+ * @param z    height of the path (mm)
+ *
+ * @return waypoints (mm)
+ */
+static std::vector<planner::position> waypoints(
+    const ns(impl::ConfigImpl)::path_container& path,
+    const Point&                                z) {
+  std::vector<planner::position> result;
+  result.reserve(path.size());
+  for (const auto& [x, y] : path) {
+    result.push_back({x, y, z});
+  }
+  return result;
+}
+
+namespace impl {
+PlanCacheImpl::PlanCacheImpl() : active_{false}, data_{nullptr}, size_{0} {}
+
+PlanCacheImpl::~PlanCacheImpl() {
+  unmap();
+}
+
+void PlanCacheImpl::prepare() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  unmap();
+
+  if (!config->plan_cache<bool>("enabled")) {
+    return;
+  }
+
+  const auto path = config->plan_cache<std::string>("cache");
+  const auto config_hash = hash();
+
+  if (map(path, config_hash)) {
+    LOG_DEBUG("Compiled plans are mapped from {}", path);
+  } else {
+    LOG_INFO("Compiling plans of spraying and tending paths...");
+    if (!compile(path, config_hash) || !map(path, config_hash)) {
+      LOG_WARN("Cannot map compiled plans from {}, paths are planned live",
+               path);
+      return;
+    }
+  }
+
+  LOG_DEBUG("{} compiled plans with {} blocks", entries_.size(),
+            blocks_.size());
+}
+
+plan::block_view PlanCacheImpl::find(const plan::path&    path,
+                                     const config::speed& speed,
+                                     const Point&         x,
+                                     const Point&         y,
+                                     const Point&         z) const {
+  if (!active_) {
+    return {};
+  }
+
+  for (const auto& entry : entries_) {
+    if (entry.path != path ||
+        entry.speed != static_cast<std::uint32_t>(speed)) {
+      continue;
+    }
+
+    if (std::abs(entry.start[0] - x) > start_tolerance ||
+        std::abs(entry.start[1] - y) > start_tolerance ||
+        std::abs(entry.start[2] - z) > start_tolerance) {
+      return {};
+    }
+
+    return blocks_.subspan(entry.offset, entry.count);
+  }
+
+  return {};
+}
+
+std::uint64_t PlanCacheImpl::hash() const {
+  massert(Config::get() != nullptr, "sanity");
+  massert(Route::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  // FNV-1a
+  std::uint64_t result = 0xcbf29ce484222325ULL;
+
+  const auto mix = [&result](const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      result ^= bytes[i];
+      result *= 0x100000001b3ULL;
+    }
+  };
+  const auto mix_number = [&mix](auto value) { mix(&value, sizeof(value)); };
+  const auto mix_path =
+      [&mix_number](const ns(impl::ConfigImpl)::path_container& path) {
+        mix_number(path.size());
+        for (const auto& [x, y] : path) {
+          mix_number(x);
+          mix_number(y);
+        }
+      };
+  const auto mix_speed = [&mix_number](const config::MechanismSpeed& speed) {
+    for (const auto* axis : {&speed.x, &speed.y, &speed.z}) {
+      mix_number(axis->rpm);
+      mix_number(axis->acceleration);
+      mix_number(axis->deceleration);
+      mix_number(axis->jerk);
+    }
+  };
+
+  mix_number(plan_version);
+  mix_number(sizeof(planner::Block));
+  mix_number(planner::look_ahead);
+
+  // spraying path is taken in visiting order of route optimizer
+  mix_path(Route::get()->spraying_path());
+  mix_path(config->tending_path_edge());
+  mix_path(config->tending_path_zigzag());
+
+  for (const auto& speed : speeds) {
+    mix_speed(config->spraying_speed_profile(speed));
+    mix_speed(config->tending_speed_profile(speed));
+  }
+
+  mix_number(config->stepper_x<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_x<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_y<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_y<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_z<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_z<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_x<device::stepper::step>("motor-steps"));
+  mix_number(config->stepper_y<device::stepper::step>("motor-steps"));
+  mix_number(config->stepper_z<device::stepper::step>("motor-steps"));
+  mix_number(config->motion<device::stepper::step>("coarse-microsteps"));
+  mix_number(config->motion<double>("coarse-min-rate"));
+  mix_number(movement::finger_travel);
+
+  return result;
+}
+
+bool PlanCacheImpl::map(const std::string& path, std::uint64_t hash) {
+  unmap();
+
+#if defined(__linux__)
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void* data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                      PROT_READ, MAP_PRIVATE, fd, 0);
+  // mapping stays valid after the descriptor is closed
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  data_ = static_cast<const std::byte*>(data);
+  size_ = static_cast<std::size_t>(info.st_size);
+#else
+  fs::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+
+  buffer_.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(buffer_.data()),
+                 static_cast<std::streamsize>(buffer_.size()))) {
+    buffer_.clear();
+    return false;
+  }
+
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#endif
+
+  if (size_ < sizeof(plan::Header)) {
+    unmap();
+    return false;
+  }
+
+  const auto* header = reinterpret_cast<const plan::Header*>(data_);
+
+  const bool matched =
+      std::memcmp(header->magic, plan_magic, sizeof(plan_magic)) == 0 &&
+      header->version == plan_version && header->hash == hash &&
+      header->block_size == sizeof(planner::Block);
+  // sizes are checked one by one, so none of them can overflow
+  const auto payload = size_ - sizeof(plan::Header);
+  if (!matched || header->entries > payload / sizeof(plan::Entry) ||
+      header->blocks > payload / sizeof(planner::Block) ||
+      payload != header->entries * sizeof(plan::Entry) +
+                     header->blocks * sizeof(planner::Block)) {
+    unmap();
+    return false;
+  }
+
+  const auto* entries =
+      reinterpret_cast<const plan::Entry*>(data_ + sizeof(plan::Header));
+  const auto* blocks = reinterpret_cast<const planner::Block*>(
+      data_ + sizeof(plan::Header) + header->entries * sizeof(plan::Entry));
+
+  entries_ = {entries, static_cast<std::size_t>(header->entries)};
+  blocks_ = {blocks, static_cast<std::size_t>(header->blocks)};
+
+  for (const auto& entry : entries_) {
+    if (entry.offset > blocks_.size() ||
+        entry.count > blocks_.size() - entry.offset) {
+      unmap();
+      return false;
+    }
+  }
+
+  active_ = true;
+
+  return true;
+}
+
+void PlanCacheImpl::unmap() {
+#if defined(__linux__)
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::byte*>(data_), size_);
+  }
+#else
+  buffer_.clear();
+#endif
+
+  active_ = false;
+  data_ = nullptr;
+  size_ = 0;
+  entries_ = {};
+  blocks_ = {};
+}
+
+bool PlanCacheImpl::compile(const std::string& path,
+                            std::uint64_t      hash) const {
+  massert(Config::get() != nullptr, "sanity");
+  massert(Route::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  // spraying moves with the finger up, tending with the finger down
+  const auto spraying = waypoints(Route::get()->spraying_path(), 0.0);
+  const auto edge =
+      waypoints(config->tending_path_edge(), movement::finger_travel);
+  const auto zigzag =
+      waypoints(config->tending_path_zigzag(), movement::finger_travel);
+
+  // spraying and edge tending start at the origin of their position, zigzag
+  // tending continues from the end of edge tending
+  const planner::position origin{0.0, 0.0, 0.0};
+  const planner::position finger_down{0.0, 0.0, movement::finger_travel};
+
+  std::vector<plan::Entry>  entries;
+  planner::block_container blocks;
+
+  const auto add = [&entries, &blocks](
+                       const Planner& planner, const plan::path& id,
+                       const config::speed&                  speed,
+                       const planner::position&              start,
+                       const std::vector<planner::position>& waypoints) {
+    if (waypoints.empty()) {
+      return;
+    }
+
+    const auto planned = planner.plan(start, waypoints);
+
+    entries.push_back({id, static_cast<std::uint32_t>(speed), blocks.size(),
+                       planned.size(), {start[0], start[1], start[2]}});
+    blocks.insert(blocks.end(), planned.begin(), planned.end());
+  };
+
+  for (const auto& speed : speeds) {
+    Planner planner;
+
+    planner.limits(config->spraying_speed_profile(speed));
+    add(planner, plan::path::spraying, speed, origin, spraying);
+
+    planner.limits(config->tending_speed_profile(speed));
+    add(planner, plan::path::tending_edge, speed, finger_down, edge);
+    add(planner, plan::path::tending_zigzag, speed,
+        edge.empty() ? finger_down : edge.back(), zigzag);
+  }
+
+  plan::Header header;
+  std::memcpy(header.magic, plan_magic, sizeof(plan_magic));
+  header.version = plan_version;
+  header.hash = hash;
+  header.block_size = sizeof(planner::Block);
+  header.entries = entries.size();
+  header.blocks = blocks.size();
+
+  fs::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+  if (!file) {
+    LOG_WARN("Cannot write compiled plans to {}", path);
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(entries.data()),
+             static_cast<std::streamsize>(entries.size() *
+                                          sizeof(plan::Entry)));
+  file.write(reinterpret_cast<const char*>(blocks.data()),
+             static_cast<std::streamsize>(blocks.size() *
+                                          sizeof(planner::Block)));
+
+  if (!file) {
+    LOG_WARN("Cannot write compiled plans to {}", path);
+    return false;
+  }
+
+  return true;
+}
+}  // namespace impl
+}  // namespace mechanism
+
+NAMESPACE_END
@@ -0,0 +1,223 @@
+#ifndef LIB_MECHANISM_PLAN_CACHE_HPP_
+#define LIB_MECHANISM_PLAN_CACHE_HPP_
+
+/** @file plan-cache.hpp
+ *  @brief Compiled motion plan cache class definition
+ *
+ * Planned blocks of every path and speed profile, compiled once and mapped
+ * from a file
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <libcore/core.hpp>
+
+#include "planner.hpp"
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+namespace impl {
+class PlanCacheImpl;
+}
+
+namespace plan {
+/** Path of a task */
+enum class path : std::uint32_t {
+  spraying,       /**< spraying path, relative to spraying position */
+  tending_edge,   /**< edge tending path, relative to tending position */
+  tending_zigzag, /**< zigzag tending path, continues from edge path */
+};
+
+/**
+ * @var using block_view = std::span<const planner::Block>
+ * @brief Type definition for planned blocks that are not owned
+ */
+using block_view = std::span<const planner::Block>;
+
+/**
+ * @brief Header of compiled plan file
+ */
+struct Header {
+  /**
+   * File magic, "ATMPLAN"
+   */
+  char magic[8];
+  /**
+   * Version of the format
+   */
+  std::uint64_t version;
+  /**
+   * Hash of configuration
+   */
+  std::uint64_t hash;
+  /**
+   * Size of single block, the file is only valid for the same build
+   */
+  std::uint64_t block_size;
+  /**
+   * Number of entries that follow the header
+   */
+  std::uint64_t entries;
+  /**
+   * Number of blocks that follow the entries
+   */
+  std::uint64_t blocks;
+};
+
+/**
+ * @brief Compiled plan of a path with a speed profile
+ */
+struct Entry {
+  /**
+   * Path of the plan
+   */
+  plan::path path;
+  /**
+   * Speed profile of the plan
+   */
+  std::uint32_t speed;
+  /**
+   * Index of first block
+   */
+  std::uint64_t offset;
+  /**
+   * Number of blocks
+   */
+  std::uint64_t count;
+  /**
+   * Position where the plan starts (mm), every waypoint is at its height
+   */
+  Point start[3];
+};
+}  // namespace plan
+
+using PlanCache = StaticObj<impl::PlanCacheImpl>;
+
+namespace impl {
+/**
+ * @brief Compiled motion plan cache implementation.
+ *
+ * Plans every task path (spraying, edge and zigzag tending) for every speed
+ * profile with mechanism::Planner once, writes the blocks to a binary file,
+ * and maps it, so a task streams its blocks to the motion thread without
+ * planning at all.
+ *
+ * File is keyed by a hash of every configuration value the plans depend on
+ * and compiled again when it does not match.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class PlanCacheImpl : public StackObj {
+  template <class PlanCacheImpl>
+  template <typename... Args>
+  friend ATM_STATUS StaticObj<PlanCacheImpl>::create(Args&&... args);
+
+ public:
+  /**
+   * Get active status
+   *
+   * @return active status, true if compiled plans are mapped
+   */
+  inline const bool& active() const { return active_; }
+  /**
+   * Map compiled plans, compiling them first if the file is missing or stale
+   *
+   * Does nothing if it is not enabled in key "mechanisms.plan-cache.enabled"
+   */
+  void prepare();
+  /**
+   * Find compiled plan
+   *
+   * @param path  path of the plan
+   * @param speed speed profile of the plan
+   * @param x     position of x-axis where the move starts (mm)
+   * @param y     position of y-axis where the move starts (mm)
+   * @param z     position of z-axis where the move starts (mm)
+   *
+   * @return planned blocks, empty if there is no plan starting at position
+   */
+  plan::block_view find(const plan::path&    path,
+                        const config::speed& speed,
+                        const Point&         x,
+                        const Point&         y,
+                        const Point&         z) const;
+
+ private:
+  /**
+   * PlanCache constructor
+   */
+  PlanCacheImpl();
+  /**
+   * PlanCache destructor
+   *
+   * Unmap compiled plans
+   */
+  ~PlanCacheImpl();
+  /**
+   * Get hash of every configuration value the plans depend on
+   *
+   * @return FNV-1a hash
+   */
+  std::uint64_t hash() const;
+  /**
+   * Map compiled plans from file
+   *
+   * @param path path of plan file
+   * @param hash hash of configuration
+   *
+   * @return true if file is valid and mapped
+   */
+  bool map(const std::string& path, std::uint64_t hash);
+  /**
+   * Unmap compiled plans
+   */
+  void unmap();
+  /**
+   * Compile plans and write them to file
+   *
+   * @param path path of plan file
+   * @param hash hash of configuration
+   *
+   * @return true if file is written
+   */
+  bool compile(const std::string& path, std::uint64_t hash) const;
+
+ private:
+  /**
+   * Active status
+   */
+  bool active_;
+  /**
+   * Mapped file
+   */
+  const std::byte* data_;
+  /**
+   * Size of mapped file
+   */
+  std::size_t size_;
+  /**
+   * Content of file where it cannot be mapped
+   */
+  std::vector<std::byte> buffer_;
+  /**
+   * Compiled plans
+   */
+  std::span<const plan::Entry> entries_;
+  /**
+   * Blocks of every compiled plan
+   */
+  plan::block_view blocks_;
+};
+}  // namespace impl
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_PLAN_CACHE_HPP_
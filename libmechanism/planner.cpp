@@ -0,0 +1,262 @@
+#include "mechanism.hpp"
+
+#include "planner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+namespace planner {
+/**
+ * @brief Planned segment in mm domain
+ */
+struct Segment {
+  /**
+   * Unit vector of segment
+   */
+  std::array<double, 3> unit;
+  /**
+   * Length of segment (mm)
+   */
+  double length;
+  /**
+   * Nominal speed (mm / s)
+   */
+  double speed;
+  /**
+   * Acceleration (mm / s^2)
+   */
+  double acceleration;
+  /**
+   * Maximum junction speed with previous segment (mm / s)
+   */
+  double junction;
+};
+}  // namespace planner
+
+Planner::Planner(std::size_t look_ahead)
+    : look_ahead_{std::max<std::size_t>(look_ahead, 1)} {
+  limits_.fill({1.0, 0.0, 0.0, 0.0});
+}
+
+Planner::~Planner() {}
+
+planner::AxisLimit Planner::axis_limit(
+    const config::Speed&         speed,
+    const device::stepper::step& steps_per_mm,
+    const device::stepper::step& microsteps,
+    const device::stepper::step& motor_steps) {
+  massert(steps_per_mm > 0, "sanity");
+  massert(microsteps > 0, "sanity");
+
+  const double spm = static_cast<double>(steps_per_mm);
+  const double ms = static_cast<double>(microsteps);
+  // acceleration and deceleration are in full steps / s^2
+  const double acceleration = std::min(speed.acceleration, speed.deceleration);
+
+  planner::AxisLimit limit;
+  limit.steps_per_mm = spm;
+  limit.max_speed = speed.rpm * static_cast<double>(motor_steps) / 60 * ms / spm;
+  limit.acceleration = acceleration * ms / spm;
+  // start speed of linear speed stepper, 1 / c0 (see RampTable)
+  limit.max_jump =
+      (acceleration > 0.0)
+          ? 1.0 / (0.676 * std::sqrt(2.0 / acceleration / ms)) / spm
+          : 0.0;
+
+  return limit;
+}
+
+void Planner::limits(const planner::AxisLimit& x,
+                     const planner::AxisLimit& y,
+                     const planner::AxisLimit& z) {
+  massert(x.max_speed > 0.0 && x.acceleration > 0.0, "sanity");
+  massert(y.max_speed > 0.0 && y.acceleration > 0.0, "sanity");
+  massert(z.max_speed > 0.0 && z.acceleration > 0.0, "sanity");
+  limits_ = {x, y, z};
+}
+
+void Planner::limits(const config::MechanismSpeed& speed) {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  limits(axis_limit(speed.x,
+                    config->stepper_x<device::stepper::step>("steps-per-mm"),
+                    config->stepper_x<device::stepper::step>("microsteps"),
+                    config->stepper_x<device::stepper::step>("motor-steps")),
+         axis_limit(speed.y,
+                    config->stepper_y<device::stepper::step>("steps-per-mm"),
+                    config->stepper_y<device::stepper::step>("microsteps"),
+                    config->stepper_y<device::stepper::step>("motor-steps")),
+         axis_limit(speed.z,
+                    config->stepper_z<device::stepper::step>("steps-per-mm"),
+                    config->stepper_z<device::stepper::step>("microsteps"),
+                    config->stepper_z<device::stepper::step>("motor-steps")));
+}
+
+double Planner::reachable(double target, double acceleration, double length) {
+  return std::sqrt(target * target + 2.0 * acceleration * length);
+}
+
+planner::block_container Planner::plan(
+    const planner::position&              start,
+    const std::vector<planner::position>& waypoints,
+    bool                                  blend) const {
+  constexpr double inf = std::numeric_limits<double>::infinity();
+
+  planner::block_container                blocks;
+  std::vector<planner::Segment>           segments;
+  std::array<device::stepper::step, 3>    position_steps;
+  std::array<double, 3>                   previous_unit{0.0, 0.0, 0.0};
+
+  blocks.reserve(waypoints.size());
+  segments.reserve(waypoints.size());
+
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    position_steps[axis] = static_cast<device::stepper::step>(
+        std::lround(start[axis] * limits_[axis].steps_per_mm));
+  }
+
+  // 1. build segments, steps are derived from absolute target to avoid drift
+  planner::position current = start;
+  for (const auto& target : waypoints) {
+    planner::Block   block{};
+    planner::Segment segment{};
+
+    double length = 0.0;
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      const auto target_steps = static_cast<device::stepper::step>(
+          std::lround(target[axis] * limits_[axis].steps_per_mm));
+      block.steps[axis] = target_steps - position_steps[axis];
+      position_steps[axis] = target_steps;
+
+      const double delta = target[axis] - current[axis];
+      segment.unit[axis] = delta;
+      length += delta * delta;
+    }
+    length = std::sqrt(length);
+
+    block.target = target;
+    current = target;
+
+    if (block.steps[0] == 0 && block.steps[1] == 0 && block.steps[2] == 0) {
+      continue;
+    }
+
+    segment.length = length;
+    segment.speed = inf;
+    segment.acceleration = inf;
+    segment.junction = inf;
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      segment.unit[axis] = (length > 0.0) ? segment.unit[axis] / length : 0.0;
+      const double component = std::abs(segment.unit[axis]);
+      if (component > 0.0) {
+        segment.speed =
+            std::min(segment.speed, limits_[axis].max_speed / component);
+        segment.acceleration = std::min(
+            segment.acceleration, limits_[axis].acceleration / component);
+      }
+
+      // axis speed jumps by |v * (u_next - u_prev)| at the junction
+      const double change = std::abs(segment.unit[axis] - previous_unit[axis]);
+      if (change > 0.0) {
+        segment.junction =
+            std::min(segment.junction, limits_[axis].max_jump / change);
+      }
+    }
+
+    if (!blend || segments.empty()) {
+      segment.junction = 0.0;
+    }
+
+    previous_unit = segment.unit;
+    blocks.push_back(block);
+    segments.push_back(segment);
+  }
+
+  // 2. look-ahead, exit speed of a segment is limited by what the next N
+  // segments can brake from (assuming stop after the window)
+  const std::size_t n = segments.size();
+  double            entry = 0.0;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    double            exit = 0.0;
+    const std::size_t window = std::min(i + look_ahead(), n);
+
+    if (i + 1 < window) {
+      double limit = 0.0;
+      for (std::size_t j = window - 1; j > i; --j) {
+        const auto& next = segments[j];
+        limit = std::min({next.junction, segments[j - 1].speed, next.speed,
+                          reachable(limit, next.acceleration, next.length)});
+      }
+      exit = limit;
+    }
+
+    const auto& segment = segments[i];
+    // forward pass, cannot exit faster than what can be accelerated to
+    exit = std::min(exit, reachable(entry, segment.acceleration, segment.length));
+
+    // 3. convert to master-axis steps
+    auto& block = blocks[i];
+
+    std::size_t master = 0;
+    for (std::size_t axis = 1; axis < 3; ++axis) {
+      if (std::abs(block.steps[axis]) > std::abs(block.steps[master])) {
+        master = axis;
+      }
+    }
+
+    // master steps for each mm of path
+    const double scale = (segment.length > 0.0)
+                             ? static_cast<double>(std::abs(block.steps[master])) /
+                                   segment.length
+                             : 0.0;
+
+    block.length = segment.length;
+    block.entry_rate = entry * scale;
+    block.cruise_rate = segment.speed * scale;
+    block.exit_rate = exit * scale;
+    block.acceleration = segment.acceleration * scale;
+
+    // trapezoid (or triangle) duration
+    const double a = segment.acceleration;
+    double       peak = segment.speed;
+    double       accel_length = (peak * peak - entry * entry) / (2.0 * a);
+    double       decel_length = (peak * peak - exit * exit) / (2.0 * a);
+
+    if (accel_length + decel_length > segment.length) {
+      peak = std::sqrt((2.0 * a * segment.length + entry * entry +
+                        exit * exit) / 2.0);
+      accel_length = (peak * peak - entry * entry) / (2.0 * a);
+      decel_length = segment.length - accel_length;
+    }
+
+    const double cruise_length =
+        std::max(segment.length - accel_length - decel_length, 0.0);
+    const double t = (peak - entry) / a + (peak - exit) / a +
+                     ((peak > 0.0) ? cruise_length / peak : 0.0);
+
+    block.duration = static_cast<time_unit>(std::lround(t * 1e+6));
+
+    entry = exit;
+  }
+
+  return blocks;
+}
+
+time_unit Planner::duration(const planner::block_container& blocks) {
+  time_unit total = 0;
+  for (const auto& block : blocks) {
+    total += block.duration;
+  }
+  return total;
+}
+}  // namespace mechanism
+
+NAMESPACE_END
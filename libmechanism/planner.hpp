@@ -0,0 +1,220 @@
+#ifndef LIB_MECHANISM_PLANNER_HPP_
+#define LIB_MECHANISM_PLANNER_HPP_
+
+/** @file planner.hpp
+ *  @brief Look-ahead trajectory planner class definition
+ *
+ * Look-ahead trajectory planner with junction velocity blending
+ */
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <libutil/util.hpp>
+
+#include <libcore/core.hpp>
+
+#include <libdevice/device.hpp>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+class Planner;
+
+namespace planner {
+/**
+ * @var using position = std::array<Point, 3>
+ * @brief Type definition for x, y, z position in mm
+ */
+using position = std::array<Point, 3>;
+
+/**
+ * @brief Axis limit
+ *
+ * Kinematic limits of single axis in mm domain
+ */
+struct AxisLimit {
+  /**
+   * Conversion of mm to steps
+   */
+  double steps_per_mm;
+  /**
+   * Maximum speed (mm / s)
+   */
+  double max_speed;
+  /**
+   * Maximum acceleration (mm / s^2)
+   */
+  double acceleration;
+  /**
+   * Maximum instantaneous speed change (mm / s)
+   */
+  double max_jump;
+};
+
+/**
+ * @brief Planned block
+ *
+ * Single segment of the path with its speed profile in master-axis steps
+ */
+struct Block {
+  /**
+   * Steps to take for each axis
+   */
+  std::array<device::stepper::step, 3> steps;
+  /**
+   * Absolute target position (mm)
+   */
+  position target;
+  /**
+   * Length of block (mm)
+   */
+  double length;
+  /**
+   * Entry speed of master axis (steps / s)
+   */
+  double entry_rate;
+  /**
+   * Cruise speed of master axis (steps / s)
+   */
+  double cruise_rate;
+  /**
+   * Exit speed of master axis (steps / s)
+   */
+  double exit_rate;
+  /**
+   * Acceleration of master axis (steps / s^2)
+   */
+  double acceleration;
+  /**
+   * Estimated duration of block (us)
+   */
+  time_unit duration;
+};
+
+/**
+ * @var using block_container = std::vector<Block>
+ * @brief Type definition for planned blocks
+ */
+using block_container = std::vector<Block>;
+
+/** Default number of segments to look ahead */
+static constexpr std::size_t look_ahead = 16;
+}  // namespace planner
+
+/**
+ * @brief Look-ahead trajectory planner.
+ *
+ * Queues N upcoming segments and computes the maximum safe junction velocity
+ * between them from per-axis limits, so speed is carried through the corners
+ * instead of stopping at every waypoint. Speed is never planned higher than
+ * what the upcoming N segments can brake from.
+ *
+ * Maximum instantaneous speed change of an axis equals the start speed of the
+ * linear speed stepper (first pulse c0), which the stepper already takes from
+ * standstill.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Planner : public StackObj {
+ public:
+  /**
+   * Planner Constructor
+   *
+   * @param look_ahead number of segments to look ahead
+   */
+  explicit Planner(std::size_t look_ahead = planner::look_ahead);
+  /**
+   * Planner Destructor
+   */
+  ~Planner();
+  /**
+   * Create axis limit from speed configuration
+   *
+   * @param speed        speed configuration of the axis
+   * @param steps_per_mm conversion of mm to steps
+   * @param microsteps   stepper microsteps
+   * @param motor_steps  motor steps per revolution
+   *
+   * @return axis limit in mm domain
+   */
+  static planner::AxisLimit axis_limit(const config::Speed&         speed,
+                                       const device::stepper::step& steps_per_mm,
+                                       const device::stepper::step& microsteps,
+                                       const device::stepper::step& motor_steps);
+  /**
+   * Set limits for all axes
+   *
+   * @param x limit of x-axis
+   * @param y limit of y-axis
+   * @param z limit of z-axis
+   */
+  void limits(const planner::AxisLimit& x,
+              const planner::AxisLimit& y,
+              const planner::AxisLimit& z);
+  /**
+   * Set limits for all axes from speed profile and stepper configuration
+   *
+   * Same limits as the steppers that are set up with the speed profile
+   *
+   * @param speed speed profile of every axis
+   */
+  void limits(const config::MechanismSpeed& speed);
+  /**
+   * Plan the path
+   *
+   * @param start     start position (mm)
+   * @param waypoints absolute waypoints (mm)
+   * @param blend     carry speed through the corners, false will stop at every
+   * waypoint
+   *
+   * @return planned blocks
+   */
+  planner::block_container plan(const planner::position&              start,
+                                const std::vector<planner::position>& waypoints,
+                                bool blend = true) const;
+  /**
+   * Get total duration of planned blocks
+   *
+   * @param blocks planned blocks
+   *
+   * @return total duration (us)
+   */
+  static time_unit duration(const planner::block_container& blocks);
+  /**
+   * Get number of segments to look ahead
+   *
+   * @return number of segments to look ahead
+   */
+  inline const std::size_t& look_ahead() const { return look_ahead_; }
+
+ private:
+  /**
+   * Maximum speed that can still reach target speed within given distance
+   *
+   * @param target       target speed (mm / s)
+   * @param acceleration acceleration (mm / s^2)
+   * @param length       distance (mm)
+   *
+   * @return maximum speed (mm / s)
+   */
+  static double reachable(double target, double acceleration, double length);
+
+ private:
+  /**
+   * Number of segments to look ahead
+   */
+  const std::size_t look_ahead_;
+  /**
+   * Limits for each axis
+   */
+  std::array<planner::AxisLimit, 3> limits_;
+};
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_PLANNER_HPP_
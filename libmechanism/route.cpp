@@ -0,0 +1,398 @@
+#include "mechanism.hpp"
+
+#include "route.hpp"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "estimator.hpp"
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+/** Version of cache file, bump when the format or the cost changes */
+static constexpr std::uint64_t cache_version = 1;
+
+/**
+ * Create estimator of steppers with given speed
+ *
+ * @param speed speed of every axis
+ *
+ * @return estimator
+ */
+static Estimator travel_estimator(const config::MechanismSpeed& speed) {
+  Estimator estimator;
+  estimator.axes(speed);
+  return estimator;
+}
+
+/**
+ * Get items of cleaning stations, every station is a single node
+ *
+ * @param stations cleaning stations
+ *
+ * @return items to visit
+ */
+static std::vector<algo::tour::Item> station_items(
+    const route::cleaning_container& stations) {
+  std::vector<algo::tour::Item> items;
+  items.reserve(stations.size());
+  for (std::size_t i = 0; i < stations.size(); ++i) {
+    items.push_back({i, i, false});
+  }
+  return items;
+}
+
+/**
+ * Get items of spraying path, every two waypoints are a pass that can be
+ * sprayed in either direction (a trailing waypoint is a single node)
+ *
+ * @param path spraying movement path
+ *
+ * @return items to visit
+ */
+static std::vector<algo::tour::Item> pass_items(
+    const route::path_container& path) {
+  std::vector<algo::tour::Item> items;
+  items.reserve((path.size() + 1) / 2);
+  for (std::size_t i = 0; i < path.size(); i += 2) {
+    if (i + 1 < path.size()) {
+      items.push_back({i, i + 1, true});
+    } else {
+      items.push_back({i, i, false});
+    }
+  }
+  return items;
+}
+
+/**
+ * Check that visiting order visits every item once
+ *
+ * @param items items to visit
+ * @param route visiting order
+ *
+ * @return true if visiting order is valid
+ */
+static bool valid(const std::vector<algo::tour::Item>& items,
+                  const algo::tour::route&             route) {
+  if (route.size() != items.size()) {
+    return false;
+  }
+
+  std::vector<bool> visited(items.size(), false);
+  for (const auto& [item, reversed] : route) {
+    if (item >= items.size() || visited[item] ||
+        (reversed && !items[item].reversible)) {
+      return false;
+    }
+    visited[item] = true;
+  }
+
+  return true;
+}
+
+/**
+ * Solve visiting order between points
+ *
+ * @param points    points that are nodes of the items, start, and end
+ * @param items     items to visit
+ * @param start     node where tour starts
+ * @param end       node where tour ends
+ * @param estimator estimator of travel time
+ * @param limit     maximum number of items that are solved exactly
+ *
+ * @return visiting order
+ */
+static algo::tour::route solve_route(
+    const std::vector<std::pair<double, double>>& points,
+    const std::vector<algo::tour::Item>&          items,
+    algo::tour::node                              start,
+    algo::tour::node                              end,
+    const Estimator&                              estimator,
+    std::size_t                                   limit) {
+  const auto cost = [&points, &estimator](algo::tour::node from,
+                                          algo::tour::node to) {
+    return static_cast<double>(
+        estimator
+            .move({points[from].first, points[from].second, 0.0},
+                  {points[to].first, points[to].second, 0.0})
+            .duration);
+  };
+
+  algo::Tour tour(start, end, cost, limit);
+
+  auto route = tour.solve(items);
+
+  LOG_DEBUG("Route of {} items takes {:.3f}s of travel instead of {:.3f}s",
+            items.size(), tour.cost(items, route) / 1e+6,
+            tour.cost(items, algo::Tour::identity(items)) / 1e+6);
+
+  return route;
+}
+
+/**
+ * Write visiting order to stream
+ *
+ * @param os    output stream
+ * @param route visiting order
+ */
+static void write_route(std::ostream& os, const algo::tour::route& route) {
+  for (const auto& [item, reversed] : route) {
+    os << ' ' << item << ':' << (reversed ? 1 : 0);
+  }
+}
+
+/**
+ * Read visiting order from stream
+ *
+ * @param is input stream
+ *
+ * @return visiting order
+ */
+static algo::tour::route read_route(std::istream& is) {
+  algo::tour::route route;
+  std::size_t       item;
+  char              separator;
+  int               reversed;
+  while (is >> item >> separator >> reversed) {
+    if (separator != ':') {
+      return {};
+    }
+    route.push_back({item, reversed != 0});
+  }
+  return route;
+}
+
+namespace impl {
+RouteImpl::RouteImpl()
+    : active_{false},
+      cleaning_stations_{Config::get()->cleaning_stations()},
+      spraying_path_{Config::get()->spraying_path()} {}
+
+RouteImpl::~RouteImpl() {}
+
+void RouteImpl::optimize() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  // visiting order is always solved for the order of the configuration
+  cleaning_stations_ = config->cleaning_stations();
+  spraying_path_ = config->spraying_path();
+
+  active_ = config->route<bool>("enabled");
+  if (!active_) {
+    return;
+  }
+
+  const auto path = config->route<std::string>("cache");
+  const auto config_hash = hash();
+
+  if (load(path, config_hash)) {
+    LOG_DEBUG("Route is loaded from {}", path);
+  } else {
+    LOG_INFO("Optimizing route of cleaning stations and spraying path...");
+    solve();
+    save(path, config_hash);
+  }
+
+  apply();
+}
+
+std::uint64_t RouteImpl::hash() const {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  // FNV-1a
+  std::uint64_t result = 0xcbf29ce484222325ULL;
+
+  const auto mix = [&result](const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      result ^= bytes[i];
+      result *= 0x100000001b3ULL;
+    }
+  };
+  const auto mix_number = [&mix](auto value) { mix(&value, sizeof(value)); };
+  const auto mix_string = [&mix, &mix_number](const std::string& value) {
+    mix_number(value.size());
+    mix(value.data(), value.size());
+  };
+  const auto mix_speed = [&mix_number](const config::MechanismSpeed& speed) {
+    for (const auto* axis : {&speed.x, &speed.y, &speed.z}) {
+      mix_number(axis->rpm);
+      mix_number(axis->acceleration);
+      mix_number(axis->deceleration);
+      mix_number(axis->jerk);
+    }
+  };
+
+  mix_number(cache_version);
+  mix_number(config->route<std::size_t>("exact-limit"));
+  mix_number(config->route<bool>("spraying-passes"));
+
+  mix_number(cleaning_stations_.size());
+  for (const auto& [x, y, time, sonicator] : cleaning_stations_) {
+    mix_number(x);
+    mix_number(y);
+  }
+
+  const auto& spraying_position = config->spraying_position();
+  mix_number(spraying_position.first);
+  mix_number(spraying_position.second);
+
+  mix_number(spraying_path_.size());
+  for (const auto& [x, y] : spraying_path_) {
+    mix_number(x);
+    mix_number(y);
+  }
+
+  mix_speed(config->homing_speed_profile(config::speed::normal));
+  mix_speed(config->spraying_speed_profile(config::speed::normal));
+
+  mix_number(config->stepper_x<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_x<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_x<device::stepper::step>("motor-steps"));
+  mix_string(config->stepper_x<std::string>("speed-mode"));
+  mix_number(config->stepper_y<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_y<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_y<device::stepper::step>("motor-steps"));
+  mix_string(config->stepper_y<std::string>("speed-mode"));
+  mix_number(config->stepper_z<device::stepper::step>("steps-per-mm"));
+  mix_number(config->stepper_z<device::stepper::step>("microsteps"));
+  mix_number(config->stepper_z<device::stepper::step>("motor-steps"));
+  mix_string(config->stepper_z<std::string>("speed-mode"));
+
+  return result;
+}
+
+bool RouteImpl::load(const std::string& path, std::uint64_t hash) {
+  fs::ifstream file(path);
+
+  if (!file) {
+    return false;
+  }
+
+  algo::tour::route cleaning_route;
+  algo::tour::route spraying_route;
+  bool              matched = false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    std::string        key;
+    stream >> key;
+
+    if (key == "hash") {
+      std::uint64_t value;
+      stream >> std::hex >> value;
+      matched = !stream.fail() && value == hash;
+    } else if (key == "cleaning") {
+      cleaning_route = read_route(stream);
+    } else if (key == "spraying") {
+      spraying_route = read_route(stream);
+    }
+  }
+
+  if (!matched || !valid(station_items(cleaning_stations_), cleaning_route) ||
+      !valid(pass_items(spraying_path_), spraying_route)) {
+    return false;
+  }
+
+  cleaning_route_ = std::move(cleaning_route);
+  spraying_route_ = std::move(spraying_route);
+
+  return true;
+}
+
+void RouteImpl::save(const std::string& path, std::uint64_t hash) const {
+  fs::ofstream file(path);
+
+  if (!file) {
+    LOG_WARN("Cannot write route cache to {}", path);
+    return;
+  }
+
+  file << "# generated from configuration, do not edit\n";
+  file << "hash " << std::hex << hash << std::dec << '\n';
+  file << "cleaning";
+  write_route(file, cleaning_route_);
+  file << '\n';
+  file << "spraying";
+  write_route(file, spraying_route_);
+  file << '\n';
+}
+
+void RouteImpl::solve() {
+  massert(Config::get() != nullptr, "sanity");
+
+  auto* config = Config::get();
+
+  const auto limit = config->route<std::size_t>("exact-limit");
+
+  // cleaning starts and ends at home, travelling with homing speed
+  {
+    std::vector<std::pair<double, double>> points;
+    points.reserve(cleaning_stations_.size() + 1);
+    for (const auto& [x, y, time, sonicator] : cleaning_stations_) {
+      points.emplace_back(x, y);
+    }
+    points.emplace_back(0.0, 0.0);
+
+    const auto& speed = config->homing_speed_profile(config::speed::normal);
+
+    cleaning_route_ = solve_route(points, station_items(cleaning_stations_),
+                                  points.size() - 1, points.size() - 1,
+                                  travel_estimator(speed), limit);
+  }
+
+  // spray is kept on along the whole path, so reordered passes also spray
+  // every move that connects them
+  if (!config->route<bool>("spraying-passes")) {
+    spraying_route_ = algo::Tour::identity(pass_items(spraying_path_));
+    return;
+  }
+
+  // spraying path is relative to spraying position, starts at its origin
+  // and ends at home
+  {
+    const auto& spraying_position = config->spraying_position();
+
+    std::vector<std::pair<double, double>> points(spraying_path_.begin(),
+                                                  spraying_path_.end());
+    points.emplace_back(0.0, 0.0);
+    points.emplace_back(-spraying_position.first, -spraying_position.second);
+
+    const auto& speed = config->spraying_speed_profile(config::speed::normal);
+
+    spraying_route_ = solve_route(points, pass_items(spraying_path_),
+                                  points.size() - 2, points.size() - 1,
+                                  travel_estimator(speed), limit);
+  }
+}
+
+void RouteImpl::apply() {
+  const auto stations = cleaning_stations_;
+  const auto path = spraying_path_;
+  const auto passes = pass_items(path);
+
+  cleaning_stations_.clear();
+  for (const auto& visit : cleaning_route_) {
+    cleaning_stations_.push_back(stations[visit.item]);
+  }
+
+  spraying_path_.clear();
+  for (const auto& [item, reversed] : spraying_route_) {
+    const auto& pass = passes[item];
+    spraying_path_.push_back(path[reversed ? pass.exit : pass.entry]);
+    if (pass.entry != pass.exit) {
+      spraying_path_.push_back(path[reversed ? pass.entry : pass.exit]);
+    }
+  }
+}
+}  // namespace impl
+}  // namespace mechanism
+
+NAMESPACE_END
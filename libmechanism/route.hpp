@@ -0,0 +1,154 @@
+#ifndef LIB_MECHANISM_ROUTE_HPP_
+#define LIB_MECHANISM_ROUTE_HPP_
+
+/** @file route.hpp
+ *  @brief Route optimizer class definition
+ *
+ * Visiting order of cleaning stations and spraying passes
+ */
+
+#include <cstdint>
+#include <string>
+
+#include <libcore/core.hpp>
+
+#include <libalgo/algo.hpp>
+
+NAMESPACE_BEGIN
+
+namespace mechanism {
+// forward declaration
+namespace impl {
+class RouteImpl;
+}
+
+namespace route {
+using path_container = ns(impl::ConfigImpl)::path_container;
+using cleaning_container = ns(impl::ConfigImpl)::cleaning_container;
+}  // namespace route
+
+using Route = StaticObj<impl::RouteImpl>;
+
+namespace impl {
+/**
+ * @brief Route optimizer implementation.
+ *
+ * Reorders cleaning stations and passes of the spraying path (every two
+ * waypoints, sprayed in either direction) to minimize estimated travel time
+ * between them under the normal speed profile.
+ *
+ * Spray stays on for the whole spraying path, so the moves between
+ * reordered passes are sprayed as well. Passes are only reordered if it is
+ * enabled in key "mechanisms.route.spraying-passes", otherwise the spraying
+ * path keeps the order of the configuration.
+ *
+ * Optimized order is cached in a file against a hash of every configuration
+ * value it depends on, so it is only solved again after the configuration
+ * changes. Without optimizing, the order of the configuration is kept.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class RouteImpl : public StackObj {
+  template <class RouteImpl>
+  template <typename... Args>
+  friend ATM_STATUS StaticObj<RouteImpl>::create(Args&&... args);
+
+ public:
+  /**
+   * Get active status
+   *
+   * @return active status, true if visiting order is optimized
+   */
+  inline const bool& active() const { return active_; }
+  /**
+   * Optimize visiting order
+   *
+   * Does nothing if it is not enabled in key "mechanisms.route.enabled"
+   */
+  void optimize();
+  /**
+   * Get cleaning stations in visiting order
+   *
+   * @return cleaning stations
+   */
+  inline const route::cleaning_container& cleaning_stations() const {
+    return cleaning_stations_;
+  }
+  /**
+   * Get spraying movement path in visiting order
+   *
+   * @return spraying movement path
+   */
+  inline const route::path_container& spraying_path() const {
+    return spraying_path_;
+  }
+
+ private:
+  /**
+   * Route constructor
+   */
+  RouteImpl();
+  /**
+   * Route destructor
+   */
+  ~RouteImpl();
+  /**
+   * Get hash of every configuration value the visiting order depends on
+   *
+   * @return FNV-1a hash
+   */
+  std::uint64_t hash() const;
+  /**
+   * Load visiting order from cache
+   *
+   * @param path path of cache file
+   * @param hash hash of configuration
+   *
+   * @return true if cache is valid and loaded
+   */
+  bool load(const std::string& path, std::uint64_t hash);
+  /**
+   * Save visiting order to cache
+   *
+   * @param path path of cache file
+   * @param hash hash of configuration
+   */
+  void save(const std::string& path, std::uint64_t hash) const;
+  /**
+   * Solve visiting order
+   */
+  void solve();
+  /**
+   * Apply visiting order to cleaning stations and spraying path
+   */
+  void apply();
+
+ private:
+  /**
+   * Active status
+   */
+  bool active_;
+  /**
+   * Visiting order of cleaning stations
+   */
+  algo::tour::route cleaning_route_;
+  /**
+   * Visiting order of spraying passes
+   */
+  algo::tour::route spraying_route_;
+  /**
+   * Cleaning stations in visiting order
+   */
+  route::cleaning_container cleaning_stations_;
+  /**
+   * Spraying movement path in visiting order
+   */
+  route::path_container spraying_path_;
+};
+}  // namespace impl
+}  // namespace mechanism
+
+NAMESPACE_END
+
+#endif  // LIB_MECHANISM_ROUTE_HPP_
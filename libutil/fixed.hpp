@@ -0,0 +1,151 @@
+#ifndef LIB_UTIL_FIXED_HPP_
+#define LIB_UTIL_FIXED_HPP_
+
+/** @file fixed.hpp
+ *  @brief Fixed-point math helper
+ *
+ * Q16.16 fixed-point numbers stored in 64 bits, so products of two values
+ * can be taken without overflow for the ranges used by the motion core
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace util {
+namespace fixed {
+/**
+ * @var using q16 = std::int64_t
+ * @brief Type definition for Q16.16 fixed-point number
+ */
+using q16 = std::int64_t;
+
+/** Number of fractional bits */
+static constexpr int frac_bits = 16;
+
+/** 1.0 in Q16.16 */
+static constexpr q16 one = q16{1} << frac_bits;
+
+/**
+ * Convert integer to Q16.16
+ *
+ * @param value integer value
+ *
+ * @return Q16.16 value
+ */
+template <typename T,
+          typename = std::enable_if_t<std::is_integral_v<T>>>
+constexpr q16 from_int(T value) {
+  return static_cast<q16>(value) * one;
+}
+
+/**
+ * Convert floating point to Q16.16, rounded to nearest
+ *
+ * Not meant for the hot path, only to load configuration values
+ *
+ * @param value floating point value
+ *
+ * @return Q16.16 value
+ */
+inline q16 from_double(double value) {
+  return static_cast<q16>(std::llround(value * static_cast<double>(one)));
+}
+
+/**
+ * Convert Q16.16 to floating point
+ *
+ * @param value Q16.16 value
+ *
+ * @return floating point value
+ */
+constexpr double to_double(q16 value) {
+  return static_cast<double>(value) / static_cast<double>(one);
+}
+
+/**
+ * Convert Q16.16 to integer, rounded to nearest
+ *
+ * @param value Q16.16 value
+ *
+ * @return integer value
+ */
+constexpr std::int64_t round(q16 value) {
+  return (value >= 0) ? (value + one / 2) >> frac_bits
+                      : -((-value + one / 2) >> frac_bits);
+}
+
+/**
+ * Multiply two Q16.16 numbers
+ *
+ * Raw product must stay below 2^63, so the product of the values must be
+ * below 2^31. Squaring a rate overflows above about 46341 steps / s
+ *
+ * @param a Q16.16 value
+ * @param b Q16.16 value
+ *
+ * @return a * b in Q16.16
+ */
+constexpr q16 mul(q16 a, q16 b) {
+  return (a * b) >> frac_bits;
+}
+
+/**
+ * Divide two Q16.16 numbers
+ *
+ * @param a Q16.16 value
+ * @param b Q16.16 value, must not be 0
+ *
+ * @return a / b in Q16.16
+ */
+constexpr q16 div(q16 a, q16 b) {
+  return (a << frac_bits) / b;
+}
+
+/**
+ * Integer square root, rounded down
+ *
+ * @param value non-negative integer
+ *
+ * @return floor(sqrt(value))
+ */
+constexpr std::uint64_t isqrt(std::uint64_t value) {
+  std::uint64_t result = 0;
+  std::uint64_t bit = std::uint64_t{1} << 62;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+
+  while (bit != 0) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return result;
+}
+
+/**
+ * Square root of Q16.16 number
+ *
+ * Raw value must be below 2^48 (value below 2^32), since it is shifted left
+ * by frac_bits before the integer square root
+ *
+ * @param value non-negative Q16.16 value
+ *
+ * @return sqrt(value) in Q16.16
+ */
+constexpr q16 sqrt(q16 value) {
+  return (value <= 0) ? 0
+                      : static_cast<q16>(
+                            isqrt(static_cast<std::uint64_t>(value) << frac_bits));
+}
+}  // namespace fixed
+}  // namespace util
+
+#endif  // LIB_UTIL_FIXED_HPP_
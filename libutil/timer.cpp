@@ -2,10 +2,38 @@
 
 #include "timer.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#endif
+
+// default wake-up latency before calibration (us)
+static std::atomic<time_unit> wake_up_latency{100};
+
+// installed clock backend, nullptr means system clock
+static std::atomic<util::Clock*> clock_backend{nullptr};
+
+namespace util {
+void use_clock(Clock* clock) {
+  clock_backend.store(clock, std::memory_order_release);
+}
+
+Clock* current_clock() {
+  return clock_backend.load(std::memory_order_acquire);
+}
+}  // namespace util
 
 time_unit seconds() {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    return clock->now() / 1000000;
+  }
+
   uint64_t s = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::seconds>(
           std::chrono::high_resolution_clock::now().time_since_epoch())
@@ -15,6 +43,11 @@ time_unit seconds() {
 
 template <>
 void sleep_for<time_units::seconds>(time_unit time) {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until(clock->now() + time * 1000000);
+    return;
+  }
+
   std::this_thread::sleep_for(std::chrono::seconds(time));
 }
 
@@ -26,11 +59,20 @@ void sleep_until<time_units::seconds>(time_unit time, time_unit start_time) {
     start = seconds();
   }
 
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until((start + time) * 1000000);
+    return;
+  }
+
   std::this_thread::sleep_until(std::chrono::high_resolution_clock::time_point{
       std::chrono::seconds(start + time)});
 }
 
 time_unit millis() {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    return clock->now() / 1000;
+  }
+
   uint64_t ms = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::milliseconds>(
           std::chrono::high_resolution_clock::now().time_since_epoch())
@@ -40,6 +82,11 @@ time_unit millis() {
 
 template <>
 void sleep_for<time_units::millis>(time_unit time) {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until(clock->now() + time * 1000);
+    return;
+  }
+
   std::this_thread::sleep_for(std::chrono::milliseconds(time));
 }
 
@@ -51,20 +98,34 @@ void sleep_until<time_units::millis>(time_unit time, time_unit start_time) {
     start = millis();
   }
 
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until((start + time) * 1000);
+    return;
+  }
+
   std::this_thread::sleep_until(std::chrono::high_resolution_clock::time_point{
       std::chrono::milliseconds(start + time)});
 }
 
 time_unit micros() {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    return clock->now();
+  }
+
   uint64_t us = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::high_resolution_clock::now().time_since_epoch())
+          std::chrono::steady_clock::now().time_since_epoch())
           .count());
   return static_cast<time_unit>(us);
 }
 
 template <>
 void sleep_for<time_units::micros>(time_unit time) {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until(clock->now() + time);
+    return;
+  }
+
   std::this_thread::sleep_for(std::chrono::microseconds(time));
 }
 
@@ -76,20 +137,35 @@ void sleep_until<time_units::micros>(time_unit time, time_unit start_time) {
     start = micros();
   }
 
-  std::this_thread::sleep_until(std::chrono::high_resolution_clock::time_point{
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until(start + time);
+    return;
+  }
+
+  std::this_thread::sleep_until(std::chrono::steady_clock::time_point{
       std::chrono::microseconds(start + time)});
 }
 
 time_unit nanos() {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    return clock->now() * 1000;
+  }
+
   uint64_t ns = static_cast<uint64_t>(
       std::chrono::duration_cast<std::chrono::nanoseconds>(
-          std::chrono::high_resolution_clock::now().time_since_epoch())
+          std::chrono::steady_clock::now().time_since_epoch())
           .count());
   return static_cast<time_unit>(ns);
 }
 
 template <>
 void sleep_for<time_units::nanos>(time_unit time) {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    // clock resolution is one microsecond
+    clock->sleep_until(clock->now() + (time + 999) / 1000);
+    return;
+  }
+
   std::this_thread::sleep_for(std::chrono::nanoseconds(time));
 }
 
@@ -101,6 +177,90 @@ void sleep_until<time_units::nanos>(time_unit time, time_unit start_time) {
     start = nanos();
   }
 
-  std::this_thread::sleep_until(std::chrono::high_resolution_clock::time_point{
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until((start + time + 999) / 1000);
+    return;
+  }
+
+  std::this_thread::sleep_until(std::chrono::steady_clock::time_point{
       std::chrono::nanoseconds(start + time)});
 }
+
+/**
+ * Sleep until absolute time in micros() time base
+ *
+ * @param deadline deadline in microseconds
+ */
+static void sleep_until_absolute(time_unit deadline) {
+#if defined(__linux__)
+  // steady_clock is CLOCK_MONOTONIC on linux
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(deadline / 1000000);
+  ts.tv_nsec = static_cast<long>((deadline % 1000000) * 1000);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+    // interrupted by signal, sleep again
+  }
+#else
+  std::this_thread::sleep_until(std::chrono::steady_clock::time_point{
+      std::chrono::microseconds(deadline)});
+#endif
+}
+
+void wait_until(time_unit deadline) {
+  if (auto* clock = util::current_clock(); clock != nullptr) {
+    clock->sleep_until(deadline);
+    return;
+  }
+
+  time_unit now = micros();
+
+  if (now >= deadline) {
+    return;
+  }
+
+  const time_unit latency = wake_up_latency.load(std::memory_order_relaxed);
+
+  if (deadline - now > latency) {
+    sleep_until_absolute(deadline - latency);
+  }
+
+  // spin for the rest
+  while (micros() < deadline) {
+  }
+}
+
+time_unit calibrate_wait_latency(unsigned int samples) {
+  if (util::current_clock() != nullptr) {
+    // installed clock wakes up exactly on time
+    return wait_latency();
+  }
+
+  // sleep long enough to be descheduled, like waiting for a slow step
+  static constexpr time_unit interval = 1000;
+
+  std::vector<time_unit> lateness;
+  lateness.reserve(std::max(samples, 1U));
+
+  for (unsigned int i = 0; i < std::max(samples, 1U); ++i) {
+    const time_unit deadline = micros() + interval;
+    sleep_until_absolute(deadline);
+    const time_unit now = micros();
+    lateness.push_back(now > deadline ? now - deadline : 0);
+  }
+
+  // 99th percentile, occasional outliers are left to the spin
+  auto percentile = lateness.begin() + static_cast<std::ptrdiff_t>(
+                                           (lateness.size() - 1) * 99 / 100);
+  std::nth_element(lateness.begin(), percentile, lateness.end());
+
+  // few microseconds of headroom to read the clock and return
+  const time_unit latency = *percentile + 5;
+  wake_up_latency.store(latency, std::memory_order_relaxed);
+
+  return latency;
+}
+
+time_unit wait_latency() {
+  return wake_up_latency.load(std::memory_order_relaxed);
+}
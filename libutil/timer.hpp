@@ -11,6 +11,55 @@ using time_unit = uint64_t;
 
 enum class time_units { seconds, millis, micros, nanos };
 
+namespace util {
+/**
+ * @brief Clock backend of timer functions.
+ *
+ * Every timer function (micros(), millis(), sleep_for(), wait_until(), ...)
+ * is served by the installed clock, or by the system clock if none is
+ * installed, see util::use_clock()
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class Clock {
+ public:
+  /**
+   * Clock Destructor
+   */
+  virtual ~Clock() = default;
+  /**
+   * Get time stamp
+   *
+   * @return time stamp in microseconds
+   */
+  virtual time_unit now() = 0;
+  /**
+   * Sleep until absolute deadline
+   *
+   * @param deadline deadline in now() time base
+   */
+  virtual void sleep_until(time_unit deadline) = 0;
+};
+
+/**
+ * @brief Install clock backend of timer functions
+ *
+ * Must be called before any other thread uses the timer functions, and the
+ * clock must outlive every user
+ *
+ * @param clock clock backend, nullptr to use the system clock
+ */
+void use_clock(Clock* clock);
+
+/**
+ * @brief Get installed clock backend
+ *
+ * @return clock backend, nullptr if the system clock is used
+ */
+Clock* current_clock();
+}  // namespace util
+
 /**
  * @brief Get time stamp in seconds.
  *
@@ -37,6 +86,8 @@ time_unit millis(void);
  * taken from https://stackoverflow.com/a/49066369/6808347 <br />
  * credits to Gabriel Staples <br />
  *
+ * Monotonic clock, only meaningful for intervals
+ *
  * @return time stamp in microseconds
  */
 time_unit micros(void);
@@ -47,6 +98,8 @@ time_unit micros(void);
  * taken from https://stackoverflow.com/a/49066369/6808347 \n
  * credits to Gabriel Staples \n
  *
+ * Monotonic clock, only meaningful for intervals
+ *
  * @return time stamp in nanoseconds
  */
 time_unit nanos(void);
@@ -90,4 +143,34 @@ void sleep_until<time_units::micros>(time_unit time, time_unit start_time);
 template <>
 void sleep_until<time_units::nanos>(time_unit time, time_unit start_time);
 
+/**
+ * @brief Wait until absolute deadline with hybrid sleep and spin
+ *
+ * Sleeps with clock_nanosleep(TIMER_ABSTIME) until wake-up latency before the
+ * deadline, then spins only for the rest, so waiting for step pulses does not
+ * keep a core busy. Returns immediately if the deadline has passed.
+ *
+ * @param deadline deadline in micros() time base
+ */
+void wait_until(time_unit deadline);
+
+/**
+ * @brief Calibrate wake-up latency of current machine
+ *
+ * Measures how late the thread wakes up from absolute sleep and uses the
+ * 99th percentile as the spin margin of wait_until()
+ *
+ * @param samples number of sleeps to measure
+ *
+ * @return calibrated wake-up latency in microseconds
+ */
+time_unit calibrate_wait_latency(unsigned int samples = 200);
+
+/**
+ * @brief Get wake-up latency used by wait_until()
+ *
+ * @return wake-up latency in microseconds
+ */
+time_unit wait_latency(void);
+
 #endif  // LIB_CORE_TIMER_HPP_
@@ -13,11 +13,15 @@
 #pragma GCC diagnostic ignored "-Wweak-vtables"
 
 // 1. STL
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -30,11 +34,13 @@
 // 3. Local
 #include "boolean.hpp"
 #include "filesystem.hpp"
+#include "fixed.hpp"
 #include "macros.hpp"
 #include "math.hpp"
 #include "pair.hpp"
 #include "time.hpp"
 #include "timer.hpp"
+#include "virtual_clock.hpp"
 
 #pragma GCC diagnostic pop
 
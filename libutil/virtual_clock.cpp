@@ -0,0 +1,82 @@
+#include "util.hpp"
+
+#include "virtual_clock.hpp"
+
+namespace util {
+VirtualClock::VirtualClock(time_unit                 start,
+                           time_unit                 resolution,
+                           std::chrono::microseconds quiet_period)
+    : now_{start},
+      resolution_{resolution},
+      quiet_period_{quiet_period},
+      activity_{0},
+      participants_{0} {}
+
+void VirtualClock::join() {
+  // a thread is only counted once for the clock it has used last
+  thread_local const VirtualClock* joined = nullptr;
+
+  if (joined != this) {
+    joined = this;
+    participants_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+time_unit VirtualClock::now() {
+  join();
+  activity_.fetch_add(1, std::memory_order_relaxed);
+  return now_.fetch_add(resolution_, std::memory_order_acq_rel) + resolution_;
+}
+
+void VirtualClock::sleep_until(time_unit deadline) {
+  join();
+  activity_.fetch_add(1, std::memory_order_relaxed);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (now_.load(std::memory_order_acquire) >= deadline) {
+    return;
+  }
+
+  const auto sleeper = sleepers_.insert(deadline);
+  changed_.notify_all();
+
+  while (now_.load(std::memory_order_acquire) < deadline) {
+    if (*sleepers_.begin() < deadline) {
+      // somebody else has to wake up first
+      changed_.wait(lock);
+      continue;
+    }
+
+    if (sleepers_.size() >= participants_.load(std::memory_order_relaxed)) {
+      // nobody is running, nothing can happen until the deadline
+      advance(deadline);
+      break;
+    }
+
+    // somebody is running, jump only once it stays quiet
+    const auto activity = activity_.load(std::memory_order_relaxed);
+    changed_.wait_for(lock, quiet_period_);
+
+    if (activity == activity_.load(std::memory_order_relaxed) &&
+        *sleepers_.begin() >= deadline) {
+      advance(deadline);
+      break;
+    }
+  }
+
+  sleepers_.erase(sleeper);
+  changed_.notify_all();
+}
+
+void VirtualClock::advance(time_unit deadline) {
+  time_unit current = now_.load(std::memory_order_acquire);
+  while (current < deadline &&
+         !now_.compare_exchange_weak(current, deadline,
+                                     std::memory_order_acq_rel)) {
+    // read by another thread in the meantime
+  }
+
+  changed_.notify_all();
+}
+}  // namespace util
@@ -0,0 +1,133 @@
+#ifndef LIB_UTIL_VIRTUAL_CLOCK_HPP_
+#define LIB_UTIL_VIRTUAL_CLOCK_HPP_
+
+/** @file virtual_clock.hpp
+ *  @brief Virtual clock definition
+ *
+ * Faster-than-real-time clock backend for simulation
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+
+#include "timer.hpp"
+
+namespace util {
+/**
+ * @brief Virtual clock.
+ *
+ * Time only moves when threads sleep, so a job that mostly waits (step
+ * pulses, dwells, polling) runs as fast as the CPU allows while every
+ * timestamp stays consistent across threads.
+ *
+ * A sleeping thread jumps the time to its deadline once it has the earliest
+ * deadline and every other thread that uses the clock is sleeping too. If
+ * some thread is still running (or blocked outside of the clock, like an
+ * idle worker), the earliest sleeper jumps only after the clock has been
+ * quiet for `quiet_period` of real time. Every read advances the time by
+ * `resolution`, so busy waits on micros() make progress.
+ *
+ * @author Ray Andrew
+ * @date   October 2020
+ */
+class VirtualClock : public Clock {
+ public:
+  /**
+   * VirtualClock Constructor
+   *
+   * @param start        time stamp to start from (us)
+   * @param resolution   time taken by each read (us)
+   * @param quiet_period real time to wait for running threads
+   */
+  explicit VirtualClock(
+      time_unit                 start = 0,
+      time_unit                 resolution = 1,
+      std::chrono::microseconds quiet_period = std::chrono::microseconds(200));
+  /**
+   * VirtualClock Destructor
+   */
+  virtual ~VirtualClock() override = default;
+  /**
+   * Get time stamp and advance it by the resolution
+   *
+   * @return time stamp in microseconds
+   */
+  virtual time_unit now() override;
+  /**
+   * Sleep until virtual deadline
+   *
+   * @param deadline deadline in microseconds
+   */
+  virtual void sleep_until(time_unit deadline) override;
+  /**
+   * Get time stamp without advancing it
+   *
+   * @return time stamp in microseconds
+   */
+  inline time_unit peek() const {
+    return now_.load(std::memory_order_acquire);
+  }
+  /**
+   * Get number of threads that have used the clock
+   *
+   * @return number of threads
+   */
+  inline unsigned int participants() const {
+    return participants_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * Count calling thread as a user of the clock
+   */
+  void join();
+  /**
+   * Move the time forward to deadline and wake up the sleepers
+   *
+   * Must be called while holding mutex_
+   *
+   * @param deadline deadline in microseconds
+   */
+  void advance(time_unit deadline);
+
+ private:
+  /**
+   * Current virtual time stamp (us)
+   */
+  std::atomic<time_unit> now_;
+  /**
+   * Time taken by each read (us)
+   */
+  const time_unit resolution_;
+  /**
+   * Real time to wait for running threads before jumping
+   */
+  const std::chrono::microseconds quiet_period_;
+  /**
+   * Incremented on every read and sleep, used to detect running threads
+   */
+  std::atomic<std::uint64_t> activity_;
+  /**
+   * Number of threads that have used the clock
+   */
+  std::atomic<unsigned int> participants_;
+  /**
+   * Deadline of every sleeping thread
+   */
+  std::multiset<time_unit> sleepers_;
+  /**
+   * Mutex to guard sleepers_ and time jumps
+   */
+  std::mutex mutex_;
+  /**
+   * Notified when a thread starts or stops sleeping and on every jump
+   */
+  std::condition_variable changed_;
+};
+}  // namespace util
+
+#endif  // LIB_UTIL_VIRTUAL_CLOCK_HPP_